@@ -0,0 +1,251 @@
+#include "AsyncFileWriter.h"
+#include "AndroidOut.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+static bool WriteAll(int fd, const void* buf, size_t bufSize)
+{
+    const auto* byteBuf = static_cast<const uint8_t*>(buf);
+    size_t offset = 0;
+    while(offset < bufSize)
+    {
+        ssize_t result = ::write(fd, byteBuf + offset, bufSize - offset);
+        if(result < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        offset += size_t(result);
+    }
+
+    return true;
+}
+
+AsyncFileWriter::AsyncFileWriter()
+{
+    this->threadHandle = 0;
+    this->keepRunning = false;
+    this->writeCount = 0;
+    this->coalescedCount = 0;
+    this->failedCount = 0;
+
+    // The coalescing delay is timed on the monotonic clock so that the wall clock being changed can't stretch it.
+    pthread_condattr_t conditionAttr;
+    pthread_condattr_init(&conditionAttr);
+    pthread_condattr_setclock(&conditionAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&this->condition, &conditionAttr);
+    pthread_condattr_destroy(&conditionAttr);
+
+    pthread_mutex_init(&this->mutex, nullptr);
+}
+
+/*virtual*/ AsyncFileWriter::~AsyncFileWriter()
+{
+    this->Stop();
+
+    pthread_cond_destroy(&this->condition);
+    pthread_mutex_destroy(&this->mutex);
+}
+
+bool AsyncFileWriter::Start()
+{
+    if(this->threadHandle != 0)
+        return false;
+
+    this->keepRunning = true;
+
+    if(0 != pthread_create(&this->threadHandle, nullptr, &AsyncFileWriter::ThreadEntryPoint, this))
+    {
+        this->threadHandle = 0;
+        this->keepRunning = false;
+        return false;
+    }
+
+    return true;
+}
+
+void AsyncFileWriter::Stop()
+{
+    pthread_mutex_lock(&this->mutex);
+    this->keepRunning = false;
+    pthread_cond_signal(&this->condition);
+    pthread_mutex_unlock(&this->mutex);
+
+    if(this->threadHandle)
+    {
+        pthread_join(this->threadHandle, nullptr);
+        this->threadHandle = 0;
+    }
+}
+
+void AsyncFileWriter::Write(const std::string& filePath, const Generator& generator)
+{
+    PendingWrite pendingWrite;
+    pendingWrite.filePath = filePath;
+    pendingWrite.generator = generator;
+    pendingWrite.append = false;
+    this->Enqueue(pendingWrite);
+}
+
+void AsyncFileWriter::Append(const std::string& filePath, const void* dataBuf, size_t dataBufSize)
+{
+    PendingWrite pendingWrite;
+    pendingWrite.filePath = filePath;
+    pendingWrite.append = true;
+    pendingWrite.appendData.assign(static_cast<const char*>(dataBuf), dataBufSize);
+    this->Enqueue(pendingWrite);
+}
+
+void AsyncFileWriter::Enqueue(const PendingWrite& pendingWrite)
+{
+    if(this->threadHandle == 0)
+    {
+        this->PerformWrite(pendingWrite);
+        return;
+    }
+
+    pthread_mutex_lock(&this->mutex);
+
+    // We can only fold this into the last thing pending for the same file, and only if it's the same kind of thing;
+    // otherwise, a write and an append could end up happening in the wrong order.
+    bool coalesced = false;
+    for(auto iter = this->pendingWriteList.rbegin(); iter != this->pendingWriteList.rend(); iter++)
+    {
+        PendingWrite& existingWrite = *iter;
+        if(existingWrite.filePath != pendingWrite.filePath)
+            continue;
+
+        if(existingWrite.append == pendingWrite.append)
+        {
+            if(pendingWrite.append)
+                existingWrite.appendData += pendingWrite.appendData;
+            else
+                existingWrite.generator = pendingWrite.generator;
+
+            coalesced = true;
+        }
+
+        break;
+    }
+
+    if(coalesced)
+        this->coalescedCount++;
+    else
+    {
+        this->pendingWriteList.push_back(pendingWrite);
+        pthread_cond_signal(&this->condition);
+    }
+
+    pthread_mutex_unlock(&this->mutex);
+}
+
+/*static*/ void* AsyncFileWriter::ThreadEntryPoint(void* arg)
+{
+    auto fileWriter = static_cast<AsyncFileWriter*>(arg);
+    fileWriter->ThreadFunc();
+    return nullptr;
+}
+
+void AsyncFileWriter::ThreadFunc()
+{
+    pthread_mutex_lock(&this->mutex);
+
+    while(true)
+    {
+        while(this->keepRunning && this->pendingWriteList.size() == 0)
+            pthread_cond_wait(&this->condition, &this->mutex);
+
+        if(this->pendingWriteList.size() == 0)
+            break;
+
+        // Give whoever asked a moment to ask again before we go to storage.  We don't wait if we're being stopped.
+        struct timespec deadline;
+        ::clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += (ASYNC_FILE_WRITER_COALESCE_MILLISECONDS % 1000) * 1000000;
+        deadline.tv_sec += ASYNC_FILE_WRITER_COALESCE_MILLISECONDS / 1000 + deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+        while(this->keepRunning && pthread_cond_timedwait(&this->condition, &this->mutex, &deadline) != ETIMEDOUT)
+        {
+        }
+
+        std::list<PendingWrite> writeList;
+        writeList.swap(this->pendingWriteList);
+
+        // Nobody has to wait on us while we're out at storage.
+        pthread_mutex_unlock(&this->mutex);
+
+        for(const PendingWrite& pendingWrite : writeList)
+            this->PerformWrite(pendingWrite);
+
+        pthread_mutex_lock(&this->mutex);
+    }
+
+    pthread_mutex_unlock(&this->mutex);
+}
+
+void AsyncFileWriter::PerformWrite(const PendingWrite& pendingWrite)
+{
+    bool written = false;
+    if(pendingWrite.append)
+        written = AppendFile(pendingWrite.filePath, pendingWrite.appendData.data(), pendingWrite.appendData.size());
+    else
+    {
+        std::string fileData;
+        if(!pendingWrite.generator(fileData))
+            return;
+
+        written = WriteFileAtomically(pendingWrite.filePath, fileData.data(), fileData.size());
+    }
+
+    if(written)
+        this->writeCount++;
+    else
+    {
+        this->failedCount++;
+        aout << "Failed to write " << pendingWrite.filePath << "." << std::endl;
+    }
+}
+
+/*static*/ bool AsyncFileWriter::WriteFileAtomically(const std::string& filePath, const void* fileBuf, size_t fileBufSize)
+{
+    std::string tempFile = filePath + ".tmp";
+    int fd = ::open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if(fd < 0)
+        return false;
+
+    bool written = WriteAll(fd, fileBuf, fileBufSize);
+
+    // The rename only protects us from a torn file if the new contents are really on storage before it happens.
+    if(written && 0 != ::fsync(fd))
+        written = false;
+
+    if(0 != ::close(fd))
+        written = false;
+
+    if(!written || 0 != ::rename(tempFile.c_str(), filePath.c_str()))
+    {
+        ::unlink(tempFile.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*static*/ bool AsyncFileWriter::AppendFile(const std::string& filePath, const void* dataBuf, size_t dataBufSize)
+{
+    int fd = ::open(filePath.c_str(), O_WRONLY | O_APPEND);
+    if(fd < 0)
+        return false;
+
+    bool written = WriteAll(fd, dataBuf, dataBufSize);
+
+    if(0 != ::close(fd))
+        written = false;
+
+    return written;
+}
\ No newline at end of file
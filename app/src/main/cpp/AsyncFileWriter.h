@@ -0,0 +1,77 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <list>
+#include <string>
+#include <functional>
+
+// Writes that come in closer together than this are all folded into one.
+#define ASYNC_FILE_WRITER_COALESCE_MILLISECONDS     250
+
+// This saves files from its own thread so that whoever asked never waits on storage.  Each
+// save replaces the whole file, and goes through a temporary file that's synced and then
+// renamed into place, so a reader (or the app starting up after being killed mid-write) only
+// ever sees the old contents or the new, never a mix.
+//
+// A file's contents aren't made until the write actually happens, by a function handed over
+// with the request.  If the same file is asked to be saved again before that, the newer
+// request just takes the older one's place, so a burst of saves costs one write.
+//
+// Logs can also be appended to.  Appends to the same file that pile up go out together in one
+// write.  Those aren't synced or renamed into place, so a log has to be able to tell if its
+// last entry was cut short.
+class AsyncFileWriter
+{
+public:
+    AsyncFileWriter();
+    virtual ~AsyncFileWriter();
+
+    bool Start();
+
+    // Anything still waiting to be written is written before this returns.
+    void Stop();
+
+    // This fills in the file's contents.  It's called on the writer's thread, so it should work from its own copy of
+    // whatever it needs.  Returning false cancels the write.
+    typedef std::function<bool(std::string& fileData)> Generator;
+
+    // If the writer isn't running, the file is written right here instead.
+    void Write(const std::string& filePath, const Generator& generator);
+
+    // The file must already exist.  If the writer isn't running, this is also done right here.
+    void Append(const std::string& filePath, const void* dataBuf, size_t dataBufSize);
+
+    uint32_t GetWriteCount() const { return this->writeCount.load(); }
+    uint32_t GetCoalescedCount() const { return this->coalescedCount.load(); }
+    uint32_t GetFailedCount() const { return this->failedCount.load(); }
+
+    static bool WriteFileAtomically(const std::string& filePath, const void* fileBuf, size_t fileBufSize);
+    static bool AppendFile(const std::string& filePath, const void* dataBuf, size_t dataBufSize);
+
+private:
+    struct PendingWrite
+    {
+        std::string filePath;
+        Generator generator;
+        bool append;
+        std::string appendData;
+    };
+
+    static void* ThreadEntryPoint(void* arg);
+    void ThreadFunc();
+    void Enqueue(const PendingWrite& pendingWrite);
+    void PerformWrite(const PendingWrite& pendingWrite);
+
+    pthread_t threadHandle;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    bool keepRunning;
+    std::list<PendingWrite> pendingWriteList;
+
+    std::atomic<uint32_t> writeCount;
+    std::atomic<uint32_t> coalescedCount;
+    std::atomic<uint32_t> failedCount;
+};
\ No newline at end of file
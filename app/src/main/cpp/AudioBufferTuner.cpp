@@ -0,0 +1,91 @@
+#include "AudioBufferTuner.h"
+
+// However unlucky a device is, we never wait more than this many times the configured quiet period before trying to shrink.
+#define AUDIO_BUFFER_TUNER_MAX_BACKOFF      16
+
+AudioBufferTuner::AudioBufferTuner()
+{
+    this->framesPerBurst = 0;
+    this->minBursts = 1;
+    this->maxBursts = 1;
+    this->baseShrinkAfterFrames = 0;
+    this->shrinkAfterFrames = 0;
+    this->quietFrames = 0;
+    this->lastXRunCount = 0;
+    this->lastChangeWasShrink = false;
+    this->numBursts = 1;
+    this->growCount = 0;
+    this->shrinkCount = 0;
+}
+
+/*virtual*/ AudioBufferTuner::~AudioBufferTuner()
+{
+}
+
+bool AudioBufferTuner::Setup(uint32_t framesPerSecond, uint32_t framesPerBurst, uint32_t bufferCapacityFrames, uint32_t minBursts, uint32_t maxBursts, double shrinkAfterSeconds)
+{
+    if(framesPerSecond == 0 || framesPerBurst == 0 || bufferCapacityFrames < framesPerBurst)
+        return false;
+
+    // The stream can't give us more than its capacity, whatever the options say.
+    uint32_t capacityBursts = bufferCapacityFrames / framesPerBurst;
+    this->minBursts = (minBursts < 1) ? 1 : ((minBursts > capacityBursts) ? capacityBursts : minBursts);
+    this->maxBursts = (maxBursts < this->minBursts) ? this->minBursts : ((maxBursts > capacityBursts) ? capacityBursts : maxBursts);
+
+    this->framesPerBurst = framesPerBurst;
+    this->baseShrinkAfterFrames = uint64_t((shrinkAfterSeconds > 0.0 ? shrinkAfterSeconds : 0.0) * double(framesPerSecond));
+    this->shrinkAfterFrames = this->baseShrinkAfterFrames;
+    this->quietFrames = 0;
+    this->lastXRunCount = 0;
+    this->lastChangeWasShrink = false;
+    this->numBursts = this->minBursts;
+    this->growCount = 0;
+    this->shrinkCount = 0;
+    return true;
+}
+
+uint32_t AudioBufferTuner::Update(int32_t xRunCount, uint32_t numFrames)
+{
+    if(this->framesPerBurst == 0)
+        return 0;
+
+    uint32_t currentBursts = this->numBursts.load();
+
+    if(xRunCount > this->lastXRunCount)
+    {
+        this->lastXRunCount = xRunCount;
+        this->quietFrames = 0;
+
+        if(this->lastChangeWasShrink)
+        {
+            this->lastChangeWasShrink = false;
+            if(this->shrinkAfterFrames < this->baseShrinkAfterFrames * AUDIO_BUFFER_TUNER_MAX_BACKOFF)
+                this->shrinkAfterFrames *= 2;
+        }
+
+        if(currentBursts >= this->maxBursts)
+            return 0;
+
+        this->numBursts = currentBursts + 1;
+        this->growCount++;
+        return this->GetBufferSizeFrames();
+    }
+
+    // The count can go backwards if the stream gets restarted underneath us.
+    this->lastXRunCount = xRunCount;
+
+    this->quietFrames += numFrames;
+    if(this->quietFrames < this->shrinkAfterFrames)
+        return 0;
+
+    // A whole quiet period went by, so whatever we last shrank to is holding up fine.
+    this->quietFrames = 0;
+    this->lastChangeWasShrink = false;
+    if(currentBursts <= this->minBursts)
+        return 0;
+
+    this->lastChangeWasShrink = true;
+    this->numBursts = currentBursts - 1;
+    this->shrinkCount++;
+    return this->GetBufferSizeFrames();
+}
\ No newline at end of file
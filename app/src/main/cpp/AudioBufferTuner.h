@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// This decides how big the audio output buffer should be, a burst at a time.  We start
+// as small as we're allowed, for the least latency, and add a burst every time the stream
+// reports an xrun.  After a long enough stretch without any, we try taking a burst back
+// off.  If that gets us an xrun right away, we wait twice as long before trying again,
+// so a device that really does need the bigger buffer doesn't keep glitching every so
+// often just so we can find that out.  Time is counted in frames played rather than by
+// any clock, which keeps this deterministic.  Nothing here knows about oboe.
+class AudioBufferTuner
+{
+public:
+    AudioBufferTuner();
+    virtual ~AudioBufferTuner();
+
+    bool Setup(uint32_t framesPerSecond, uint32_t framesPerBurst, uint32_t bufferCapacityFrames, uint32_t minBursts, uint32_t maxBursts, double shrinkAfterSeconds);
+
+    // This is called once per audio callback with the stream's running xrun count and the number of frames just played.
+    // If the buffer should change size, the new size in frames is returned; otherwise, zero is returned.
+    uint32_t Update(int32_t xRunCount, uint32_t numFrames);
+
+    uint32_t GetBufferSizeFrames() const { return this->numBursts.load() * this->framesPerBurst; }
+    uint32_t GetGrowCount() const { return this->growCount.load(); }
+    uint32_t GetShrinkCount() const { return this->shrinkCount.load(); }
+
+private:
+    uint32_t framesPerBurst;
+    uint32_t minBursts;
+    uint32_t maxBursts;
+    uint64_t baseShrinkAfterFrames;
+    uint64_t shrinkAfterFrames;
+    uint64_t quietFrames;
+    int32_t lastXRunCount;
+    bool lastChangeWasShrink;
+
+    // These are read from other threads for the stats.
+    std::atomic<uint32_t> numBursts;
+    std::atomic<uint32_t> growCount;
+    std::atomic<uint32_t> shrinkCount;
+};
\ No newline at end of file
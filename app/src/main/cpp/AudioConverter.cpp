@@ -0,0 +1,234 @@
+#include "AudioConverter.h"
+#include "WaveFile.h"
+#include <math.h>
+#include <string.h>
+
+#define AUDIO_CONVERTER_MAX_CHANNELS        8
+#define AUDIO_CONVERTER_ZERO_CROSSINGS      16          // How many lobes of the sinc we keep on each side.
+#define AUDIO_CONVERTER_TABLE_RESOLUTION    512         // Filter table entries per lobe.
+#define AUDIO_CONVERTER_KAISER_BETA         9.0         // Trades transition width for stop-band rejection (about 90 dB here).
+#define AUDIO_CONVERTER_CUTOFF_MARGIN       0.95        // Start rolling off a bit below the lower of the two Nyquist frequencies.
+
+// This is the zeroth-order modified Bessel function of the first kind, which the Kaiser window is built from.
+static double BesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+    for(int k = 1; k < 64; k++)
+    {
+        term *= (halfX / double(k)) * (halfX / double(k));
+        sum += term;
+        if(term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
+
+AudioConverter::AudioConverter()
+{
+}
+
+/*virtual*/ AudioConverter::~AudioConverter()
+{
+}
+
+bool AudioConverter::Convert(const WaveFile& waveFile, uint32_t framesPerSecond, uint32_t numChannels, std::vector<int16_t>& sampleArray)
+{
+    if(numChannels == 0 || numChannels > AUDIO_CONVERTER_MAX_CHANNELS || waveFile.numChannels > AUDIO_CONVERTER_MAX_CHANNELS)
+        return false;
+
+    std::vector<float> decodedArray;
+    if(!Decode(waveFile, decodedArray))
+        return false;
+
+    // Change the channel count before the rate, since the clips we ship are mono and the output is usually stereo,
+    // and it's cheaper to resample one channel than two.
+    std::vector<float> remappedArray;
+    if(numChannels < waveFile.numChannels)
+    {
+        RemapChannels(decodedArray, waveFile.numChannels, numChannels, remappedArray);
+        this->Resample(remappedArray, numChannels, waveFile.framesPerSecond, framesPerSecond, decodedArray);
+        remappedArray.swap(decodedArray);
+    }
+    else
+    {
+        std::vector<float> resampledArray;
+        this->Resample(decodedArray, waveFile.numChannels, waveFile.framesPerSecond, framesPerSecond, resampledArray);
+        RemapChannels(resampledArray, waveFile.numChannels, numChannels, remappedArray);
+    }
+
+    sampleArray.resize(remappedArray.size());
+    for(size_t i = 0; i < remappedArray.size(); i++)
+    {
+        float sample = remappedArray[i];
+        sample = (sample < -1.0f) ? -1.0f : ((sample > 1.0f) ? 1.0f : sample);
+        sampleArray[i] = int16_t(::lrintf(sample * 32767.0f));
+    }
+
+    return true;
+}
+
+/*static*/ bool AudioConverter::Decode(const WaveFile& waveFile, std::vector<float>& sampleArray)
+{
+    size_t numSamples = size_t(waveFile.numFrames) * waveFile.numChannels;
+    sampleArray.resize(numSamples);
+
+    const uint8_t* byteBuf = waveFile.sampleBuf;
+
+    if(waveFile.sampleType == WaveFile::SampleType::FLOAT)
+    {
+        if(waveFile.bitsPerSample != 32)
+            return false;
+
+        ::memcpy(sampleArray.data(), byteBuf, numSamples * sizeof(float));
+        return true;
+    }
+
+    // Samples are little-endian, and might not be aligned, so we put them together a byte at a time.
+    switch(waveFile.bitsPerSample)
+    {
+        case 8:
+        {
+            // Unlike all the other sizes, 8-bit samples are unsigned.
+            for(size_t i = 0; i < numSamples; i++)
+                sampleArray[i] = float(int(byteBuf[i]) - 128) / 128.0f;
+            return true;
+        }
+        case 16:
+        {
+            for(size_t i = 0; i < numSamples; i++, byteBuf += 2)
+                sampleArray[i] = float(int16_t(byteBuf[0] | (byteBuf[1] << 8))) / 32768.0f;
+            return true;
+        }
+        case 24:
+        {
+            for(size_t i = 0; i < numSamples; i++, byteBuf += 3)
+                sampleArray[i] = float(int32_t((uint32_t(byteBuf[0]) << 8) | (uint32_t(byteBuf[1]) << 16) | (uint32_t(byteBuf[2]) << 24)) >> 8) / 8388608.0f;
+            return true;
+        }
+        case 32:
+        {
+            for(size_t i = 0; i < numSamples; i++, byteBuf += 4)
+                sampleArray[i] = float(double(int32_t(uint32_t(byteBuf[0]) | (uint32_t(byteBuf[1]) << 8) | (uint32_t(byteBuf[2]) << 16) | (uint32_t(byteBuf[3]) << 24))) / 2147483648.0);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*static*/ void AudioConverter::RemapChannels(const std::vector<float>& inputArray, uint32_t numInputChannels, uint32_t numOutputChannels, std::vector<float>& outputArray)
+{
+    if(numInputChannels == numOutputChannels)
+    {
+        outputArray = inputArray;
+        return;
+    }
+
+    size_t numFrames = inputArray.size() / numInputChannels;
+    outputArray.resize(numFrames * numOutputChannels);
+
+    for(size_t i = 0; i < numFrames; i++)
+    {
+        const float* inputFrame = &inputArray[i * numInputChannels];
+        float* outputFrame = &outputArray[i * numOutputChannels];
+
+        if(numOutputChannels == 1)
+        {
+            // Fold everything down to mono.
+            float sum = 0.0f;
+            for(uint32_t j = 0; j < numInputChannels; j++)
+                sum += inputFrame[j];
+            outputFrame[0] = sum / float(numInputChannels);
+        }
+        else
+        {
+            // Mono goes to every channel; otherwise, we just wrap the input channels around the output ones.
+            for(uint32_t j = 0; j < numOutputChannels; j++)
+                outputFrame[j] = inputFrame[j % numInputChannels];
+        }
+    }
+}
+
+void AudioConverter::BuildFilterTable()
+{
+    if(this->filterTableArray.size() > 0)
+        return;
+
+    // We leave an extra zero at the end so that interpolating right up to the edge doesn't read past the table.
+    size_t tableSize = AUDIO_CONVERTER_ZERO_CROSSINGS * AUDIO_CONVERTER_TABLE_RESOLUTION + 2;
+    this->filterTableArray.resize(tableSize);
+
+    double besselBeta = BesselI0(AUDIO_CONVERTER_KAISER_BETA);
+    for(size_t i = 0; i < tableSize; i++)
+    {
+        double u = double(i) / double(AUDIO_CONVERTER_TABLE_RESOLUTION);
+        double r = u / double(AUDIO_CONVERTER_ZERO_CROSSINGS);
+        if(r >= 1.0)
+        {
+            this->filterTableArray[i] = 0.0f;
+            continue;
+        }
+
+        double sinc = (i == 0) ? 1.0 : ::sin(M_PI * u) / (M_PI * u);
+        double window = BesselI0(AUDIO_CONVERTER_KAISER_BETA * ::sqrt(1.0 - r * r)) / besselBeta;
+        this->filterTableArray[i] = float(sinc * window);
+    }
+}
+
+float AudioConverter::FilterAt(double x) const
+{
+    double position = ::fabs(x) * double(AUDIO_CONVERTER_TABLE_RESOLUTION);
+    auto i = size_t(position);
+    if(i + 1 >= this->filterTableArray.size())
+        return 0.0f;
+
+    float fraction = float(position - double(i));
+    return this->filterTableArray[i] + (this->filterTableArray[i + 1] - this->filterTableArray[i]) * fraction;
+}
+
+void AudioConverter::Resample(const std::vector<float>& inputArray, uint32_t numChannels, uint32_t inputFramesPerSecond, uint32_t outputFramesPerSecond, std::vector<float>& outputArray)
+{
+    if(inputFramesPerSecond == outputFramesPerSecond)
+    {
+        outputArray = inputArray;
+        return;
+    }
+
+    this->BuildFilterTable();
+
+    // The filter is stretched when going down in rate so that it also cuts off below the new Nyquist frequency.
+    double step = double(inputFramesPerSecond) / double(outputFramesPerSecond);
+    double cutoff = AUDIO_CONVERTER_CUTOFF_MARGIN * ((step > 1.0) ? (1.0 / step) : 1.0);
+    double halfWidth = double(AUDIO_CONVERTER_ZERO_CROSSINGS) / cutoff;
+
+    auto numInputFrames = int64_t(inputArray.size() / numChannels);
+    auto numOutputFrames = int64_t(double(numInputFrames) / step);
+    outputArray.resize(size_t(numOutputFrames) * numChannels);
+
+    for(int64_t i = 0; i < numOutputFrames; i++)
+    {
+        double t = double(i) * step;
+        int64_t firstFrame = int64_t(::floor(t - halfWidth)) + 1;
+        int64_t lastFrame = int64_t(::floor(t + halfWidth));
+        if(firstFrame < 0)
+            firstFrame = 0;
+        if(lastFrame > numInputFrames - 1)
+            lastFrame = numInputFrames - 1;
+
+        float sumArray[AUDIO_CONVERTER_MAX_CHANNELS] = {};
+        for(int64_t j = firstFrame; j <= lastFrame; j++)
+        {
+            auto weight = float(cutoff) * this->FilterAt((t - double(j)) * cutoff);
+            const float* inputFrame = &inputArray[size_t(j) * numChannels];
+            for(uint32_t k = 0; k < numChannels; k++)
+                sumArray[k] += inputFrame[k] * weight;
+        }
+
+        float* outputFrame = &outputArray[size_t(i) * numChannels];
+        for(uint32_t k = 0; k < numChannels; k++)
+            outputFrame[k] = sumArray[k];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class WaveFile;
+
+// This converts a clip, once, when it's loaded, into exactly what the mixer plays: interleaved
+// 16-bit samples at the output's rate and channel count.  That way, the audio callback never
+// has to convert anything; it just scales and adds.  The sample rate conversion is done with
+// a windowed-sinc filter, which is far too slow for the callback, but fine to do up front.
+class AudioConverter
+{
+public:
+    AudioConverter();
+    virtual ~AudioConverter();
+
+    bool Convert(const WaveFile& waveFile, uint32_t framesPerSecond, uint32_t numChannels, std::vector<int16_t>& sampleArray);
+
+private:
+    static bool Decode(const WaveFile& waveFile, std::vector<float>& sampleArray);
+    static void RemapChannels(const std::vector<float>& inputArray, uint32_t numInputChannels, uint32_t numOutputChannels, std::vector<float>& outputArray);
+    void Resample(const std::vector<float>& inputArray, uint32_t numChannels, uint32_t inputFramesPerSecond, uint32_t outputFramesPerSecond, std::vector<float>& outputArray);
+    void BuildFilterTable();
+    float FilterAt(double x) const;
+
+    // This is the right half of the (symmetric) windowed sinc, sampled finely enough that linear interpolation is plenty.
+    std::vector<float> filterTableArray;
+};
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "AudioMixer.h"
+#include <math.h>
+#include <string.h>
+
+// Samples louder than this are eased into full scale, rather than being clipped once they pass it.
+#define AUDIO_MIXER_LIMITER_KNEE        0.8f
+
+// The synthesizer and a few sound effects together can sum past full scale, and a float stream
+// would pass that straight on to be hard-clipped further down.  Below the knee, samples go through
+// untouched.  Above it, what's left of the headroom is filled out along a tanh curve, so the output
+// never quite reaches full scale.
+static inline float LimitSample(float sample)
+{
+    float magnitude = ::fabsf(sample);
+    if(magnitude <= AUDIO_MIXER_LIMITER_KNEE)
+        return sample;
+
+    const float headroom = 1.0f - AUDIO_MIXER_LIMITER_KNEE;
+    float limited = AUDIO_MIXER_LIMITER_KNEE + headroom * ::tanhf((magnitude - AUDIO_MIXER_LIMITER_KNEE) / headroom);
+    return (sample < 0.0f) ? -limited : limited;
+}
+
+AudioMixer::AudioMixer()
+{
+    this->framesPerSecond = 0;
+    this->numChannels = 0;
+    this->sampleFormat = SampleFormat::FLOAT;
+    this->maxFramesPerMix = 0;
+    this->source = nullptr;
+    this->numActiveVoices = 0;
+    this->droppedCount = 0;
+    this->stolenCount = 0;
+}
+
+/*virtual*/ AudioMixer::~AudioMixer()
+{
+}
+
+bool AudioMixer::Setup(uint32_t framesPerSecond, uint32_t numChannels, SampleFormat sampleFormat, uint32_t maxVoices, uint32_t maxFramesPerMix)
+{
+    if(framesPerSecond == 0 || numChannels == 0 || maxVoices == 0 || maxFramesPerMix == 0)
+        return false;
+
+    this->framesPerSecond = framesPerSecond;
+    this->numChannels = numChannels;
+    this->sampleFormat = sampleFormat;
+    this->maxFramesPerMix = maxFramesPerMix;
+
+    this->voiceArray.resize(maxVoices);
+    this->numActiveVoices = 0;
+
+    this->mixBuffer.resize(maxFramesPerMix * numChannels);
+
+    // There's no point in queuing up more sounds than we could ever play at once, but leave room for a stop.
+    if(!this->commandQueue.Setup(maxVoices * 2))
+        return false;
+
+    this->droppedCount = 0;
+    this->stolenCount = 0;
+    return true;
+}
+
+void AudioMixer::Shutdown()
+{
+    this->voiceArray.clear();
+    this->numActiveVoices = 0;
+    this->mixBuffer.clear();
+}
+
+bool AudioMixer::Play(const Sound* sound, float gain /*= 1.0f*/)
+{
+    if(!sound || sound->numFrames == 0)
+        return false;
+
+    if(sound->numChannels != this->numChannels)
+        return false;
+
+    Command command{Command::PLAY, sound, gain};
+    if(!this->commandQueue.Push(command))
+    {
+        this->droppedCount++;
+        return false;
+    }
+
+    return true;
+}
+
+bool AudioMixer::StopAll()
+{
+    Command command{Command::STOP_ALL, nullptr, 0.0f};
+    return this->commandQueue.Push(command);
+}
+
+void AudioMixer::ExecuteCommands()
+{
+    Command command;
+    while(this->commandQueue.Pop(command))
+    {
+        switch(command.type)
+        {
+            case Command::PLAY:
+            {
+                Voice* voice = this->AllocateVoice();
+                voice->sound = command.sound;
+                voice->position = 0;
+                voice->gain = command.gain;
+                break;
+            }
+            case Command::STOP_ALL:
+            {
+                this->numActiveVoices = 0;
+                break;
+            }
+        }
+    }
+}
+
+AudioMixer::Voice* AudioMixer::AllocateVoice()
+{
+    if(this->numActiveVoices < this->voiceArray.size())
+        return &this->voiceArray[this->numActiveVoices++];
+
+    // Every voice is busy, so cut short the one with the least left to play.  It's the one we'd miss the least,
+    // and it's better than dropping the new sound, which is the one the player is expecting to hear.
+    Voice* stolenVoice = &this->voiceArray[0];
+    uint32_t leastFramesLeft = stolenVoice->sound->numFrames - stolenVoice->position;
+    for(uint32_t i = 1; i < this->numActiveVoices; i++)
+    {
+        Voice* voice = &this->voiceArray[i];
+        uint32_t numFramesLeft = voice->sound->numFrames - voice->position;
+        if(numFramesLeft < leastFramesLeft)
+        {
+            stolenVoice = voice;
+            leastFramesLeft = numFramesLeft;
+        }
+    }
+
+    this->stolenCount++;
+    return stolenVoice;
+}
+
+void AudioMixer::Mix(void* outputBuf, uint32_t numFrames)
+{
+    this->ExecuteCommands();
+
+    // The callback can ask for more than we planned for, so just work through it a chunk at a time.
+    uint32_t bytesPerSample = (this->sampleFormat == SampleFormat::INT16) ? 2 : 4;
+    uint8_t* outputByteBuf = static_cast<uint8_t*>(outputBuf);
+    while(numFrames > 0)
+    {
+        uint32_t numChunkFrames = (numFrames < this->maxFramesPerMix) ? numFrames : this->maxFramesPerMix;
+        float* mixBuf = this->mixBuffer.data();
+        ::memset(mixBuf, 0, numChunkFrames * this->numChannels * sizeof(float));
+
+        this->MixVoices(mixBuf, numChunkFrames);
+        if(this->source)
+            this->source->Render(mixBuf, numChunkFrames);
+        this->WriteOutput(mixBuf, outputByteBuf, numChunkFrames);
+
+        outputByteBuf += numChunkFrames * this->numChannels * bytesPerSample;
+        numFrames -= numChunkFrames;
+    }
+}
+
+void AudioMixer::MixVoices(float* mixBuf, uint32_t numFrames)
+{
+    uint32_t numChannels = this->numChannels;
+
+    uint32_t i = 0;
+    while(i < this->numActiveVoices)
+    {
+        Voice& voice = this->voiceArray[i];
+        const Sound* sound = voice.sound;
+
+        uint32_t numVoiceFrames = sound->numFrames - voice.position;
+        if(numVoiceFrames > numFrames)
+            numVoiceFrames = numFrames;
+
+        float scale = voice.gain / 32768.0f;
+        const int16_t* sampleBuf = sound->sampleBuf + voice.position * numChannels;
+        uint32_t numSamples = numVoiceFrames * numChannels;
+        for(uint32_t j = 0; j < numSamples; j++)
+            mixBuf[j] += float(sampleBuf[j]) * scale;
+
+        voice.position += numVoiceFrames;
+
+        // A finished voice is replaced by the last active one, so don't advance past it.
+        if(voice.position >= sound->numFrames)
+            voice = this->voiceArray[--this->numActiveVoices];
+        else
+            i++;
+    }
+}
+
+void AudioMixer::WriteOutput(const float* mixBuf, void* outputBuf, uint32_t numFrames) const
+{
+    uint32_t numSamples = numFrames * this->numChannels;
+
+    switch(this->sampleFormat)
+    {
+        case SampleFormat::FLOAT:
+        {
+            auto sampleBuf = static_cast<float*>(outputBuf);
+            for(uint32_t i = 0; i < numSamples; i++)
+                sampleBuf[i] = LimitSample(mixBuf[i]);
+            break;
+        }
+        case SampleFormat::INT16:
+        {
+            auto sampleBuf = static_cast<int16_t*>(outputBuf);
+            for(uint32_t i = 0; i < numSamples; i++)
+            {
+                sampleBuf[i] = int16_t(LimitSample(mixBuf[i]) * 32767.0f);
+            }
+            break;
+        }
+        case SampleFormat::INT32:
+        {
+            auto sampleBuf = static_cast<int32_t*>(outputBuf);
+            for(uint32_t i = 0; i < numSamples; i++)
+            {
+                sampleBuf[i] = int32_t(double(LimitSample(mixBuf[i])) * 2147483647.0);
+            }
+            break;
+        }
+    }
+}
\ No newline at end of file
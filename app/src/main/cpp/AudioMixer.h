@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "RingBuffer.h"
+
+// This mixes sounds together right inside the audio callback, so a sound can start
+// playing within one burst of being asked for, no matter what the frame rate is doing.
+// Everything the callback needs is allocated up front in Setup.  The main thread never
+// touches the voices directly; it posts commands to a lock-free queue that the callback
+// drains at the start of each mix.  Nothing here knows about oboe, so the same mixer
+// can run on a host just as well as on a device.
+class AudioMixer
+{
+public:
+    AudioMixer();
+    virtual ~AudioMixer();
+
+    enum class SampleFormat
+    {
+        INT16,
+        INT32,
+        FLOAT
+    };
+
+    // This is some PCM that a voice can play.  It must stay put (and unchanged) for as long as
+    // any voice might be playing it.  It must already be at the mixer's rate and channel count
+    // (see AudioConverter), so that mixing it in is nothing more than a scale and an add.
+    struct Sound
+    {
+        const int16_t* sampleBuf;
+        uint32_t numFrames;
+        uint32_t numChannels;
+    };
+
+    // This is something other than a sound that the mixer runs in the audio callback, like a synthesizer.  It adds
+    // whatever it renders into the mix buffer, which is interleaved float at the mixer's rate and channel count.
+    class Source
+    {
+    public:
+        virtual ~Source() {}
+
+        virtual void Render(float* mixBuf, uint32_t numFrames) = 0;
+    };
+
+    bool Setup(uint32_t framesPerSecond, uint32_t numChannels, SampleFormat sampleFormat, uint32_t maxVoices, uint32_t maxFramesPerMix);
+    void Shutdown();
+
+    // These may only be called from one thread, which in practice is the main thread.
+    bool Play(const Sound* sound, float gain = 1.0f);
+    bool StopAll();
+
+    // This may only be called before the audio callback starts running, or after it stops.
+    void SetSource(Source* source) { this->source = source; }
+
+    // This is only ever called from the audio thread.  It never allocates, locks or blocks.
+    void Mix(void* outputBuf, uint32_t numFrames);
+
+    uint32_t GetFramesPerSecond() const { return this->framesPerSecond; }
+    uint32_t GetNumChannels() const { return this->numChannels; }
+    SampleFormat GetSampleFormat() const { return this->sampleFormat; }
+
+    // Commands get dropped if the queue is full.  When every voice is busy, a new sound steals one of them.
+    uint32_t GetDroppedCount() const { return this->droppedCount.load(); }
+    uint32_t GetStolenCount() const { return this->stolenCount.load(); }
+
+private:
+    struct Command
+    {
+        enum Type
+        {
+            PLAY,
+            STOP_ALL
+        };
+
+        Type type;
+        const Sound* sound;
+        float gain;
+    };
+
+    struct Voice
+    {
+        const Sound* sound;
+        uint32_t position;
+        float gain;
+    };
+
+    void ExecuteCommands();
+    Voice* AllocateVoice();
+    void MixVoices(float* mixBuf, uint32_t numFrames);
+    void WriteOutput(const float* mixBuf, void* outputBuf, uint32_t numFrames) const;
+
+    uint32_t framesPerSecond;
+    uint32_t numChannels;
+    SampleFormat sampleFormat;
+    uint32_t maxFramesPerMix;
+
+    // The first numActiveVoices voices are the ones playing.
+    std::vector<Voice> voiceArray;
+    uint32_t numActiveVoices;
+
+    std::vector<float> mixBuffer;
+    Source* source;
+    RingBuffer<Command> commandQueue;
+    std::atomic<uint32_t> droppedCount;
+    std::atomic<uint32_t> stolenCount;
+};
\ No newline at end of file
@@ -1,9 +1,10 @@
 #include "AudioSubSystem.h"
 #include "AndroidOut.h"
-#include "Math/Utilities/Random.h"
-#include "Error.h"
-
-using namespace AudioDataLib;
+#include "WaveFile.h"
+#include "AudioConverter.h"
+#include "Options.h"
+#include <string.h>
+#include <time.h>
 
 //------------------------------ AudioSubSystem ------------------------------
 
@@ -12,13 +13,14 @@ AudioSubSystem::AudioSubSystem()
     this->systemSetup = false;
     this->audioStream = nullptr;
     this->audioFeeder = nullptr;
+    this->jobSystem = nullptr;
 }
 
 /*virtual*/ AudioSubSystem::~AudioSubSystem()
 {
 }
 
-bool AudioSubSystem::Setup(AAssetManager* assetManager)
+bool AudioSubSystem::Setup(AAssetManager* assetManager, JobSystem* jobSystem, const Options& options)
 {
     bool success = false;
     AAssetDir* audioDir = nullptr;
@@ -59,14 +61,14 @@ bool AudioSubSystem::Setup(AAssetManager* assetManager)
             break;
         }
 
-        if(!this->audioFeeder->Configure(this->audioStream))
+        if(!this->audioFeeder->Configure(this->audioStream, options))
         {
             aout << "Could not configure our audio sink based on the given audio stream." << std::endl;
             break;
         }
 
-        int bufferSizeFrames = this->audioStream->getFramesPerBurst() * 2;
-        this->audioStream->setBufferSizeInFrames(bufferSizeFrames);
+        aout << "Audio stream frames per burst: " << this->audioStream->getFramesPerBurst() << std::endl;
+        aout << "Audio stream buffer size: " << this->audioStream->getBufferSizeInFrames() << " of " << this->audioStream->getBufferCapacityInFrames() << " frames" << std::endl;
 
         result = this->audioStream->requestStart();
         if(result != oboe::Result::OK)
@@ -83,23 +85,15 @@ bool AudioSubSystem::Setup(AAssetManager* assetManager)
             break;
         }
 
-        bool loadFailureOccurred = false;
         while(true)
         {
             const char* audioFile = AAssetDir_getNextFileName(audioDir);
             if(!audioFile)
                 break;
 
-            char audioFilePath[128];
-            sprintf(audioFilePath, "audio/%s", audioFile);
-
             auto audioClip = new AudioClip();
             this->audioClipArray.push_back(audioClip);
-            if(!audioClip->Load(audioFilePath, assetManager))
-            {
-                loadFailureOccurred = true;
-                break;
-            }
+            audioClip->filePath = std::string("audio/") + audioFile;
 
             if(strstr(audioFile, "GO_") == audioFile)
                 audioClip->type = SoundFXType::GOOD_OUTCOME;
@@ -107,14 +101,27 @@ bool AudioSubSystem::Setup(AAssetManager* assetManager)
                 audioClip->type = SoundFXType::BAD_OUTCOME;
             else
                 audioClip->type = SoundFXType::UNKNOWN;
+
+            this->clipsByTypeArray[int(audioClip->type)].push_back(audioClip);
         }
 
-        if(loadFailureOccurred)
+        // Each clip is loaded by a job, and nothing waits for those jobs here.  A clip just isn't
+        // eligible to play until it's ready, so startup time doesn't grow with the number of clips we ship.
+        this->jobSystem = jobSystem;
+        const AudioMixer* mixer = &this->audioFeeder->mixer;
+        for(AudioClip* audioClip : this->audioClipArray)
         {
-            aout << "Failed to load all audio clips." << std::endl;
-            break;
+            audioClip->loadJob = new JobSystem::LambdaJob([audioClip, assetManager, mixer]()
+            {
+                if(!audioClip->Load(assetManager, mixer))
+                    aout << "Failed to load audio clip " << audioClip->filePath << "." << std::endl;
+            });
+
+            jobSystem->Submit(audioClip->loadJob);
         }
 
+        this->random.Seed(uint64_t(time(nullptr)));
+
         this->systemSetup = true;
         success = true;
         aout << "Audio sub-system successfully initialized!" << std::endl;
@@ -134,17 +141,27 @@ bool AudioSubSystem::Shutdown()
 {
     aout << "Shutting down audio sub-system..." << std::endl;
 
-    for(auto audioClip : this->audioClipArray)
-        delete audioClip;
-
-    this->audioClipArray.clear();
-
+    // The audio thread has to be stopped before we free any clips that its voices might be playing.
     if(this->audioStream)
     {
         this->audioStream->close();
         this->audioStream = nullptr;
     }
 
+    // Any clips still loading need to finish before we can free them.
+    for(auto audioClip : this->audioClipArray)
+    {
+        if(audioClip->loadJob)
+            this->jobSystem->WaitForJob(audioClip->loadJob);
+
+        delete audioClip;
+    }
+
+    this->audioClipArray.clear();
+
+    for(std::vector<AudioClip*>& clipArray : this->clipsByTypeArray)
+        clipArray.clear();
+
     if(this->audioFeeder)
     {
         delete this->audioFeeder;
@@ -156,21 +173,63 @@ bool AudioSubSystem::Shutdown()
     return true;
 }
 
-void AudioSubSystem::PlayFX(SoundFXType soundFXType)
+void AudioSubSystem::PlayFX(SoundFXType soundFXType, float gain /*= 1.0f*/)
 {
-    std::vector<AudioClip*> possibleClipsArray;
-    for(AudioClip* audioClip : this->audioClipArray)
-        if(audioClip->type == soundFXType)
-            possibleClipsArray.push_back(audioClip);
-
-    int i = PlanarPhysics::Random::Integer(0, possibleClipsArray.size() - 1);
-    AudioClip* chosenClip = possibleClipsArray[i];
-    this->audioFeeder->audioSink.AddAudioInput(new AudioStream(chosenClip->audioData));
+    if(!this->systemSetup)
+        return;
+
+    // This happens on every collision and tap, so it mustn't allocate or search.
+    const std::vector<AudioClip*>& clipArray = this->clipsByTypeArray[int(soundFXType)];
+    if(clipArray.size() == 0)
+        return;
+
+    // Right after startup, the clip we pick might not be loaded yet, in which case we settle for the next one that is.
+    int numClips = int(clipArray.size());
+    int i = this->random.Integer(0, numClips - 1);
+    for(int j = 0; j < numClips; j++)
+    {
+        AudioClip* chosenClip = clipArray[(i + j) % numClips];
+        if(chosenClip->IsReady())
+        {
+            this->audioFeeder->mixer.Play(&chosenClip->sound, gain);
+            break;
+        }
+    }
+}
+
+MidiSynth* AudioSubSystem::GetMidiSynth()
+{
+    if(!this->systemSetup)
+        return nullptr;
+
+    return &this->audioFeeder->synth;
 }
 
-bool AudioSubSystem::PumpAudio()
+bool AudioSubSystem::GetStats(Stats& stats) const
 {
-    this->audioFeeder->audioSink.GenerateAudio(0.05, 0.05);
+    if(!this->systemSetup)
+        return false;
+
+    stats.framesPerSecond = this->audioStream->getSampleRate();
+    stats.framesPerBurst = this->audioStream->getFramesPerBurst();
+    stats.bufferSizeFrames = this->audioStream->getBufferSizeInFrames();
+    stats.bufferCapacityFrames = this->audioStream->getBufferCapacityInFrames();
+
+    // Not every stream can count xruns or work out its latency (it depends on the device and the audio API in use).
+    oboe::ResultWithValue<int32_t> xRunResult = this->audioStream->getXRunCount();
+    stats.xRunCount = xRunResult ? xRunResult.value() : -1;
+
+    oboe::ResultWithValue<double> latencyResult = this->audioStream->calculateLatencyMillis();
+    stats.latencyMilliseconds = latencyResult ? latencyResult.value() : -1.0;
+
+    stats.errorCount = this->errorCallback.errorCount.load();
+    stats.droppedCount = this->audioFeeder->mixer.GetDroppedCount();
+    stats.stolenCount = this->audioFeeder->mixer.GetStolenCount();
+    stats.bufferGrowCount = this->audioFeeder->bufferTuner.GetGrowCount();
+    stats.bufferShrinkCount = this->audioFeeder->bufferTuner.GetShrinkCount();
+    stats.synthVoiceCount = this->audioFeeder->synth.GetActiveVoiceCount();
+    this->audioFeeder->callbackDuration.TakeSnapshot(stats.callbackDuration);
+
     return true;
 }
 
@@ -178,6 +237,7 @@ bool AudioSubSystem::PumpAudio()
 
 AudioSubSystem::ErrorCallback::ErrorCallback()
 {
+    this->errorCount = 0;
 }
 
 /*virtual*/ AudioSubSystem::ErrorCallback::~ErrorCallback()
@@ -186,6 +246,8 @@ AudioSubSystem::ErrorCallback::ErrorCallback()
 
 /*virtual*/ bool AudioSubSystem::ErrorCallback::onError(oboe::AudioStream* audioStream, oboe::Result result)
 {
+    this->errorCount++;
+
     aout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
     aout << "Audio error: " << oboe::convertToText(result) << std::endl;
     aout << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
@@ -197,85 +259,114 @@ AudioSubSystem::ErrorCallback::ErrorCallback()
 
 AudioSubSystem::AudioClip::AudioClip()
 {
-    this->audioData = nullptr;
+    this->audioAsset = nullptr;
+    this->sound = AudioMixer::Sound{nullptr, 0, 0};
     this->type = SoundFXType::UNKNOWN;
+    this->loadJob = nullptr;
+    this->ready = false;
 }
 
 /*virtual*/ AudioSubSystem::AudioClip::~AudioClip()
 {
+    delete this->loadJob;
     this->Unload();
 }
 
 void AudioSubSystem::AudioClip::Unload()
 {
-    if(this->audioData)
+    this->ready = false;
+
+    if(this->audioAsset)
     {
-        AudioData::Destroy(this->audioData);
-        this->audioData = nullptr;
+        AAsset_close(this->audioAsset);
+        this->audioAsset = nullptr;
     }
+
+    this->sampleArray.clear();
+    this->sound = AudioMixer::Sound{nullptr, 0, 0};
 }
 
-bool AudioSubSystem::AudioClip::Load(const char* audioFilePath, AAssetManager* assetManager)
+// Note: This is called on a worker thread.  The asset manager is fine with that, and nobody else touches the clip until it's ready.
+bool AudioSubSystem::AudioClip::Load(AAssetManager* assetManager, const AudioMixer* mixer)
 {
     bool success = false;
-    AAsset* audioAsset = nullptr;
-    WaveFileFormat waveFileFormat;
 
     do
     {
         this->Unload();
 
-        audioAsset = AAssetManager_open(assetManager, audioFilePath, AASSET_MODE_BUFFER);
-        if (!audioAsset)
+        // We keep the asset open for as long as the clip is loaded, since the mixer may be playing straight out of its buffer.
+        this->audioAsset = AAssetManager_open(assetManager, this->filePath.c_str(), AASSET_MODE_BUFFER);
+        if (!this->audioAsset)
             break;
 
-        int audioAssetSize = AAsset_getLength(audioAsset);
-        if (audioAssetSize == 0)
+        auto audioAssetSize = size_t(AAsset_getLength(this->audioAsset));
+        auto audioAssetBuf = static_cast<const uint8_t*>(AAsset_getBuffer(this->audioAsset));
+        if (!audioAssetBuf || audioAssetSize == 0)
             break;
 
-        const unsigned char* audioAssetBuf = static_cast<const unsigned char*>(AAsset_getBuffer(audioAsset));
-        ReadOnlyBufferStream inputStream(audioAssetBuf, audioAssetSize);
-
-        Error error;
-        FileData* fileData = nullptr;
-        if(!waveFileFormat.ReadFromStream(inputStream, fileData, error))
+        WaveFile waveFile;
+        if(!waveFile.Parse(audioAssetBuf, audioAssetSize))
+        {
+            aout << "Audio clip " << this->filePath << " is not a WAV file we understand." << std::endl;
             break;
+        }
 
-        this->audioData = dynamic_cast<AudioData*>(fileData);
-        if(!this->audioData)
-            break;
+        // If the clip is already exactly what the mixer plays, then the mixer can play it straight out of the asset,
+        // which is mapped from the APK, so this is zero-copy.  Otherwise, we convert it once, here, and let the asset go.
+        this->sound.numChannels = mixer->GetNumChannels();
+        if(waveFile.sampleType == WaveFile::SampleType::SIGNED_INTEGER && waveFile.bitsPerSample == 16 &&
+           waveFile.framesPerSecond == mixer->GetFramesPerSecond() && waveFile.numChannels == mixer->GetNumChannels() &&
+           (uintptr_t(waveFile.sampleBuf) & 1) == 0)
+        {
+            this->sound.sampleBuf = reinterpret_cast<const int16_t*>(waveFile.sampleBuf);
+            this->sound.numFrames = waveFile.numFrames;
+        }
+        else
+        {
+            AudioConverter audioConverter;
+            if(!audioConverter.Convert(waveFile, mixer->GetFramesPerSecond(), mixer->GetNumChannels(), this->sampleArray))
+            {
+                aout << "Audio clip " << this->filePath << " could not be converted to the output format." << std::endl;
+                break;
+            }
 
-        // Make sure the format is what we expect to process on the stream.
-        const AudioData::Format& format = this->audioData->GetFormat();
-        assert(format.numChannels == 1);
-        assert(format.bitsPerSample == 16);
-        assert(format.framesPerSecond == 48000);
-        assert(format.sampleType == AudioData::Format::SIGNED_INTEGER);
+            this->sound.sampleBuf = this->sampleArray.data();
+            this->sound.numFrames = uint32_t(this->sampleArray.size() / mixer->GetNumChannels());
+
+            AAsset_close(this->audioAsset);
+            this->audioAsset = nullptr;
+        }
 
         success = true;
     }
     while(false);
 
-    if(audioAsset)
-        AAsset_close(audioAsset);
-
-    if(!success)
+    if(success)
+        this->ready.store(true);
+    else
         this->Unload();
 
     return success;
 }
 
+bool AudioSubSystem::AudioClip::IsReady() const
+{
+    return this->ready.load();
+}
+
 //------------------------------ AudioSubSystem::AudioFeeder ------------------------------
 
-AudioSubSystem::AudioFeeder::AudioFeeder() : audioSink(true)
+AudioSubSystem::AudioFeeder::AudioFeeder()
 {
+    this->tuneBufferSize = false;
 }
 
 /*virtual*/ AudioSubSystem::AudioFeeder::~AudioFeeder()
 {
 }
 
-bool AudioSubSystem::AudioFeeder::Configure(oboe::AudioStream* audioStream)
+bool AudioSubSystem::AudioFeeder::Configure(oboe::AudioStream* audioStream, const Options& options)
 {
     int sampleRate = audioStream->getSampleRate();
     int numChannels = audioStream->getChannelCount();
@@ -287,22 +378,23 @@ bool AudioSubSystem::AudioFeeder::Configure(oboe::AudioStream* audioStream)
     aout << "Audio stream channels: " << numChannels << std::endl;
     aout << "Audio stream format: " << oboe::convertToText(sampleFormat) << std::endl;
 
-    AudioData::Format audioDataFormat;
-    audioDataFormat.bitsPerSample = bitDepth;
-    audioDataFormat.framesPerSecond = sampleRate;
-    audioDataFormat.numChannels = numChannels;
+    AudioMixer::SampleFormat mixerSampleFormat = AudioMixer::SampleFormat::FLOAT;
 
     switch(sampleFormat)
     {
         case oboe::AudioFormat::Float:
         {
-            audioDataFormat.sampleType = AudioData::Format::FLOAT;
+            mixerSampleFormat = AudioMixer::SampleFormat::FLOAT;
             break;
         }
         case oboe::AudioFormat::I16:
+        {
+            mixerSampleFormat = AudioMixer::SampleFormat::INT16;
+            break;
+        }
         case oboe::AudioFormat::I32:
         {
-            audioDataFormat.sampleType = AudioData::Format::SIGNED_INTEGER;
+            mixerSampleFormat = AudioMixer::SampleFormat::INT32;
             break;
         }
         default:
@@ -311,48 +403,61 @@ bool AudioSubSystem::AudioFeeder::Configure(oboe::AudioStream* audioStream)
         }
     }
 
-    this->audioSink.SetAudioOutput(new ThreadSafeAudioStream(audioDataFormat, new AudioMutex(), true));
-    return true;
-}
+    // The mixer can handle callbacks of any size, but sizing its buffer to a few bursts means it rarely has to split one up.
+    int maxFramesPerMix = audioStream->getFramesPerBurst() * 4;
+    if(maxFramesPerMix < 1024)
+        maxFramesPerMix = 1024;
 
-// Note: This is called on a thread other than the main thread!
-/*virtual*/ oboe::DataCallbackResult AudioSubSystem::AudioFeeder::onAudioReady(oboe::AudioStream* audioStream, void* audioData, int32_t numAudioFrames)
-{
-    const AudioData::Format& format = this->audioSink.GetAudioOutput()->GetFormat();
-    uint64_t numBytesNeeded = format.BytesPerFrame() * uint64_t(numAudioFrames);
-    uint64_t numBytesRead = this->audioSink.GetAudioOutput()->ReadBytesFromStream((uint8_t*)audioData, numBytesNeeded);
-    for(uint64_t i = numBytesRead; i < (uint64_t)numBytesNeeded; i++)
-        ((uint8_t*)audioData)[i] = 0;
+    if(!this->mixer.Setup(sampleRate, numChannels, mixerSampleFormat, AUDIO_MAX_VOICES, maxFramesPerMix))
+        return false;
 
-    return oboe::DataCallbackResult::Continue;
-}
+    if(!this->synth.Setup(sampleRate, numChannels, MIDI_SYNTH_MAX_VOICES))
+        return false;
 
-//------------------------------ AudioSubSystem::AudioMutex ------------------------------
+    this->mixer.SetSource(&this->synth);
 
-AudioSubSystem::AudioMutex::AudioMutex()
-{
-    pthread_mutex_init(&this->mutex, nullptr);
-}
+    // We'd rather start with as little latency as we can and back off only as much as this device needs.  That
+    // takes an xrun count, though, and without one, we just settle for two bursts, which is usually safe.
+    int framesPerBurst = audioStream->getFramesPerBurst();
+    int bufferCapacityFrames = audioStream->getBufferCapacityInFrames();
+    int minBursts = (options.audioMinBufferBursts > 1) ? options.audioMinBufferBursts : 1;
+    int maxBursts = (options.audioMaxBufferBursts > minBursts) ? options.audioMaxBufferBursts : minBursts;
+    if(!this->bufferTuner.Setup(sampleRate, framesPerBurst, bufferCapacityFrames, minBursts, maxBursts, options.audioShrinkAfterSeconds))
+        return false;
 
-/*virtual*/ AudioSubSystem::AudioMutex::~AudioMutex()
-{
-    pthread_mutex_destroy(&this->mutex);
+    this->tuneBufferSize = audioStream->isXRunCountSupported();
+    int bufferSizeFrames = this->tuneBufferSize ? int(this->bufferTuner.GetBufferSizeFrames()) : framesPerBurst * 2;
+    audioStream->setBufferSizeInFrames(bufferSizeFrames);
+
+    if(!this->tuneBufferSize)
+        aout << "Audio stream can't count xruns, so its buffer size won't be tuned." << std::endl;
+
+    return true;
 }
 
-/*virtual*/ void AudioSubSystem::AudioMutex::Lock()
+// Note: This is called on a thread other than the main thread!
+// It must never block or allocate, which is why all the real work is done by the mixer.
+/*virtual*/ oboe::DataCallbackResult AudioSubSystem::AudioFeeder::onAudioReady(oboe::AudioStream* audioStream, void* audioData, int32_t numAudioFrames)
 {
-    // The spin-wait here is being used to avoid preemption and may
-    // be justified since we should *never* have to wait very long
-    // for the lock to become available.
-    while(true)
+    struct timespec startTime, endTime;
+    ::clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    this->mixer.Mix(audioData, uint32_t(numAudioFrames));
+
+    if(this->tuneBufferSize)
     {
-        int result = pthread_mutex_trylock(&this->mutex);
-        if(result == 0)
-            break;
+        oboe::ResultWithValue<int32_t> xRunResult = audioStream->getXRunCount();
+        if(xRunResult)
+        {
+            uint32_t bufferSizeFrames = this->bufferTuner.Update(xRunResult.value(), uint32_t(numAudioFrames));
+            if(bufferSizeFrames > 0)
+                audioStream->setBufferSizeInFrames(int32_t(bufferSizeFrames));
+        }
     }
-}
 
-/*virtual*/ void AudioSubSystem::AudioMutex::Unlock()
-{
-    pthread_mutex_unlock(&this->mutex);
+    ::clock_gettime(CLOCK_MONOTONIC, &endTime);
+    int64_t nanoseconds = int64_t(endTime.tv_sec - startTime.tv_sec) * 1000000000 + int64_t(endTime.tv_nsec - startTime.tv_nsec);
+    this->callbackDuration.Record(uint64_t(nanoseconds > 0 ? nanoseconds : 0));
+
+    return oboe::DataCallbackResult::Continue;
 }
\ No newline at end of file
@@ -1,15 +1,23 @@
 #pragma once
 
 #include <oboe/Oboe.h>
-#include <ByteStream.h>
-#include <AudioData.h>
-#include <WaveFileFormat.h>
-#include <Mutex.h>
-#include <AudioSink.h>
 #include <android/asset_manager.h>
 #include <vector>
+#include <string>
+#include <atomic>
+#include "AudioMixer.h"
+#include "JobSystem.h"
+#include "RandomGenerator.h"
+#include "DurationHistogram.h"
+#include "AudioBufferTuner.h"
+#include "MidiSynth.h"
 #include <oboe/AudioStreamCallback.h>
 
+#define AUDIO_MAX_VOICES            16
+#define MIDI_SYNTH_MAX_VOICES       24
+
+class Options;
+
 // This is the abstraction layer between our game software and the underlying audio library.
 class AudioSubSystem
 {
@@ -17,18 +25,43 @@ public:
     AudioSubSystem();
     virtual ~AudioSubSystem();
 
-    bool Setup(AAssetManager* assetManager);
+    // The clips are loaded in the background on the given job system, which must outlive us.
+    bool Setup(AAssetManager* assetManager, JobSystem* jobSystem, const Options& options);
     bool Shutdown();
-    bool PumpAudio();
 
     enum class SoundFXType
     {
         UNKNOWN,
         GOOD_OUTCOME,
-        BAD_OUTCOME
+        BAD_OUTCOME,
+        NUM_TYPES
+    };
+
+    void PlayFX(SoundFXType soundFXType, float gain = 1.0f);
+
+    // Music plays through this when there's no MIDI device to send it to.  It's null until we're set up.
+    MidiSynth* GetMidiSynth();
+
+    // This is what we know about how the audio output is doing.  Anything the stream can't tell us is left negative.
+    struct Stats
+    {
+        int32_t framesPerSecond;
+        int32_t framesPerBurst;
+        int32_t bufferSizeFrames;
+        int32_t bufferCapacityFrames;
+        int32_t xRunCount;
+        double latencyMilliseconds;
+        uint32_t errorCount;
+        uint32_t droppedCount;
+        uint32_t stolenCount;
+        uint32_t bufferGrowCount;
+        uint32_t bufferShrinkCount;
+        uint32_t synthVoiceCount;
+        DurationHistogram::Snapshot callbackDuration;
     };
 
-    void PlayFX(SoundFXType soundFXType);
+    // This can be called from any thread while the sub-system is set up.
+    bool GetStats(Stats& stats) const;
 
 private:
 
@@ -39,19 +72,8 @@ private:
         virtual ~ErrorCallback();
 
         virtual bool onError(oboe::AudioStream* audioStream, oboe::Result result) override;
-    };
 
-    class AudioMutex : public AudioDataLib::Mutex
-    {
-    public:
-        AudioMutex();
-        virtual ~AudioMutex();
-
-        virtual void Lock() override;
-        virtual void Unlock() override;
-
-    private:
-        mutable pthread_mutex_t mutex;
+        std::atomic<uint32_t> errorCount;
     };
 
     class AudioClip
@@ -60,11 +82,17 @@ private:
         AudioClip();
         virtual ~AudioClip();
 
-        bool Load(const char* audioFilePath, AAssetManager* assetManager);
+        bool Load(AAssetManager* assetManager, const AudioMixer* mixer);
         void Unload();
+        bool IsReady() const;
 
-        AudioDataLib::AudioData* audioData;
+        std::string filePath;
+        AAsset* audioAsset;
+        std::vector<int16_t> sampleArray;
+        AudioMixer::Sound sound;
         SoundFXType type;
+        JobSystem::LambdaJob* loadJob;
+        std::atomic<bool> ready;
     };
 
     class AudioFeeder : public oboe::AudioStreamCallback
@@ -73,16 +101,29 @@ private:
         AudioFeeder();
         virtual ~AudioFeeder();
 
-        bool Configure(oboe::AudioStream* audioStream);
+        bool Configure(oboe::AudioStream* audioStream, const Options& options);
 
         virtual oboe::DataCallbackResult onAudioReady(oboe::AudioStream* audioStream, void* audioData, int32_t numAudioFrames) override;
 
-        AudioDataLib::AudioSink audioSink;
+        AudioMixer mixer;
+        MidiSynth synth;
+
+        // This is how long each callback took, which has to stay well under the time it takes to play the frames it produced.
+        DurationHistogram callbackDuration;
+
+        // This is only used if the stream can count xruns for us; otherwise, the buffer size stays where Configure put it.
+        AudioBufferTuner bufferTuner;
+        bool tuneBufferSize;
     };
 
     bool systemSetup;
     oboe::AudioStream* audioStream;
     AudioFeeder* audioFeeder;
     std::vector<AudioClip*> audioClipArray;
+
+    // The clips are sorted into these by type at setup so that picking one to play is quick.
+    std::vector<AudioClip*> clipsByTypeArray[int(SoundFXType::NUM_TYPES)];
+    RandomGenerator random;
     ErrorCallback errorCallback;
+    JobSystem* jobSystem;
 };
\ No newline at end of file
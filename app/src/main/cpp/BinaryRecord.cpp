@@ -0,0 +1,60 @@
+#include "BinaryRecord.h"
+#include "Checksum.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*static*/ void BinaryRecord::Pack(uint32_t magic, uint32_t version, const void* payloadBuf, size_t payloadSize, std::string& fileData)
+{
+    Header header;
+    ::memset(&header, 0, sizeof(Header));
+    header.magic = magic;
+    header.version = version;
+    header.headerSize = sizeof(Header);
+    header.payloadSize = uint32_t(payloadSize);
+    header.payloadChecksum = CalcCrc32(payloadBuf, payloadSize);
+
+    fileData.resize(sizeof(Header) + payloadSize);
+    ::memcpy(&fileData[0], &header, sizeof(Header));
+    if(payloadSize > 0)
+        ::memcpy(&fileData[sizeof(Header)], payloadBuf, payloadSize);
+}
+
+/*static*/ bool BinaryRecord::Unpack(const void* fileBuf, size_t fileBufSize, uint32_t magic, uint32_t version, void* payloadBuf, size_t payloadBufSize)
+{
+    if(fileBufSize < sizeof(Header))
+        return false;
+
+    Header header;
+    ::memcpy(&header, fileBuf, sizeof(Header));
+
+    if(header.magic != magic || header.version != version || header.headerSize < sizeof(Header) || header.headerSize > fileBufSize)
+        return false;
+
+    if(header.payloadSize != fileBufSize - header.headerSize)
+        return false;
+
+    const uint8_t* storedPayloadBuf = static_cast<const uint8_t*>(fileBuf) + header.headerSize;
+    if(CalcCrc32(storedPayloadBuf, header.payloadSize) != header.payloadChecksum)
+        return false;
+
+    ::memcpy(payloadBuf, storedPayloadBuf, (header.payloadSize < payloadBufSize) ? header.payloadSize : payloadBufSize);
+    return true;
+}
+
+/*static*/ bool BinaryRecord::ReadFile(const std::string& filePath, uint32_t magic, uint32_t version, void* payloadBuf, size_t payloadBufSize)
+{
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    // We ask for one more byte than a record can be so that we can tell if the file is too big to be one.
+    uint8_t fileBuf[BINARY_RECORD_MAX_FILE_SIZE + 1];
+    ssize_t fileBufSize = ::pread(fd, fileBuf, sizeof(fileBuf), 0);
+    ::close(fd);
+
+    if(fileBufSize <= 0 || fileBufSize > BINARY_RECORD_MAX_FILE_SIZE)
+        return false;
+
+    return Unpack(fileBuf, size_t(fileBufSize), magic, version, payloadBuf, payloadBufSize);
+}
\ No newline at end of file
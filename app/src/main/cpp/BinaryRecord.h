@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// No record file is ever bigger than this, so one read into a buffer on the stack always gets the whole thing.
+#define BINARY_RECORD_MAX_FILE_SIZE     4096
+
+// Small files like our progress and options are stored as one fixed-layout struct behind a
+// header, rather than as JSON, so that loading one is a single read, a checksum and a copy.
+//
+// A record only ever grows by adding fields to the end of its struct.  Reading copies in as
+// much of the stored record as the struct has room for, over a struct the caller has already
+// filled in with defaults, so an older file just leaves the newer fields at their defaults and
+// a newer file's extra fields are ignored.  The version only changes if a record is laid out
+// differently in some way that isn't just adding fields to the end, and then old files are
+// simply not read.
+class BinaryRecord
+{
+public:
+    // The checksum covers just the payload that follows.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t payloadSize;
+        uint32_t payloadChecksum;
+    };
+
+    static void Pack(uint32_t magic, uint32_t version, const void* payloadBuf, size_t payloadSize, std::string& fileData);
+    static bool Unpack(const void* fileBuf, size_t fileBufSize, uint32_t magic, uint32_t version, void* payloadBuf, size_t payloadBufSize);
+
+    static bool ReadFile(const std::string& filePath, uint32_t magic, uint32_t version, void* payloadBuf, size_t payloadBufSize);
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "Checksum.h"
+
+class CrcTable
+{
+public:
+    CrcTable()
+    {
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+                c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+
+            this->entry[i] = c;
+        }
+    }
+
+    uint32_t entry[256];
+};
+
+uint32_t CalcCrc32(const void* data, size_t size, uint32_t crc /*= 0*/)
+{
+    // The table gets built the first time through, and that's thread-safe, since it's a function-local static.
+    static CrcTable crcTable;
+
+    const uint8_t* byteArray = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++)
+        crc = crcTable.entry[(crc ^ byteArray[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
\ No newline at end of file
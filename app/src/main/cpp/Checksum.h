@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// This is the standard CRC-32 (as used by zip and png).  We use it to validate
+// the binary files we write to internal storage, since a file can end up
+// truncated or corrupted if the app dies at the wrong moment.
+uint32_t CalcCrc32(const void* data, size_t size, uint32_t crc = 0);
\ No newline at end of file
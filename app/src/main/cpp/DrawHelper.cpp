@@ -16,9 +16,10 @@ DrawHelper::DrawHelper()
     pthread_mutex_destroy(&this->frameArrayMutex);
 }
 
-bool DrawHelper::Setup(AAssetManager* assetManager)
+bool DrawHelper::Setup(AAssetManager* assetManager, const std::string& dataFolder)
 {
-    if(!this->lineShader.Load("lineFragmentShader.txt", "lineVertexShader.txt", assetManager))
+    // We come through here every time the window comes back, so the linked shader is cached to save rebuilding it each time.
+    if(!this->lineShader.Load("lineFragmentShader.txt", "lineVertexShader.txt", assetManager, dataFolder + "/line_shader.bin"))
         return false;
 
     return true;
@@ -14,7 +14,7 @@ public:
     DrawHelper();
     virtual ~DrawHelper();
 
-    bool Setup(AAssetManager* assetManager);
+    bool Setup(AAssetManager* assetManager, const std::string& dataFolder);
     bool Shutdown();
 
     void BeginRender(PlanarPhysics::Engine* engine, double aspectRatio);
@@ -0,0 +1,98 @@
+#include "DurationHistogram.h"
+
+//------------------------------ DurationHistogram ------------------------------
+
+DurationHistogram::DurationHistogram()
+{
+    this->Reset();
+}
+
+/*virtual*/ DurationHistogram::~DurationHistogram()
+{
+}
+
+void DurationHistogram::Reset()
+{
+    for(std::atomic<uint64_t>& bucketCount : this->bucketCountArray)
+        bucketCount.store(0, std::memory_order_relaxed);
+
+    this->count.store(0, std::memory_order_relaxed);
+    this->totalNanoseconds.store(0, std::memory_order_relaxed);
+    this->maxNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+// Bucket zero is everything under a microsecond, and bucket i after that is [2^(i-1), 2^i) microseconds.
+// The last bucket also takes everything too big for the others.
+/*static*/ uint32_t DurationHistogram::GetBucketIndex(uint64_t nanoseconds)
+{
+    uint64_t microseconds = nanoseconds / 1000;
+    uint32_t bucketIndex = 0;
+    while(microseconds > 0 && bucketIndex < DURATION_HISTOGRAM_NUM_BUCKETS - 1)
+    {
+        microseconds >>= 1;
+        bucketIndex++;
+    }
+
+    return bucketIndex;
+}
+
+/*static*/ double DurationHistogram::GetBucketUpperMicroseconds(uint32_t bucketIndex)
+{
+    return double(uint64_t(1) << bucketIndex);
+}
+
+// Note: Only one thread may ever call this, which is why plain loads and stores are good enough, even for the maximum.
+void DurationHistogram::Record(uint64_t nanoseconds)
+{
+    std::atomic<uint64_t>& bucketCount = this->bucketCountArray[GetBucketIndex(nanoseconds)];
+    bucketCount.store(bucketCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    this->totalNanoseconds.store(this->totalNanoseconds.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+
+    if(nanoseconds > this->maxNanoseconds.load(std::memory_order_relaxed))
+        this->maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+
+    this->count.store(this->count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void DurationHistogram::TakeSnapshot(Snapshot& snapshot) const
+{
+    snapshot.count = this->count.load(std::memory_order_acquire);
+    snapshot.totalNanoseconds = this->totalNanoseconds.load(std::memory_order_relaxed);
+    snapshot.maxNanoseconds = this->maxNanoseconds.load(std::memory_order_relaxed);
+
+    for(uint32_t i = 0; i < DURATION_HISTOGRAM_NUM_BUCKETS; i++)
+        snapshot.bucketCountArray[i] = this->bucketCountArray[i].load(std::memory_order_relaxed);
+}
+
+//------------------------------ DurationHistogram::Snapshot ------------------------------
+
+double DurationHistogram::Snapshot::GetMeanMicroseconds() const
+{
+    if(this->count == 0)
+        return 0.0;
+
+    return double(this->totalNanoseconds) / double(this->count) / 1000.0;
+}
+
+double DurationHistogram::Snapshot::GetPercentileMicroseconds(double fraction) const
+{
+    // We count the buckets up ourselves rather than trust the total, since it may be a sample or two off from them.
+    uint64_t bucketTotal = 0;
+    for(uint64_t bucketCount : this->bucketCountArray)
+        bucketTotal += bucketCount;
+
+    if(bucketTotal == 0)
+        return 0.0;
+
+    auto targetCount = uint64_t(fraction * double(bucketTotal));
+    uint64_t runningCount = 0;
+    for(uint32_t i = 0; i < DURATION_HISTOGRAM_NUM_BUCKETS; i++)
+    {
+        runningCount += this->bucketCountArray[i];
+        if(runningCount >= targetCount && this->bucketCountArray[i] > 0)
+            return GetBucketUpperMicroseconds(i);
+    }
+
+    return GetBucketUpperMicroseconds(DURATION_HISTOGRAM_NUM_BUCKETS - 1);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#define DURATION_HISTOGRAM_NUM_BUCKETS      24
+
+// This keeps a histogram of how long something took, such as each run of the audio
+// callback, so that we can see the slow tail and not just the average.  The buckets
+// double in width, starting at one microsecond, so a fixed handful of them covers
+// everything from a microsecond up to several seconds.  Exactly one thread records,
+// and it never blocks or allocates doing so.  Any other thread can take a snapshot
+// at any time; the counts in it might be a sample or two apart, but that's fine here.
+class DurationHistogram
+{
+public:
+    DurationHistogram();
+    virtual ~DurationHistogram();
+
+    struct Snapshot
+    {
+        uint64_t bucketCountArray[DURATION_HISTOGRAM_NUM_BUCKETS];
+        uint64_t count;
+        uint64_t totalNanoseconds;
+        uint64_t maxNanoseconds;
+
+        double GetMeanMicroseconds() const;
+
+        // This is the upper edge of the bucket the given fraction of the samples fall at or below.
+        double GetPercentileMicroseconds(double fraction) const;
+    };
+
+    void Record(uint64_t nanoseconds);
+    void TakeSnapshot(Snapshot& snapshot) const;
+    void Reset();
+
+    static uint32_t GetBucketIndex(uint64_t nanoseconds);
+    static double GetBucketUpperMicroseconds(uint32_t bucketIndex);
+
+private:
+    std::atomic<uint64_t> bucketCountArray[DURATION_HISTOGRAM_NUM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalNanoseconds;
+    std::atomic<uint64_t> maxNanoseconds;
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "GameLogic.h"
 #include "GameRender.h"
 #include "AndroidOut.h"
+#include <algorithm>
+#include <time.h>
 
 using namespace PlanarPhysics;
 
@@ -10,6 +12,14 @@ GameLogic::GameLogic(GameRender* gameRender)
     this->keepTicking = true;
     this->threadHandle = 0;
     this->state = nullptr;
+    this->currentLevel = 0;
+    this->levelRecord = LevelStats::Record{};
+    this->levelStartNanoseconds = 0;
+    this->stepSensorTimeNanoseconds = 0;
+    this->replayingInput = false;
+    this->replaySegmentIndex = 0;
+    this->replayStepCursor = 0;
+    this->replayStepEnd = 0;
 }
 
 /*virtual*/ GameLogic::~GameLogic()
@@ -44,11 +54,15 @@ bool GameLogic::Tick()
 {
     this->timeKeeper.Tick();
 
-    this->physicsWorld.accelerationDueToGravity = this->gameRender->GetGravityVector();
+    this->UpdateGravity();
 
     // Don't advance the physics unless we're also able to render it.
     if(this->gameRender->CanRender())
+    {
+        this->UpdateInputLog();
         this->physicsWorld.Tick();
+        this->levelRecord.physicsSteps++;
+    }
 
     if(this->state)
     {
@@ -57,6 +71,8 @@ bool GameLogic::Tick()
             this->SetState(newState);
     }
 
+    this->UpdateFrameTimes();
+
     if(this->gameRender->CanRender())
     {
         DrawHelper *drawHelper = this->gameRender->GetDrawHelper();
@@ -77,13 +93,13 @@ bool GameLogic::Tick()
         }
 
         Transform textTransform;
-        textTransform.scale = (this->progress.GetLevel() < 5) ? (MAZE_CELL_SIZE / 4.0) : (MAZE_CELL_SIZE / 2.0);
+        textTransform.scale = (this->currentLevel < 5) ? (MAZE_CELL_SIZE / 4.0) : (MAZE_CELL_SIZE / 2.0);
         char text[64];
         Color textColor;
         const BoundingBox &worldBox = this->physicsWorld.GetWorldBox();
 
         textTransform.translation = Vector2D(worldBox.min.x, worldBox.max.y);
-        sprintf(text, "Level %d", this->progress.GetLevel());
+        sprintf(text, "Level %d", this->currentLevel);
         textColor = Color(1.0, 1.0, 1.0);
         this->textRenderer.RenderText(text, textTransform, textColor, *drawHelper);
 
@@ -93,6 +109,9 @@ bool GameLogic::Tick()
         textColor = (frameRate < 60) ? ((frameRate < 30) ? Color(1.0, 0.0, 0.0) : Color(1.0, 1.0, 0.0)) : Color(0.0, 1.0, 0.0);
         this->textRenderer.RenderText(text, textTransform, textColor, *drawHelper);
 
+        if(this->gameRender->GetOptions().audioStats)
+            this->RenderAudioStats(textTransform, *drawHelper);
+
         this->state->Render(*drawHelper);
 
         drawHelper->EndRender();
@@ -101,6 +120,158 @@ bool GameLogic::Tick()
     return true;
 }
 
+void GameLogic::UpdateGravity()
+{
+    const Options& options = this->gameRender->GetOptions();
+
+    GravityTrack::Sample sampleBuf[64];
+    while(true)
+    {
+        size_t numSamples = this->gameRender->ReadGravitySamples(sampleBuf, sizeof(sampleBuf) / sizeof(sampleBuf[0]));
+        if(numSamples == 0)
+            break;
+
+        for(size_t i = 0; i < numSamples; i++)
+        {
+            this->gravityTrack.AddSample(sampleBuf[i]);
+            if(options.recordGravitySamples)
+                this->recordedGravitySampleArray.push_back(sampleBuf[i]);
+        }
+    }
+
+    // Each step is due a tick after the last one, like the ticks themselves, so waking up late doesn't jitter where we look.
+    // If we ever drift more than a tick from now, because we fell behind or the device slept in between, we start over.
+    const int64_t tickNanoseconds = 1000000000 / GAME_LOGIC_TICKS_PER_SECOND;
+    int64_t nowNanoseconds = GameRender::GetSensorTimeNanoseconds();
+    this->stepSensorTimeNanoseconds += tickNanoseconds;
+    if(this->stepSensorTimeNanoseconds < nowNanoseconds - tickNanoseconds || this->stepSensorTimeNanoseconds > nowNanoseconds + tickNanoseconds)
+        this->stepSensorTimeNanoseconds = nowNanoseconds;
+
+    // The newest sample can be up to a sensor period old, so we look that far back to land between two of them.
+    // Any prediction goes on top of that, to make up for the time it takes the step to reach the screen.
+    const auto latencyNanoseconds = int64_t(GRAVITY_TRACK_SENSOR_PERIOD_SECONDS * 1e9);
+    int64_t lookupTimeNanoseconds = this->stepSensorTimeNanoseconds - latencyNanoseconds + int64_t(options.gravityPredictionSeconds * 1e9);
+
+    Vector2D gravity(0.0, 0.0);
+    this->gravityTrack.Evaluate(lookupTimeNanoseconds, gravity);
+    this->physicsWorld.accelerationDueToGravity = gravity;
+}
+
+// This is called once for every physics step, right before it's taken.
+void GameLogic::UpdateInputLog()
+{
+    Vector2D& gravity = this->physicsWorld.accelerationDueToGravity;
+
+    InputLog::Step step{};
+    if(this->replayingInput)
+    {
+        // Frame timing decides exactly when one level gets swapped out for the next, so a replayed level can run a few
+        // steps past the end of what was recorded for it.  It's over by then anyway, so we just hold its last gravity.
+        const std::vector<InputLog::Step>& stepArray = this->inputLog.GetStepArray();
+        if(this->replayStepCursor < this->replayStepEnd)
+            step = stepArray[this->replayStepCursor++];
+        else if(this->replayStepEnd > 0)
+            step = stepArray[this->replayStepEnd - 1];
+    }
+    else
+    {
+        step.x = float(gravity.x);
+        step.y = float(gravity.y);
+        this->inputLog.RecordStep(step);
+    }
+
+    gravity = Vector2D(double(step.x), double(step.y));
+}
+
+bool GameLogic::BeginReplayLevel(InputLog::Level& level)
+{
+    const std::vector<InputLog::Segment>& segmentArray = this->inputLog.GetSegmentArray();
+    if(this->replaySegmentIndex >= segmentArray.size())
+    {
+        aout << "Input replay finished.  Back to the sensor." << std::endl;
+        this->replayingInput = false;
+        this->inputLog.Clear();
+        return false;
+    }
+
+    const InputLog::Segment& segment = segmentArray[this->replaySegmentIndex++];
+    level = segment.level;
+    this->replayStepCursor = segment.firstStep;
+    this->replayStepEnd = segment.firstStep + segment.stepCount;
+    if(segment.stepCount == 0)
+    {
+        this->replayStepCursor = 0;
+        this->replayStepEnd = 0;
+    }
+
+    return true;
+}
+
+void GameLogic::UpdateFrameTimes()
+{
+    // These are always drained, so that the queue never fills up between levels.
+    float frameMillisecondsBuf[64];
+    while(true)
+    {
+        size_t numFrameTimes = this->gameRender->ReadFrameTimes(frameMillisecondsBuf, sizeof(frameMillisecondsBuf) / sizeof(frameMillisecondsBuf[0]));
+        if(numFrameTimes == 0)
+            break;
+
+        this->frameMillisecondsArray.insert(this->frameMillisecondsArray.end(), frameMillisecondsBuf, frameMillisecondsBuf + numFrameTimes);
+    }
+}
+
+void GameLogic::BeginLevelStats(const InputLog::Level& level)
+{
+    this->levelRecord = LevelStats::Record{};
+    this->levelRecord.level = level.level;
+    this->levelRecord.seed = level.seed;
+    this->levelRecord.rows = level.rows;
+    this->levelRecord.cols = level.cols;
+    this->levelRecord.topology = level.topology;
+    this->levelRecord.flags = this->replayingInput ? uint32_t(LevelStats::REPLAYED) : 0;
+}
+
+// Everything we count for a level is counted from here, so that none of it includes the maze flying in.
+void GameLogic::StartLevelStats()
+{
+    this->levelRecord.physicsSteps = 0;
+    this->levelStartNanoseconds = TimeKeeper::GetTimeNanoseconds();
+    this->frameMillisecondsArray.clear();
+    this->physicsWorld.ResetStats();
+}
+
+void GameLogic::FinishLevelStats()
+{
+    LevelStats::Record& record = this->levelRecord;
+    record.finishTime = int64_t(::time(nullptr));
+    record.solveSeconds = float(double(TimeKeeper::GetTimeNanoseconds() - this->levelStartNanoseconds) / 1e9);
+    record.collisions = uint32_t(this->physicsWorld.GetBallCollisionCount());
+    record.evilBlockResets = uint32_t(this->physicsWorld.GetEvilBlockResetCount());
+    record.frameCount = uint32_t(this->frameMillisecondsArray.size());
+
+    if(this->frameMillisecondsArray.size() > 0)
+    {
+        double totalMilliseconds = 0.0;
+        float maxMilliseconds = 0.0f;
+        for(float frameMilliseconds : this->frameMillisecondsArray)
+        {
+            totalMilliseconds += frameMilliseconds;
+            maxMilliseconds = std::max(maxMilliseconds, frameMilliseconds);
+        }
+
+        record.frameMeanMilliseconds = float(totalMilliseconds / double(this->frameMillisecondsArray.size()));
+        record.frameMaxMilliseconds = maxMilliseconds;
+
+        // We're done with the frame times, so it doesn't matter that this shuffles them.
+        auto p99Iter = this->frameMillisecondsArray.begin() + ptrdiff_t(0.99 * double(this->frameMillisecondsArray.size() - 1));
+        std::nth_element(this->frameMillisecondsArray.begin(), p99Iter, this->frameMillisecondsArray.end());
+        record.frameP99Milliseconds = *p99Iter;
+    }
+
+    this->levelStats.Add(record);
+}
+
 void GameLogic::SetState(State* newState)
 {
     if(this->state)
@@ -115,6 +286,40 @@ void GameLogic::SetState(State* newState)
         this->state->Enter();
 }
 
+// The text renderer only has letters, digits and a few symbols, so anything we don't know is shown as a question mark.
+void GameLogic::RenderAudioStats(Transform textTransform, DrawHelper& drawHelper) const
+{
+    AudioSubSystem::Stats stats{};
+    if(!this->gameRender->GetAudioSubSystem()->GetStats(stats))
+        return;
+
+    char text[128];
+    char valueText[32];
+    Color textColor = (stats.xRunCount > 0 || stats.errorCount > 0) ? Color(1.0, 1.0, 0.0) : Color(1.0, 1.0, 1.0);
+
+    textTransform.scale /= 2.0;
+
+    textTransform.translation.y -= textTransform.scale * 1.5;
+    sprintf(text, "BURST = %d BUFFER = %d/%d", stats.framesPerBurst, stats.bufferSizeFrames, stats.bufferCapacityFrames);
+    this->textRenderer.RenderText(text, textTransform, textColor, drawHelper);
+
+    textTransform.translation.y -= textTransform.scale * 1.5;
+    if(stats.latencyMilliseconds >= 0.0)
+        sprintf(valueText, "%.1f MS", stats.latencyMilliseconds);
+    else
+        sprintf(valueText, "?");
+    if(stats.xRunCount >= 0)
+        sprintf(text, "XRUNS = %d LATENCY = %s ERRORS = %u", stats.xRunCount, valueText, stats.errorCount);
+    else
+        sprintf(text, "XRUNS = ? LATENCY = %s ERRORS = %u", valueText, stats.errorCount);
+    this->textRenderer.RenderText(text, textTransform, textColor, drawHelper);
+
+    textTransform.translation.y -= textTransform.scale * 1.5;
+    sprintf(text, "CALLBACK US AVG = %.1f P99 = %.0f MAX = %.0f", stats.callbackDuration.GetMeanMicroseconds(),
+            stats.callbackDuration.GetPercentileMicroseconds(0.99), double(stats.callbackDuration.maxNanoseconds) / 1000.0);
+    this->textRenderer.RenderText(text, textTransform, textColor, drawHelper);
+}
+
 /*static*/ void* GameLogic::ThreadEntryPoint(void* arg)
 {
     auto gameLogic = static_cast<GameLogic*>(arg);
@@ -124,14 +329,91 @@ void GameLogic::SetState(State* newState)
 
 void GameLogic::ThreadFunc()
 {
+    const Options& options = this->gameRender->GetOptions();
+    std::string internalDataPath = this->gameRender->GetApp()->activity->internalDataPath;
+
+    std::string mazeCacheFolder = internalDataPath + "/maze_cache";
+    if(!this->mazeCache.SetFolder(mazeCacheFolder))
+        aout << "Maze cache unavailable.  Mazes will always be generated from scratch." << std::endl;
+
+    if(!this->fileWriter.Start())
+        aout << "File writer thread didn't start.  Saves will be written on the game thread." << std::endl;
+
+    // From here on, our progress in memory is what counts.  It only ever goes out to storage.
+    if(!this->progress.Load(internalDataPath))
+    {
+        aout << "No saved progress, so starting from the beginning." << std::endl;
+        this->progress.Reset();
+        this->progress.Save(this->fileWriter);
+    }
+
+    if(!this->levelStats.Open(internalDataPath + "/level_stats.bin", &this->fileWriter))
+        aout << "Level stats won't be kept." << std::endl;
+
+    if(options.replayInputFile.length() > 0)
+    {
+        std::string logFile = (options.replayInputFile[0] == '/') ? options.replayInputFile : (internalDataPath + "/" + options.replayInputFile);
+        if(this->inputLog.Load(logFile))
+        {
+            this->replayingInput = true;
+            this->replaySegmentIndex = 0;
+            aout << "Replaying " << this->inputLog.GetSegmentArray().size() << " levels and " << this->inputLog.GetStepArray().size() << " steps from " << logFile << "." << std::endl;
+            if(this->inputLog.GetStepsPerSecond() != GAME_LOGIC_TICKS_PER_SECOND)
+                aout << "That log was recorded at " << this->inputLog.GetStepsPerSecond() << " steps per second, so it won't play back at the same speed." << std::endl;
+        }
+        else
+        {
+            aout << "Failed to load input log " << logFile << "." << std::endl;
+        }
+    }
+    else if(options.recordInput)
+    {
+        std::string logFile = internalDataPath + "/input_log.bin";
+        if(this->inputLog.BeginRecording(logFile, GAME_LOGIC_TICKS_PER_SECOND))
+            aout << "Recording input to " << logFile << "." << std::endl;
+    }
+
     this->SetState(new GenerateMazeState(this));
 
+    // Each tick is scheduled from the last one, not from when it finished, so the rate holds steady.
+    // If we ever fall more than a tick behind, though, there's no point in trying to catch up.
+    const int64_t tickNanoseconds = 1000000000 / GAME_LOGIC_TICKS_PER_SECOND;
+    int64_t tickTimeNanoseconds = TimeKeeper::GetTimeNanoseconds();
     while(this->keepTicking)
+    {
         if(!this->Tick())
             break;
 
-    this->progress.SetTouches(this->physicsWorld.GetGoodMazeBlockTouchedCount());
-    this->progress.Save(this->gameRender->GetApp());
+        int64_t nowNanoseconds = TimeKeeper::GetTimeNanoseconds();
+        tickTimeNanoseconds += tickNanoseconds;
+        if(tickTimeNanoseconds < nowNanoseconds)
+            tickTimeNanoseconds = nowNanoseconds;
+
+        TimeKeeper::SleepUntil(tickTimeNanoseconds);
+    }
+
+    if(!this->replayingInput)
+    {
+        this->progress.SetTouches(this->physicsWorld.GetGoodMazeBlockTouchedCount());
+        this->progress.Save(this->fileWriter);
+    }
+
+    // Like the gravity samples, this can be pulled off the device and played back with InputReplayRunner.
+    if(this->inputLog.IsRecording() && !this->inputLog.EndRecording())
+        aout << "Failed to finish the input log." << std::endl;
+
+    // These can be pulled off the device and played back with GravityTrackRunner.
+    if(this->recordedGravitySampleArray.size() > 0)
+    {
+        std::string sampleFile = std::string(this->gameRender->GetApp()->activity->internalDataPath) + "/gravity_samples.csv";
+        if(GravityTrack::SaveSampleFile(sampleFile.c_str(), this->recordedGravitySampleArray))
+            aout << "Saved " << this->recordedGravitySampleArray.size() << " gravity samples to " << sampleFile << "." << std::endl;
+        else
+            aout << "Failed to save gravity samples to " << sampleFile << "." << std::endl;
+    }
+
+    // Whatever saves are still waiting go out before we let the app go.
+    this->fileWriter.Stop();
 
     this->SetState(nullptr);
 
@@ -201,21 +483,60 @@ GameLogic::GenerateMazeState::GenerateMazeState(GameLogic* game) : State(game)
 
     maze.Clear();
 
-    if(!this->game->progress.Load(this->game->gameRender->GetApp()))
+    // Everything the maze is built from goes in here, whether it comes from our progress or from a replay.
+    InputLog::Level logLevel{};
+    Maze::Topology topology = Maze::Topology::RECTANGULAR;
+
+    if(this->game->replayingInput && this->game->BeginReplayLevel(logLevel))
+    {
+        if(logLevel.topology <= uint32_t(Maze::Topology::POLAR))
+            topology = Maze::Topology(logLevel.topology);
+    }
+    else
+    {
+        int level = this->game->progress.GetLevel();
+
+        if(options.mazeShape == "mixed")
+            topology = Maze::Topology(level % 3);
+        else if(!Maze::FindTopologyByName(options.mazeShape.c_str(), topology))
+            aout << "Maze shape \"" << options.mazeShape << "\" not recognized." << std::endl;
+
+        logLevel.level = level;
+        Maze::CalcLevelSize(level, this->game->gameRender->GetAspectRatio(), logLevel.rows, logLevel.cols);
+        logLevel.topology = uint32_t(topology);
+        logLevel.seed = this->game->progress.GetSeedModifier();
+        logLevel.touches = this->game->progress.GetTouches();
+        logLevel.queen = (level == FINAL_GRAVITY_MAZE_LEVEL) ? 1 : 0;
+        logLevel.bounce = options.bounce;
+    }
+
+    this->game->currentLevel = logLevel.level;
+
+    int rows = logLevel.rows;
+    int cols = logLevel.cols;
+    int seed = logLevel.seed;
+
+    aout << "Level " << logLevel.level << " is a " << Maze::GetTopologyName(topology) << " maze of size " << rows << " by " << cols << "." << std::endl;
+
+    if(!this->game->mazeCache.Load(topology, rows, cols, seed, maze))
+    {
+        RandomGenerator random(RandomGenerator::MixSeed(rows, cols, seed));
+        maze.Generate(rows, cols, random, topology);
+
+        if(!this->game->mazeCache.Save(seed, maze, this->game->fileWriter))
+            aout << "Failed to cache maze." << std::endl;
+    }
+    else
     {
-        aout << "Failed to load progress!" << std::endl;
-        this->game->progress.Reset();
+        aout << "Loaded maze from cache." << std::endl;
     }
 
-    int level = this->game->progress.GetLevel();
-    int rows = level + 5;
-    int cols = (int)::round(double(rows) * this->game->gameRender->GetAspectRatio());
+    maze.PopulatePhysicsWorld(&physicsEngine, logLevel.touches, logLevel.queen != 0, logLevel.bounce);
 
-    aout << "Level " << level << " is a maze of size " << rows << " by " << cols << "." << std::endl;
+    if(this->game->inputLog.IsRecording())
+        this->game->inputLog.RecordLevel(logLevel);
 
-    bool queen = (level == FINAL_GRAVITY_MAZE_LEVEL);
-    maze.Generate(rows, cols, this->game->progress.GetSeedModifier());
-    maze.PopulatePhysicsWorld(&physicsEngine, this->game->progress.GetTouches(), queen, options.bounce);
+    this->game->BeginLevelStats(logLevel);
 
     physicsEngine.accelerationDueToGravity = Vector2D(0.0, -options.gravity);
 
@@ -242,7 +563,8 @@ GameLogic::FlyMazeInState::FlyMazeInState(GameLogic* game) : State(game)
 
     const BoundingBox& worldBox = physicsEngine.GetWorldBox();
 
-    Random::Seed((unsigned)::time(nullptr));
+    // This is just for show, so it doesn't need to be reproducible like the maze itself.
+    RandomGenerator random((uint64_t)::time(nullptr));
 
     Vector2D verticalTranslation(0.0, worldBox.Height());
     Vector2D horizontalTranslation(worldBox.Width(), 0.0);
@@ -265,10 +587,12 @@ GameLogic::FlyMazeInState::FlyMazeInState(GameLogic* game) : State(game)
         MazeObject* mazeObject = dynamic_cast<MazeObject*>(planarObject);
         if(mazeObject)
         {
-            int i = Random::Integer(0, outerWorldBoxArray.size() - 1);
-            double angle = Random::Number(0.0, 2.0 * PLNR_PHY_PI);
+            int i = random.Integer(0, outerWorldBoxArray.size() - 1);
+            double angle = random.Number(0.0, 2.0 * PLNR_PHY_PI);
+            const BoundingBox& outerWorldBox = outerWorldBoxArray[i];
             mazeObject->sourceTransform.Identity();
-            mazeObject->sourceTransform.translation = outerWorldBoxArray[i].RandomPoint();
+            mazeObject->sourceTransform.translation.x = random.Number(outerWorldBox.min.x, outerWorldBox.max.x);
+            mazeObject->sourceTransform.translation.y = random.Number(outerWorldBox.min.y, outerWorldBox.max.y);
             mazeObject->sourceTransform.rotation = PScalar2D(angle).Exponent();
             mazeObject->targetTransform.Identity();
         }
@@ -364,6 +688,8 @@ GameLogic::PlayGameState::PlayGameState(GameLogic* game) : State(game)
 
 /*virtual*/ void GameLogic::PlayGameState::Enter()
 {
+    // The clock for the level starts once the maze has flown in and the player can do something about it.
+    this->game->StartLevelStats();
 }
 
 /*virtual*/ void GameLogic::PlayGameState::Leave()
@@ -374,14 +700,20 @@ GameLogic::PlayGameState::PlayGameState(GameLogic* game) : State(game)
 {
     if(this->game->physicsWorld.IsMazeSolved())
     {
-        MazeQueen* mazeQueen = this->game->physicsWorld.FindTheQueen();
-        if(!mazeQueen)
-            this->game->progress.SetLevel(this->game->progress.GetLevel() + 1);
-        else
-            this->game->progress.Reset();
+        this->game->FinishLevelStats();
 
-        this->game->progress.SetTouches(0);
-        this->game->progress.Save(this->game->gameRender->GetApp());
+        // A replay mustn't touch the player's own progress.
+        if(!this->game->replayingInput)
+        {
+            MazeQueen* mazeQueen = this->game->physicsWorld.FindTheQueen();
+            if(!mazeQueen)
+                this->game->progress.SetLevel(this->game->progress.GetLevel() + 1);
+            else
+                this->game->progress.Reset();
+
+            this->game->progress.SetTouches(0);
+            this->game->progress.Save(this->game->fileWriter);
+        }
 
         return new FlyMazeOutState(this->game);
     }
@@ -445,61 +777,4 @@ GameLogic::GameWonState::GameWonState(GameLogic* game) : State(game)
 
     // TODO: Can the user choose here to add their name to a database of game winners?
     //       Where could I host such a database?  Not for free, certainly, so maybe I won't bother.
-}
-
-//------------------------------ GameRender::PhysicsWorld ------------------------------
-
-GameLogic::PhysicsWorld::PhysicsWorld()
-{
-}
-
-/*virtual*/ GameLogic::PhysicsWorld::~PhysicsWorld()
-{
-}
-
-bool GameLogic::PhysicsWorld::IsMazeSolved()
-{
-    return this->GetGoodMazeBlockCount() == this->GetGoodMazeBlockTouchedCount() && this->QueenDeadOrNonExistent();
-}
-
-int GameLogic::PhysicsWorld::GetGoodMazeBlockCount()
-{
-    int count = 0;
-    for(auto planarObject : this->GetPlanarObjectArray())
-        if(dynamic_cast<GoodMazeBlock*>(planarObject))
-            count++;
-
-    return count;
-}
-
-int GameLogic::PhysicsWorld::GetGoodMazeBlockTouchedCount()
-{
-    int count = 0;
-
-    for(auto planarObject : this->GetPlanarObjectArray())
-    {
-        auto goodMazeBlock = dynamic_cast<GoodMazeBlock *>(planarObject);
-        if (goodMazeBlock && goodMazeBlock->IsTouched())
-            count++;
-    }
-
-    return count;
-}
-
-bool GameLogic::PhysicsWorld::QueenDeadOrNonExistent()
-{
-    MazeQueen* mazeQueen = this->FindTheQueen();
-    return !mazeQueen || !mazeQueen->alive;
-}
-
-MazeQueen* GameLogic::PhysicsWorld::FindTheQueen()
-{
-    for(auto planarObject : this->GetPlanarObjectArray())
-    {
-        auto mazeQueen = dynamic_cast<MazeQueen *>(planarObject);
-        if (mazeQueen)
-            return mazeQueen;
-    }
-
-    return nullptr;
 }
\ No newline at end of file
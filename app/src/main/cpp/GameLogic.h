@@ -14,9 +14,19 @@
 #include "PlanarObjects/RigidBody.h"
 #include "TextRenderer.h"
 #include "Progress.h"
+#include "PhysicsWorld.h"
+#include "MazeCache.h"
+#include "GravityTrack.h"
+#include "InputLog.h"
+#include "AsyncFileWriter.h"
+#include "LevelStats.h"
 
 #define FINAL_GRAVITY_MAZE_LEVEL        40
 
+// The logic thread sleeps between ticks rather than spinning, so this is as often as it ever runs.
+// The physics steps once per tick, so these have to be the same.
+#define GAME_LOGIC_TICKS_PER_SECOND     PHYSICS_WORLD_STEPS_PER_SECOND
+
 class GameRender;
 
 class GameLogic
@@ -29,19 +39,6 @@ public:
     bool Shutdown();
     bool Tick();
 
-    class PhysicsWorld : public PlanarPhysics::Engine
-    {
-    public:
-        PhysicsWorld();
-        virtual ~PhysicsWorld();
-
-        bool IsMazeSolved();
-        int GetGoodMazeBlockCount();
-        int GetGoodMazeBlockTouchedCount();
-        bool QueenDeadOrNonExistent();
-        MazeQueen* FindTheQueen();
-    };
-
 private:
     class State
     {
@@ -130,12 +127,45 @@ private:
     pthread_t threadHandle;
 
     void SetState(State* newState);
+    void UpdateGravity();
+    void UpdateInputLog();
+    bool BeginReplayLevel(InputLog::Level& level);
+    void UpdateFrameTimes();
+    void BeginLevelStats(const InputLog::Level& level);
+    void StartLevelStats();
+    void FinishLevelStats();
+    void RenderAudioStats(PlanarPhysics::Transform textTransform, DrawHelper& drawHelper) const;
 
     State* state;
     PhysicsWorld physicsWorld;
     Maze maze;
+    MazeCache mazeCache;
     GameRender* gameRender;
     TextRenderer textRenderer;
     Progress progress;
+    AsyncFileWriter fileWriter;
     TimeKeeper timeKeeper;
+
+    // This is the level being played, which isn't always the one in our progress (e.g., during a replay).
+    int currentLevel;
+
+    // How the level being played is going is kept here until it's solved, and then it goes in the log.
+    LevelStats levelStats;
+    LevelStats::Record levelRecord;
+    int64_t levelStartNanoseconds;
+    std::vector<float> frameMillisecondsArray;
+
+    // Gravity for each step is looked up here, at the step's own time, from the samples the sensor has given us so far.
+    // Steps are timed on the sensor's clock, which keeps counting while the device sleeps, unlike the one we tick by.
+    GravityTrack gravityTrack;
+    int64_t stepSensorTimeNanoseconds;
+    std::vector<GravityTrack::Sample> recordedGravitySampleArray;
+
+    // When we're replaying, each level and the gravity for each step come from here instead of from progress and the sensor.
+    // Otherwise, if asked, this is where we record them.
+    InputLog inputLog;
+    bool replayingInput;
+    size_t replaySegmentIndex;
+    size_t replayStepCursor;
+    size_t replayStepEnd;
 };
\ No newline at end of file
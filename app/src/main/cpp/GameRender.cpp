@@ -6,6 +6,7 @@
 #include <vector>
 #include <assert.h>
 #include <filesystem>
+#include <algorithm>
 #include "AndroidOut.h"
 
 using namespace PlanarPhysics;
@@ -26,6 +27,15 @@ GameRender::GameRender(android_app* app) : midiManager(app)
     this->sensorManager = nullptr;
     this->gravitySensor = nullptr;
     this->sensorEventQueue = nullptr;
+    this->choreographer = nullptr;
+    this->frameCallbackPosted = false;
+    this->frameDue = false;
+    this->frameTimeNanoseconds = 0;
+    this->lastFrameTimeNanoseconds = 0;
+    this->filteredGravityArray[0] = 0.0;
+    this->filteredGravityArray[1] = 0.0;
+    this->filteredGravityArray[2] = 0.0;
+    this->lastGravityTimeNanoseconds = 0;
 }
 
 /*virtual*/ GameRender::~GameRender()
@@ -63,6 +73,15 @@ GameRender::GameRender(android_app* app) : midiManager(app)
     }
 }
 
+// The choreographer calls this from inside ALooper_pollOnce on our own thread, once per vsync that we ask for.
+/*static*/ void GameRender::HandleFrameCallback(int64_t frameTimeNanoseconds, void* data)
+{
+    auto gameRender = static_cast<GameRender*>(data);
+    gameRender->frameCallbackPosted = false;
+    gameRender->frameDue = true;
+    gameRender->frameTimeNanoseconds = frameTimeNanoseconds;
+}
+
 /*static*/ bool GameRender::MotionEventFilter(const GameActivityMotionEvent* motionEvent)
 {
     int sourceClass = motionEvent->source & AINPUT_SOURCE_CLASS_MASK;
@@ -92,7 +111,15 @@ bool GameRender::Setup()
     // TODO: Why doesn't this work?  :(
     GameActivity_setWindowFlags(this->app->activity, AWINDOW_FLAG_KEEP_SCREEN_ON, 0);
 
-    if(!this->options.Load(this->app))
+    if(!this->jobSystem.Setup())
+    {
+        aout << "Failed to setup the job system!" << std::endl;
+        return false;
+    }
+
+    aout << "Job system running with " << this->jobSystem.GetWorkerCount() << " workers." << std::endl;
+
+    if(!this->options.Load(this->app->activity->internalDataPath, this->app->activity->assetManager))
     {
         aout << "Failed to load options!" << std::endl;
         return false;
@@ -141,6 +168,17 @@ bool GameRender::Setup()
         return false;
     }
 
+    if(!this->gravitySampleQueue.Setup(GAME_RENDER_GRAVITY_QUEUE_SIZE))
+        return false;
+
+    if(!this->frameTimeQueue.Setup(GAME_RENDER_FRAME_TIME_QUEUE_SIZE))
+        return false;
+
+    // Without a choreographer, we fall back on eglSwapBuffers to pace us, which is how we used to do it.
+    this->choreographer = AChoreographer_getInstance();
+    if(!this->choreographer)
+        aout << "No choreographer for the main thread.  Frames will be paced by buffer swaps alone." << std::endl;
+
     this->sensorEventQueue = ASensorManager_createEventQueue(this->sensorManager, looper, SENSOR_EVENT_ID, nullptr, nullptr);
     if(!this->sensorEventQueue)
     {
@@ -154,12 +192,20 @@ bool GameRender::Setup()
         return false;
     }
 
-    if(this->options.audio && !this->audioSubSystem.Setup(this->app->activity->assetManager))
+    // The sensor's default rate is far slower than we step the physics.  We ask for more, but no more than it can give.
+    int32_t samplePeriodMicroseconds = std::max(int32_t(GRAVITY_TRACK_SENSOR_PERIOD_SECONDS * 1e6), int32_t(ASensor_getMinDelay(this->gravitySensor)));
+    if(0 != ASensorEventQueue_setEventRate(this->sensorEventQueue, this->gravitySensor, samplePeriodMicroseconds))
+        aout << "Failed to set the gravity sensor rate." << std::endl;
+
+    if(this->options.audio && !this->audioSubSystem.Setup(this->app->activity->assetManager, &this->jobSystem, this->options))
     {
         aout << "Failed to initialize the audio sub-system." << std::endl;
         return false;
     }
 
+    this->midiManager.SetJobSystem(&this->jobSystem);
+    this->midiManager.SetSynth(this->audioSubSystem.GetMidiSynth());
+
     this->initialized = true;
     return true;
 }
@@ -184,6 +230,8 @@ bool GameRender::Shutdown()
 
     this->audioSubSystem.Shutdown();
 
+    this->jobSystem.Shutdown();
+
     this->app->userData = nullptr;
 
     this->initialized = false;
@@ -269,7 +317,7 @@ bool GameRender::SetupWindow()
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
-    if(!this->drawHelper.Setup(this->app->activity->assetManager))
+    if(!this->drawHelper.Setup(this->app->activity->assetManager, this->app->activity->internalDataPath))
     {
         aout << "Failed to setup draw-helper." << std::endl;
         return false;
@@ -282,6 +330,9 @@ bool GameRender::ShutdownWindow()
 {
     this->drawHelper.Shutdown();
 
+    // The time we spend without a window isn't a frame.
+    this->lastFrameTimeNanoseconds = 0;
+
     if (this->display != EGL_NO_DISPLAY)
     {
         eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -310,29 +361,86 @@ bool GameRender::CanRender()
     return this->display != EGL_NO_DISPLAY && this->GetAspectRatio() != 0.0;
 }
 
+// Sensors can report a lot faster than we render, so we take everything that's queued up and run it all
+// through the filter in order, passing each filtered sample on to the logic thread.
 void GameRender::HandleSensorEvent(void* data)
 {
-    ASensorEvent sensorEvent;
-    if(ASensorEventQueue_getEvents(this->sensorEventQueue, &sensorEvent, 1) > 0)
+    ASensorEvent sensorEventArray[GAME_RENDER_SENSOR_BATCH_SIZE];
+
+    while(true)
     {
-        switch(sensorEvent.type)
+        ssize_t numEvents = ASensorEventQueue_getEvents(this->sensorEventQueue, sensorEventArray, GAME_RENDER_SENSOR_BATCH_SIZE);
+        if(numEvents <= 0)
+            break;
+
+        for(ssize_t i = 0; i < numEvents; i++)
         {
-            case ASENSOR_TYPE_GRAVITY:
+            const ASensorEvent& sensorEvent = sensorEventArray[i];
+            switch(sensorEvent.type)
             {
-                //aout << "Gravity sensed: " << sensorEvent.vector.x << ", " << sensorEvent.vector.y << ", " << sensorEvent.vector.z << std::endl;
-
-                Vector2D vector(-sensorEvent.vector.x, -sensorEvent.vector.y);
-                if(!vector.Normalize())
-                    vector = Vector2D(0.0, 0.0);
-
-                // I suppose the game thread could read this value when it has only been partially written.  Hmmm...
-                this->gravityVector = vector * this->options.gravity * ::sqrt(::abs(1.0 - ::abs(sensorEvent.vector.z / 9.8)));
-                break;
+                case ASENSOR_TYPE_GRAVITY:
+                {
+                    //aout << "Gravity sensed: " << sensorEvent.vector.x << ", " << sensorEvent.vector.y << ", " << sensorEvent.vector.z << std::endl;
+
+                    // This is a one-pole low-pass filter.  Going by the time between readings, rather than
+                    // assuming a fixed rate, keeps it responding the same no matter how fast the sensor reports.
+                    double alpha = 1.0;
+                    if(this->lastGravityTimeNanoseconds != 0 && this->options.gravitySmoothingSeconds > 0.0)
+                    {
+                        double deltaTimeSeconds = double(sensorEvent.timestamp - this->lastGravityTimeNanoseconds) / 1e9;
+                        alpha = (deltaTimeSeconds > 0.0) ? (1.0 - ::exp(-deltaTimeSeconds / this->options.gravitySmoothingSeconds)) : 0.0;
+                    }
+
+                    for(int j = 0; j < 3; j++)
+                        this->filteredGravityArray[j] += alpha * (sensorEvent.vector.v[j] - this->filteredGravityArray[j]);
+
+                    this->lastGravityTimeNanoseconds = sensorEvent.timestamp;
+
+                    // The logic thread gets every sample, so that it can line them up with its own steps.
+                    // If it isn't running, the queue just fills up and the newest samples are dropped.
+                    this->gravitySampleQueue.Push(this->MakeGravitySample());
+                    break;
+                }
             }
         }
+
+        if(numEvents < GAME_RENDER_SENSOR_BATCH_SIZE)
+            break;
     }
 }
 
+GravityTrack::Sample GameRender::MakeGravitySample() const
+{
+    Vector2D vector(-this->filteredGravityArray[0], -this->filteredGravityArray[1]);
+    if(!vector.Normalize())
+        vector = Vector2D(0.0, 0.0);
+
+    vector = vector * this->options.gravity * ::sqrt(::abs(1.0 - ::abs(this->filteredGravityArray[2] / 9.8)));
+
+    GravityTrack::Sample gravitySample{};
+    gravitySample.timeNanoseconds = this->lastGravityTimeNanoseconds;
+    gravitySample.x = vector.x;
+    gravitySample.y = vector.y;
+    return gravitySample;
+}
+
+size_t GameRender::ReadGravitySamples(GravityTrack::Sample* sampleBuf, size_t maxSamples)
+{
+    return this->gravitySampleQueue.Read(sampleBuf, maxSamples);
+}
+
+size_t GameRender::ReadFrameTimes(float* frameMillisecondsBuf, size_t maxFrameTimes)
+{
+    return this->frameTimeQueue.Read(frameMillisecondsBuf, maxFrameTimes);
+}
+
+/*static*/ int64_t GameRender::GetSensorTimeNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_BOOTTIME, &now);
+    return int64_t(now.tv_sec) * 1000000000 + int64_t(now.tv_nsec);
+}
+
 void GameRender::HandleTapEvents()
 {
     struct android_input_buffer* inputBuffer = android_app_swap_input_buffers(this->app);
@@ -364,36 +472,72 @@ void GameRender::HandleTapEvents()
     android_app_clear_motion_events(inputBuffer);
 }
 
-bool GameRender::Tick()
+// We block here until there's something to do: a vsync we asked for, a sensor reading, a window
+// command, or just the poll timeout.  Once awake, we drain everything that's pending before returning,
+// rather than handle one event per frame and let the rest back up.
+void GameRender::PollEvents()
 {
-    this->timeKeeper.Tick();
+    int timeoutMilliseconds = GAME_RENDER_MAX_POLL_MILLISECONDS;
 
-    this->HandleTapEvents();
+    if(this->initialized && this->display != EGL_NO_DISPLAY)
+    {
+        if(!this->choreographer)
+        {
+            this->frameDue = true;
+        }
+        else if(!this->frameCallbackPosted)
+        {
+            AChoreographer_postFrameCallback64(this->choreographer, &GameRender::HandleFrameCallback, this);
+            this->frameCallbackPosted = true;
+        }
+    }
 
-    this->audioSubSystem.PumpAudio();
-    this->midiManager.Manage();
+    if(this->frameDue)
+        timeoutMilliseconds = 0;
 
-    void* data = nullptr;
-    int events = 0;
-    int id = ALooper_pollOnce(0, nullptr, &events, &data);
-    if (id >= 0)
+    while(true)
     {
-        switch(id)
+        void* data = nullptr;
+        int events = 0;
+        int id = ALooper_pollOnce(timeoutMilliseconds, nullptr, &events, &data);
+        if(id == ALOOPER_POLL_TIMEOUT || id == ALOOPER_POLL_ERROR)
+            break;
+
+        timeoutMilliseconds = 0;
+
+        if(id >= 0)
         {
-            case GameRender::SENSOR_EVENT_ID:
+            switch(id)
             {
-                this->HandleSensorEvent(data);
-                break;
-            }
-            default:
-            {
-                auto source = reinterpret_cast<android_poll_source*>(data);
-                if (source)
-                    source->process(app, source);
-                break;
+                case GameRender::SENSOR_EVENT_ID:
+                {
+                    this->HandleSensorEvent(data);
+                    break;
+                }
+                default:
+                {
+                    auto source = reinterpret_cast<android_poll_source*>(data);
+                    if (source)
+                        source->process(app, source);
+                    break;
+                }
             }
         }
+
+        if(this->app->destroyRequested)
+            break;
     }
+}
+
+bool GameRender::Tick()
+{
+    this->PollEvents();
+
+    this->timeKeeper.Tick();
+
+    this->HandleTapEvents();
+
+    this->midiManager.Manage();
 
     android_input_buffer* inputBuffer = android_app_swap_input_buffers(this->app);
     if (inputBuffer)
@@ -419,8 +563,8 @@ bool GameRender::Tick()
         android_app_clear_key_events(inputBuffer);
     }
 
-    // Render a frame if we're initialized and we have a window.
-    if(this->initialized && this->display != EGL_NO_DISPLAY)
+    // Render a frame if we're initialized, we have a window, and it's time for one.
+    if(this->frameDue && this->initialized && this->display != EGL_NO_DISPLAY)
     {
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -429,8 +573,18 @@ bool GameRender::Tick()
         // This call can sometimes block for a long time.
         auto swapResult = eglSwapBuffers(this->display, this->surface);
         assert(swapResult == EGL_TRUE);
+
+        // We only ask for the next vsync once this frame is done, so a frame that runs long makes us miss vsyncs, and
+        // that shows up here as a longer time between the vsyncs we did get.  Without a choreographer, we go swap to swap.
+        int64_t frameTimeNanoseconds = this->choreographer ? this->frameTimeNanoseconds : TimeKeeper::GetTimeNanoseconds();
+        if(this->lastFrameTimeNanoseconds != 0)
+            this->frameTimeQueue.Push(float(double(frameTimeNanoseconds - this->lastFrameTimeNanoseconds) / 1e6));
+
+        this->lastFrameTimeNanoseconds = frameTimeNanoseconds;
     }
 
+    this->frameDue = false;
+
     return !this->app->destroyRequested;
 }
 
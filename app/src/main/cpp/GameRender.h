@@ -4,6 +4,7 @@
 #include <EGL/egl.h>
 #include <memory>
 #include <android/sensor.h>
+#include <android/choreographer.h>
 #include "AudioSubSystem.h"
 #include "MidiManager.h"
 #include "Engine.h"
@@ -11,11 +12,28 @@
 #include "DrawHelper.h"
 #include "Options.h"
 #include "TimeKeeper.h"
+#include "JobSystem.h"
+#include "RingBuffer.h"
+#include "GravityTrack.h"
 #include "Math/GeometricAlgebra/Vector2D.h"
 
+// The main loop sleeps on the looper until something happens, but never longer than this,
+// so that the MIDI manager still gets a look in now and then when there's no window.
+#define GAME_RENDER_MAX_POLL_MILLISECONDS       100
+
+// This is how many sensor events we pull off the queue per call while draining it.
+#define GAME_RENDER_SENSOR_BATCH_SIZE           16
+
+// Filtered gravity samples wait here for the logic thread.  That's over a second's worth at the fastest sensor rates.
+#define GAME_RENDER_GRAVITY_QUEUE_SIZE          256
+
+// Frame times wait here for the logic thread.  That's a few seconds' worth at any display rate.
+#define GAME_RENDER_FRAME_TIME_QUEUE_SIZE       512
+
 struct android_app;
 
 // We don't just render here; we also handle sensor input and audio output.
+// We also own the job system that all other sub-systems share.
 class GameRender
 {
 public:
@@ -37,8 +55,11 @@ public:
 
     Options& GetOptions() { return this->options; }
     android_app* GetApp() { return this->app; }
+    JobSystem* GetJobSystem() { return &this->jobSystem; }
+    const AudioSubSystem* GetAudioSubSystem() const { return &this->audioSubSystem; }
 
     static void HandleAndroidCommand(android_app* app, int32_t cmd);
+    static void HandleFrameCallback(int64_t frameTimeNanoseconds, void* data);
     static bool MotionEventFilter(const GameActivityMotionEvent* motionEvent);
 
     bool CanRender();
@@ -46,10 +67,21 @@ public:
     DrawHelper* GetDrawHelper() { return &this->drawHelper; }
     double GetAspectRatio() const;
 
-    const PlanarPhysics::Vector2D& GetGravityVector() const { return this->gravityVector; }
+    // This hands over every filtered sample since the last call, oldest first.  Only the logic thread may call it.
+    size_t ReadGravitySamples(GravityTrack::Sample* sampleBuf, size_t maxSamples);
+
+    // This hands over the time, in milliseconds, between each frame we've shown since the last call and the one before it.
+    // Only the logic thread may call it.
+    size_t ReadFrameTimes(float* frameMillisecondsBuf, size_t maxFrameTimes);
+
+    // Sensor timestamps are on the boot time clock, which keeps counting through suspend, unlike the monotonic one.
+    static int64_t GetSensorTimeNanoseconds();
 
 private:
 
+    void PollEvents();
+    GravityTrack::Sample MakeGravitySample() const;
+
     android_app* app;
     bool initialized;
     EGLDisplay display;
@@ -61,9 +93,20 @@ private:
     ASensorManager* sensorManager;
     const ASensor* gravitySensor;
     ASensorEventQueue* sensorEventQueue;
+    AChoreographer* choreographer;
+    bool frameCallbackPosted;
+    bool frameDue;
+    int64_t frameTimeNanoseconds;
+    int64_t lastFrameTimeNanoseconds;
+    RingBuffer<float> frameTimeQueue;
     Options options;
     AudioSubSystem audioSubSystem;
     MidiManager midiManager;
     TimeKeeper timeKeeper;
-    PlanarPhysics::Vector2D gravityVector;
+    JobSystem jobSystem;
+
+    // Only the main thread touches the filter.  The logic thread gets at its output through the queue.
+    double filteredGravityArray[3];
+    int64_t lastGravityTimeNanoseconds;
+    RingBuffer<GravityTrack::Sample> gravitySampleQueue;
 };
\ No newline at end of file
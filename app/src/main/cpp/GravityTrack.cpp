@@ -0,0 +1,136 @@
+#include "GravityTrack.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+
+using namespace PlanarPhysics;
+
+GravityTrack::GravityTrack()
+{
+}
+
+/*virtual*/ GravityTrack::~GravityTrack()
+{
+}
+
+void GravityTrack::Clear()
+{
+    this->sampleArray.clear();
+}
+
+bool GravityTrack::AddSample(const Sample& sample)
+{
+    if(this->sampleArray.size() > 0 && sample.timeNanoseconds <= this->sampleArray.back().timeNanoseconds)
+        return false;
+
+    this->sampleArray.push_back(sample);
+
+    // Forget whatever's too old to matter, but always keep two samples around to extrapolate from.
+    auto oldestTimeNanoseconds = sample.timeNanoseconds - int64_t(GRAVITY_TRACK_HISTORY_SECONDS * 1e9);
+    size_t numExpired = 0;
+    while(numExpired + 2 < this->sampleArray.size() && this->sampleArray[numExpired].timeNanoseconds < oldestTimeNanoseconds)
+        numExpired++;
+
+    if(numExpired > 0)
+        this->sampleArray.erase(this->sampleArray.begin(), this->sampleArray.begin() + numExpired);
+
+    return true;
+}
+
+GravityTrack::Lookup GravityTrack::Evaluate(int64_t timeNanoseconds, Vector2D& gravity) const
+{
+    if(this->sampleArray.size() == 0)
+        return Lookup::NONE;
+
+    const Sample& firstSample = this->sampleArray.front();
+    if(timeNanoseconds <= firstSample.timeNanoseconds)
+    {
+        gravity = Vector2D(firstSample.x, firstSample.y);
+        return Lookup::HELD;
+    }
+
+    const Sample& lastSample = this->sampleArray.back();
+    if(timeNanoseconds >= lastSample.timeNanoseconds)
+    {
+        if(this->sampleArray.size() < 2)
+        {
+            gravity = Vector2D(lastSample.x, lastSample.y);
+            return Lookup::HELD;
+        }
+
+        // If the sensor's gone quiet for this long, we've no business guessing where it went.
+        double aheadSeconds = double(timeNanoseconds - lastSample.timeNanoseconds) / 1e9;
+        if(aheadSeconds > GRAVITY_TRACK_MAX_EXTRAPOLATION_SECONDS)
+        {
+            gravity = Vector2D(lastSample.x, lastSample.y);
+            return Lookup::HELD;
+        }
+
+        // A line through two samples is only good for about as far again as they are apart.
+        const Sample& previousSample = this->sampleArray[this->sampleArray.size() - 2];
+        double spanSeconds = double(lastSample.timeNanoseconds - previousSample.timeNanoseconds) / 1e9;
+        double lambda = std::min(aheadSeconds / spanSeconds, 1.0);
+        gravity = Vector2D(lastSample.x + lambda * (lastSample.x - previousSample.x), lastSample.y + lambda * (lastSample.y - previousSample.y));
+        return Lookup::EXTRAPOLATED;
+    }
+
+    // Find the pair of samples on either side of the given time.  There always is one by now.
+    auto iter = std::upper_bound(this->sampleArray.begin(), this->sampleArray.end(), timeNanoseconds, [](int64_t timeNanoseconds, const Sample& sample)
+    {
+        return timeNanoseconds < sample.timeNanoseconds;
+    });
+
+    const Sample& sampleB = *iter;
+    const Sample& sampleA = *(iter - 1);
+    double lambda = double(timeNanoseconds - sampleA.timeNanoseconds) / double(sampleB.timeNanoseconds - sampleA.timeNanoseconds);
+    gravity = Vector2D(sampleA.x + lambda * (sampleB.x - sampleA.x), sampleA.y + lambda * (sampleB.y - sampleA.y));
+    return Lookup::INTERPOLATED;
+}
+
+/*static*/ bool GravityTrack::LoadSampleFile(const char* filePath, std::vector<Sample>& sampleArray)
+{
+    sampleArray.clear();
+
+    FILE* file = ::fopen(filePath, "r");
+    if(!file)
+        return false;
+
+    bool success = true;
+    char lineBuf[256];
+    while(::fgets(lineBuf, sizeof(lineBuf), file))
+    {
+        Sample sample{};
+        if(::sscanf(lineBuf, "%" SCNd64 ",%lf,%lf", &sample.timeNanoseconds, &sample.x, &sample.y) != 3)
+        {
+            // Only the header line gets to not be a sample.
+            if(sampleArray.size() > 0)
+            {
+                success = false;
+                break;
+            }
+
+            continue;
+        }
+
+        sampleArray.push_back(sample);
+    }
+
+    ::fclose(file);
+    return success && sampleArray.size() > 0;
+}
+
+/*static*/ bool GravityTrack::SaveSampleFile(const char* filePath, const std::vector<Sample>& sampleArray)
+{
+    FILE* file = ::fopen(filePath, "w");
+    if(!file)
+        return false;
+
+    // Seventeen significant digits is enough for a double to come back exactly as it went out.
+    ::fprintf(file, "time_ns,x,y\n");
+    for(const Sample& sample : sampleArray)
+        ::fprintf(file, "%" PRId64 ",%.17g,%.17g\n", sample.timeNanoseconds, sample.x, sample.y);
+
+    bool success = (::ferror(file) == 0);
+    success = (::fclose(file) == 0) && success;
+    return success;
+}
\ No newline at end of file
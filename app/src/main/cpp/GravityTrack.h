@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Math/GeometricAlgebra/Vector2D.h"
+
+// How far back the track remembers samples.  We only ever look up times near the newest one.
+#define GRAVITY_TRACK_HISTORY_SECONDS               1.0
+
+// We ask the sensor for a sample this often.  Lookups are made this far behind the time they're for, so that there's
+// usually a sample on either side to interpolate between, rather than having to guess past the newest one.
+#define GRAVITY_TRACK_SENSOR_PERIOD_SECONDS         0.01
+
+// Past the newest sample, we extrapolate along the last two, but never further than this, and never further than
+// the time between them.  Any later than this, and the newest sample is just held as it is.
+#define GRAVITY_TRACK_MAX_EXTRAPOLATION_SECONDS     0.1
+
+// This turns gravity readings, each stamped with when the sensor took it, into something we can
+// look up at any time: the time of a physics step, say, or a little after it to make up for
+// display latency.  Between samples, it interpolates.  Past the newest one, it predicts.  Given
+// the same samples in the same order and the same lookup times, it always gives the same answer,
+// which is what lets a recorded stream of samples be played back exactly, headless or not.
+class GravityTrack
+{
+public:
+    GravityTrack();
+    virtual ~GravityTrack();
+
+    struct Sample
+    {
+        int64_t timeNanoseconds;
+        double x;
+        double y;
+    };
+
+    void Clear();
+
+    // Samples have to come in order.  Anything no newer than the newest sample we have is ignored.
+    bool AddSample(const Sample& sample);
+
+    enum class Lookup
+    {
+        NONE,
+        INTERPOLATED,
+        EXTRAPOLATED,
+        HELD
+    };
+
+    // This says how it came up with the answer, which is NONE only if there are no samples yet.
+    Lookup Evaluate(int64_t timeNanoseconds, PlanarPhysics::Vector2D& gravity) const;
+
+    size_t GetSampleCount() const { return this->sampleArray.size(); }
+    const Sample* GetNewestSample() const { return this->sampleArray.size() > 0 ? &this->sampleArray.back() : nullptr; }
+
+    // Sample files are plain text: one "time_ns,x,y" line per sample, after a header line.
+    static bool LoadSampleFile(const char* filePath, std::vector<Sample>& sampleArray);
+    static bool SaveSampleFile(const char* filePath, const std::vector<Sample>& sampleArray);
+
+private:
+    std::vector<Sample> sampleArray;
+};
\ No newline at end of file
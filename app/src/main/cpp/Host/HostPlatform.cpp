@@ -0,0 +1,119 @@
+#include <android/log.h>
+#include <android/asset_manager.h>
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// This is everything the host build needs to link in place of the Android libraries.
+
+struct AAssetManager
+{
+    std::string rootDir;
+};
+
+struct AAsset
+{
+    std::vector<unsigned char> buffer;
+};
+
+struct AAssetDir
+{
+    std::vector<std::string> fileNameArray;
+    size_t nextFileName;
+};
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int result = ::vfprintf(stdout, fmt, args);
+    va_end(args);
+    ::fflush(stdout);
+    return result;
+}
+
+extern "C" AAssetManager* HostAssetManager_Create(const char* assetRootDir)
+{
+    auto mgr = new AAssetManager();
+    mgr->rootDir = assetRootDir;
+    return mgr;
+}
+
+extern "C" void HostAssetManager_Destroy(AAssetManager* mgr)
+{
+    delete mgr;
+}
+
+extern "C" AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode)
+{
+    std::string filePath = mgr->rootDir + "/" + filename;
+    FILE* fp = ::fopen(filePath.c_str(), "rb");
+    if(!fp)
+        return nullptr;
+
+    auto asset = new AAsset();
+    ::fseek(fp, 0, SEEK_END);
+    asset->buffer.resize(::ftell(fp));
+    ::fseek(fp, 0, SEEK_SET);
+    if(asset->buffer.size() > 0 && 1 != ::fread(asset->buffer.data(), asset->buffer.size(), 1, fp))
+    {
+        delete asset;
+        asset = nullptr;
+    }
+
+    ::fclose(fp);
+    return asset;
+}
+
+extern "C" AAssetDir* AAssetManager_openDir(AAssetManager* mgr, const char* dirName)
+{
+    std::string dirPath = mgr->rootDir + "/" + dirName;
+    DIR* dir = ::opendir(dirPath.c_str());
+    if(!dir)
+        return nullptr;
+
+    auto assetDir = new AAssetDir();
+    assetDir->nextFileName = 0;
+    while(struct dirent* entry = ::readdir(dir))
+    {
+        // Like the real thing, we only list files, not sub-directories.
+        if(entry->d_type == DT_REG)
+            assetDir->fileNameArray.push_back(entry->d_name);
+    }
+
+    ::closedir(dir);
+
+    std::sort(assetDir->fileNameArray.begin(), assetDir->fileNameArray.end());
+    return assetDir;
+}
+
+extern "C" const char* AAssetDir_getNextFileName(AAssetDir* assetDir)
+{
+    if(assetDir->nextFileName >= assetDir->fileNameArray.size())
+        return nullptr;
+
+    return assetDir->fileNameArray[assetDir->nextFileName++].c_str();
+}
+
+extern "C" void AAssetDir_close(AAssetDir* assetDir)
+{
+    delete assetDir;
+}
+
+extern "C" const void* AAsset_getBuffer(AAsset* asset)
+{
+    return asset->buffer.data();
+}
+
+extern "C" off_t AAsset_getLength(AAsset* asset)
+{
+    return (off_t)asset->buffer.size();
+}
+
+extern "C" void AAsset_close(AAsset* asset)
+{
+    delete asset;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+// This stands in for the NDK header when we build for a Linux host.  Only the
+// parts of the asset API that the game actually uses are here, and they're
+// implemented on top of an ordinary directory (e.g., app/src/main/assets).
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+typedef struct AAssetDir AAssetDir;
+
+enum
+{
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3
+};
+
+AAsset* AAssetManager_open(AAssetManager* mgr, const char* filename, int mode);
+AAssetDir* AAssetManager_openDir(AAssetManager* mgr, const char* dirName);
+const char* AAssetDir_getNextFileName(AAssetDir* assetDir);
+void AAssetDir_close(AAssetDir* assetDir);
+const void* AAsset_getBuffer(AAsset* asset);
+off_t AAsset_getLength(AAsset* asset);
+void AAsset_close(AAsset* asset);
+
+// This isn't part of the NDK.  It's how host tools get an asset manager in the first place.
+AAssetManager* HostAssetManager_Create(const char* assetRootDir);
+void HostAssetManager_Destroy(AAssetManager* mgr);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
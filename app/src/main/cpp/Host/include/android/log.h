@@ -0,0 +1,27 @@
+#pragma once
+
+// This stands in for the NDK header when we build for a Linux host.
+// Log output just goes to standard out.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+};
+
+int __android_log_print(int prio, const char* tag, const char* fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
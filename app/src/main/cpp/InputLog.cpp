@@ -0,0 +1,229 @@
+#include "InputLog.h"
+#include "Checksum.h"
+#include "AndroidOut.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+InputLog::InputLog()
+{
+    this->fp = nullptr;
+    this->stepsPerSecond = 0;
+}
+
+/*virtual*/ InputLog::~InputLog()
+{
+    this->EndRecording();
+}
+
+bool InputLog::BeginRecording(const std::string& logFile, uint32_t stepsPerSecond)
+{
+    this->EndRecording();
+    this->Clear();
+
+    this->fp = fopen(logFile.c_str(), "wb");
+    if(!this->fp)
+    {
+        aout << "Failed to open input log " << logFile << " for writing." << std::endl;
+        return false;
+    }
+
+    Header header;
+    ::memset(&header, 0, sizeof(Header));
+    header.magic = INPUT_LOG_MAGIC;
+    header.version = INPUT_LOG_VERSION;
+    header.headerSize = sizeof(Header);
+    header.stepsPerSecond = stepsPerSecond;
+
+    if(1 != fwrite(&header, sizeof(Header), 1, this->fp))
+    {
+        this->EndRecording();
+        return false;
+    }
+
+    this->stepsPerSecond = stepsPerSecond;
+    this->stepArray.reserve(INPUT_LOG_STEPS_PER_CHUNK);
+    return true;
+}
+
+bool InputLog::RecordLevel(const Level& level)
+{
+    if(!this->fp)
+        return false;
+
+    // The steps taken so far belong to the level before this one, so they have to go out first.
+    if(!this->FlushSteps())
+        return false;
+
+    return this->WriteChunk(ChunkType::LEVEL, &level, sizeof(Level));
+}
+
+void InputLog::RecordStep(const Step& step)
+{
+    if(!this->fp)
+        return;
+
+    this->stepArray.push_back(step);
+    if(this->stepArray.size() >= INPUT_LOG_STEPS_PER_CHUNK)
+        this->FlushSteps();
+}
+
+bool InputLog::EndRecording()
+{
+    if(!this->fp)
+        return true;
+
+    bool success = this->FlushSteps();
+
+    if(0 != fclose(this->fp))
+        success = false;
+
+    this->fp = nullptr;
+    this->stepArray.clear();
+    return success;
+}
+
+bool InputLog::FlushSteps()
+{
+    if(this->stepArray.size() == 0)
+        return true;
+
+    bool success = this->WriteChunk(ChunkType::STEPS, this->stepArray.data(), uint32_t(this->stepArray.size() * sizeof(Step)));
+    this->stepArray.clear();
+    return success;
+}
+
+bool InputLog::WriteChunk(ChunkType type, const void* payloadBuf, uint32_t payloadSize)
+{
+    ChunkHeader chunkHeader;
+    chunkHeader.type = uint32_t(type);
+    chunkHeader.payloadSize = payloadSize;
+    chunkHeader.payloadChecksum = CalcCrc32(payloadBuf, payloadSize);
+
+    bool written = (1 == fwrite(&chunkHeader, sizeof(ChunkHeader), 1, this->fp));
+    if(written && payloadSize > 0)
+        written = (1 == fwrite(payloadBuf, payloadSize, 1, this->fp));
+
+    // Push each chunk out of our buffer as soon as it's whole, so that it survives the app being killed.
+    if(written && 0 != fflush(this->fp))
+        written = false;
+
+    if(!written)
+        aout << "Failed to write to the input log." << std::endl;
+
+    return written;
+}
+
+bool InputLog::Load(const std::string& logFile)
+{
+    this->EndRecording();
+    this->Clear();
+
+    bool success = false;
+    int fd = -1;
+    void* mappedBuf = MAP_FAILED;
+    size_t mappedBufSize = 0;
+
+    do
+    {
+        fd = ::open(logFile.c_str(), O_RDONLY);
+        if(fd < 0)
+            break;
+
+        struct stat fileStat;
+        if(0 != ::fstat(fd, &fileStat) || fileStat.st_size < (off_t)sizeof(Header))
+            break;
+
+        mappedBufSize = (size_t)fileStat.st_size;
+        mappedBuf = ::mmap(nullptr, mappedBufSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mappedBuf == MAP_FAILED)
+            break;
+
+        Header header;
+        ::memcpy(&header, mappedBuf, sizeof(Header));
+
+        if(header.magic != INPUT_LOG_MAGIC || header.version != INPUT_LOG_VERSION || header.headerSize != sizeof(Header))
+        {
+            aout << "Input log " << logFile << " has the wrong magic or version." << std::endl;
+            break;
+        }
+
+        this->stepsPerSecond = header.stepsPerSecond;
+
+        const uint8_t* fileBuf = static_cast<const uint8_t*>(mappedBuf);
+        size_t offset = sizeof(Header);
+        while(offset < mappedBufSize)
+        {
+            ChunkHeader chunkHeader;
+            if(mappedBufSize - offset < sizeof(ChunkHeader))
+            {
+                aout << "Input log " << logFile << " ends partway through a chunk header." << std::endl;
+                break;
+            }
+
+            ::memcpy(&chunkHeader, fileBuf + offset, sizeof(ChunkHeader));
+            offset += sizeof(ChunkHeader);
+
+            if(chunkHeader.payloadSize > mappedBufSize - offset)
+            {
+                aout << "Input log " << logFile << " ends partway through a chunk." << std::endl;
+                break;
+            }
+
+            const uint8_t* payloadBuf = fileBuf + offset;
+            offset += chunkHeader.payloadSize;
+
+            if(CalcCrc32(payloadBuf, chunkHeader.payloadSize) != chunkHeader.payloadChecksum)
+            {
+                aout << "Input log " << logFile << " has a chunk that failed its checksum." << std::endl;
+                break;
+            }
+
+            if(chunkHeader.type == uint32_t(ChunkType::LEVEL) && chunkHeader.payloadSize == sizeof(Level))
+            {
+                Segment segment{};
+                ::memcpy(&segment.level, payloadBuf, sizeof(Level));
+                segment.firstStep = this->stepArray.size();
+                segment.stepCount = 0;
+                this->segmentArray.push_back(segment);
+            }
+            else if(chunkHeader.type == uint32_t(ChunkType::STEPS) && chunkHeader.payloadSize % sizeof(Step) == 0)
+            {
+                // Steps only mean anything once we know what level they were taken in.
+                if(this->segmentArray.size() == 0)
+                    continue;
+
+                size_t numSteps = chunkHeader.payloadSize / sizeof(Step);
+                size_t firstStep = this->stepArray.size();
+                this->stepArray.resize(firstStep + numSteps);
+                ::memcpy(&this->stepArray[firstStep], payloadBuf, chunkHeader.payloadSize);
+                this->segmentArray.back().stepCount += numSteps;
+            }
+            else
+            {
+                aout << "Input log " << logFile << " has a chunk we don't understand." << std::endl;
+                break;
+            }
+        }
+
+        success = (this->segmentArray.size() > 0);
+    }
+    while(false);
+
+    if(mappedBuf != MAP_FAILED)
+        ::munmap(mappedBuf, mappedBufSize);
+
+    if(fd >= 0)
+        ::close(fd);
+
+    return success;
+}
+
+void InputLog::Clear()
+{
+    this->stepsPerSecond = 0;
+    this->segmentArray.clear();
+    this->stepArray.clear();
+}
\ No newline at end of file
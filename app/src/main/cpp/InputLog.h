@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#define INPUT_LOG_MAGIC             0x4C494D47      // "GMIL" when read as little-endian bytes.
+#define INPUT_LOG_VERSION           1
+#define INPUT_LOG_STEPS_PER_CHUNK   1024
+
+// This is everything a session needs to be played again exactly: for each level, what the
+// maze was built from, and then the gravity that went into every physics step after that.
+// The physics is deterministic given those, so a session recorded on a device (see the
+// record_input option) can be replayed on the device or headless on a host, as often as we
+// like, under whatever profiler we like.
+//
+// The file is a header followed by chunks, each with its own checksum.  Steps are written a
+// chunk at a time as we go, rather than all at the end, so that if the app is killed partway
+// through, everything up to the last whole chunk can still be read back.
+class InputLog
+{
+public:
+    InputLog();
+    virtual ~InputLog();
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t stepsPerSecond;
+    };
+
+    enum class ChunkType : uint32_t
+    {
+        LEVEL,
+        STEPS
+    };
+
+    // The checksum covers just the payload that follows.
+    struct ChunkHeader
+    {
+        uint32_t type;
+        uint32_t payloadSize;
+        uint32_t payloadChecksum;
+    };
+
+    struct Level
+    {
+        int32_t level;
+        int32_t rows;
+        int32_t cols;
+        uint32_t topology;
+        int32_t seed;
+        int32_t touches;
+        uint32_t queen;
+        uint32_t reserved;
+        double bounce;
+    };
+
+    // Gravity is logged as floats to keep the file small, so the game always rounds it to a float before stepping
+    // with it, whether it's recording or not.  That way, what's logged is exactly what the physics saw.
+    struct Step
+    {
+        float x;
+        float y;
+    };
+
+    // A level and the range of steps taken while it was up.
+    struct Segment
+    {
+        Level level;
+        size_t firstStep;
+        size_t stepCount;
+    };
+
+    bool BeginRecording(const std::string& logFile, uint32_t stepsPerSecond);
+    bool RecordLevel(const Level& level);
+    void RecordStep(const Step& step);
+    bool EndRecording();
+    bool IsRecording() const { return this->fp != nullptr; }
+
+    // This reads back as much of the given file as is intact.
+    bool Load(const std::string& logFile);
+    void Clear();
+
+    uint32_t GetStepsPerSecond() const { return this->stepsPerSecond; }
+    const std::vector<Segment>& GetSegmentArray() const { return this->segmentArray; }
+    const std::vector<Step>& GetStepArray() const { return this->stepArray; }
+
+private:
+    bool WriteChunk(ChunkType type, const void* payloadBuf, uint32_t payloadSize);
+    bool FlushSteps();
+
+    FILE* fp;
+    uint32_t stepsPerSecond;
+    std::vector<Segment> segmentArray;
+    std::vector<Step> stepArray;
+};
\ No newline at end of file
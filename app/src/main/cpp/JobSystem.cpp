@@ -0,0 +1,349 @@
+#include "JobSystem.h"
+#include <unistd.h>
+
+// Workers know who they are so that they can push onto and pop from their own deque.  A worker
+// of one job system can still call into another, so the index only counts in its own system.
+static thread_local JobSystem* currentJobSystem = nullptr;
+static thread_local int currentWorkerIndex = -1;
+
+//------------------------------ JobSystem ------------------------------
+
+JobSystem::JobSystem()
+{
+    this->queuedJobCount = 0;
+    this->nextSubmitIndex = 0;
+    this->keepRunning = false;
+    this->waitingThreadCount = 0;
+    pthread_mutex_init(&this->sleepMutex, nullptr);
+    pthread_cond_init(&this->sleepCondition, nullptr);
+    pthread_cond_init(&this->waitCondition, nullptr);
+}
+
+/*virtual*/ JobSystem::~JobSystem()
+{
+    this->Shutdown();
+
+    pthread_cond_destroy(&this->waitCondition);
+    pthread_cond_destroy(&this->sleepCondition);
+    pthread_mutex_destroy(&this->sleepMutex);
+}
+
+bool JobSystem::Setup(int numWorkers /*= 0*/)
+{
+    if(this->workerArray.size() > 0)
+        return false;
+
+    if(numWorkers <= 0)
+    {
+        // Leave a core for the thread that submits work, since it will help out while it waits.
+        numWorkers = (int)::sysconf(_SC_NPROCESSORS_ONLN) - 1;
+        if(numWorkers < 1)
+            numWorkers = 1;
+    }
+
+    this->keepRunning = true;
+
+    // All the workers need to exist before any of them starts trying to steal from the others.
+    for(int i = 0; i < numWorkers; i++)
+        this->workerArray.push_back(new Worker(this, i));
+
+    for(Worker* worker : this->workerArray)
+    {
+        if(0 != pthread_create(&worker->threadHandle, nullptr, &Worker::ThreadEntryPoint, worker))
+        {
+            worker->threadHandle = 0;
+            this->Shutdown();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool JobSystem::Shutdown()
+{
+    pthread_mutex_lock(&this->sleepMutex);
+    this->keepRunning = false;
+    pthread_cond_broadcast(&this->sleepCondition);
+    pthread_mutex_unlock(&this->sleepMutex);
+
+    for(Worker* worker : this->workerArray)
+    {
+        if(worker->threadHandle)
+        {
+            pthread_join(worker->threadHandle, nullptr);
+            worker->threadHandle = 0;
+        }
+    }
+
+    for(Worker* worker : this->workerArray)
+        delete worker;
+
+    this->workerArray.clear();
+    this->queuedJobCount = 0;
+
+    return true;
+}
+
+void JobSystem::Submit(Job* job)
+{
+    // This releases the reference that stood for the job not yet being submitted.
+    // If no dependencies are outstanding, then the job is ready to go.
+    if(job->unfinishedDependencyCount.fetch_sub(1) == 1)
+        this->EnqueueJob(job);
+}
+
+void JobSystem::EnqueueJob(Job* job)
+{
+    if(this->workerArray.size() == 0)
+    {
+        // Without any workers, we just have to do the work right here.
+        this->RunJob(job);
+        return;
+    }
+
+    int workerIndex = this->GetCurrentWorkerIndex();
+    if(workerIndex >= 0)
+        this->workerArray[workerIndex]->PushJob(job);
+    else
+    {
+        unsigned int i = this->nextSubmitIndex.fetch_add(1) % this->workerArray.size();
+        this->workerArray[i]->PushJob(job);
+    }
+
+    this->queuedJobCount.fetch_add(1);
+
+    // We signal under the lock so that a worker can't miss the wake-up between checking the count and going to sleep.
+    pthread_mutex_lock(&this->sleepMutex);
+    pthread_cond_signal(&this->sleepCondition);
+    if(this->waitingThreadCount.load() > 0)
+        pthread_cond_broadcast(&this->waitCondition);
+    pthread_mutex_unlock(&this->sleepMutex);
+}
+
+int JobSystem::GetCurrentWorkerIndex() const
+{
+    return (currentJobSystem == this) ? currentWorkerIndex : -1;
+}
+
+JobSystem::Job* JobSystem::FindJob(int workerIndex)
+{
+    if(this->queuedJobCount.load() == 0)
+        return nullptr;
+
+    Job* job = nullptr;
+
+    if(workerIndex >= 0)
+        job = this->workerArray[workerIndex]->PopJob();
+
+    if(!job)
+    {
+        int numWorkers = (int)this->workerArray.size();
+        int start = (workerIndex >= 0) ? (workerIndex + 1) : 0;
+        for(int i = 0; i < numWorkers && !job; i++)
+            job = this->workerArray[(start + i) % numWorkers]->StealJob();
+    }
+
+    if(job)
+        this->queuedJobCount.fetch_sub(1);
+
+    return job;
+}
+
+void JobSystem::RunJob(Job* job)
+{
+    job->Execute();
+
+    // Copy the dependents out first, because the moment we mark the job finished, its owner is free to delete it.
+    std::vector<Job*> dependentJobArray;
+    dependentJobArray.swap(job->dependentJobArray);
+    job->finished.store(true);
+
+    // Anyone waiting counts themselves in before they check whether their job is finished, so either they'll see
+    // it finished, or we'll see them waiting.  Taking the lock makes sure they're really asleep before we wake them.
+    if(this->waitingThreadCount.load() > 0)
+    {
+        pthread_mutex_lock(&this->sleepMutex);
+        pthread_cond_broadcast(&this->waitCondition);
+        pthread_mutex_unlock(&this->sleepMutex);
+    }
+
+    for(Job* dependentJob : dependentJobArray)
+        if(dependentJob->unfinishedDependencyCount.fetch_sub(1) == 1)
+            this->EnqueueJob(dependentJob);
+}
+
+void JobSystem::WaitForJob(Job* job)
+{
+    int workerIndex = this->GetCurrentWorkerIndex();
+
+    while(!job->IsFinished())
+    {
+        Job* otherJob = this->FindJob(workerIndex);
+        if(otherJob)
+        {
+            this->RunJob(otherJob);
+            continue;
+        }
+
+        // Whatever our job is waiting on is running somewhere else, so there's no sense keeping a core busy.
+        pthread_mutex_lock(&this->sleepMutex);
+        this->waitingThreadCount.fetch_add(1);
+        while(!job->IsFinished() && this->queuedJobCount.load() == 0)
+            pthread_cond_wait(&this->waitCondition, &this->sleepMutex);
+        this->waitingThreadCount.fetch_sub(1);
+        pthread_mutex_unlock(&this->sleepMutex);
+    }
+}
+
+void JobSystem::ParallelFor(int begin, int end, int grainSize, const std::function<void(int chunkBegin, int chunkEnd)>& function)
+{
+    if(end <= begin)
+        return;
+
+    if(grainSize < 1)
+        grainSize = 1;
+
+    // Small problems aren't worth the overhead of farming out.
+    if(end - begin <= grainSize || this->workerArray.size() == 0)
+    {
+        function(begin, end);
+        return;
+    }
+
+    std::vector<LambdaJob*> chunkJobArray;
+    for(int chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize)
+    {
+        int chunkEnd = (chunkBegin + grainSize < end) ? (chunkBegin + grainSize) : end;
+        chunkJobArray.push_back(new LambdaJob([&function, chunkBegin, chunkEnd]() { function(chunkBegin, chunkEnd); }));
+    }
+
+    for(LambdaJob* chunkJob : chunkJobArray)
+        this->Submit(chunkJob);
+
+    for(LambdaJob* chunkJob : chunkJobArray)
+    {
+        this->WaitForJob(chunkJob);
+        delete chunkJob;
+    }
+}
+
+//------------------------------ JobSystem::Worker ------------------------------
+
+JobSystem::Worker::Worker(JobSystem* jobSystem, int index)
+{
+    this->jobSystem = jobSystem;
+    this->index = index;
+    this->threadHandle = 0;
+    pthread_mutex_init(&this->dequeMutex, nullptr);
+}
+
+/*virtual*/ JobSystem::Worker::~Worker()
+{
+    pthread_mutex_destroy(&this->dequeMutex);
+}
+
+/*static*/ void* JobSystem::Worker::ThreadEntryPoint(void* arg)
+{
+    auto worker = static_cast<Worker*>(arg);
+    currentJobSystem = worker->jobSystem;
+    currentWorkerIndex = worker->index;
+    worker->ThreadFunc();
+    return nullptr;
+}
+
+void JobSystem::Worker::ThreadFunc()
+{
+    JobSystem* jobSystem = this->jobSystem;
+
+    while(jobSystem->keepRunning)
+    {
+        Job* job = jobSystem->FindJob(this->index);
+        if(job)
+        {
+            jobSystem->RunJob(job);
+            continue;
+        }
+
+        pthread_mutex_lock(&jobSystem->sleepMutex);
+        while(jobSystem->queuedJobCount.load() == 0 && jobSystem->keepRunning)
+            pthread_cond_wait(&jobSystem->sleepCondition, &jobSystem->sleepMutex);
+        pthread_mutex_unlock(&jobSystem->sleepMutex);
+    }
+}
+
+void JobSystem::Worker::PushJob(Job* job)
+{
+    pthread_mutex_lock(&this->dequeMutex);
+    this->jobDeque.push_back(job);
+    pthread_mutex_unlock(&this->dequeMutex);
+}
+
+JobSystem::Job* JobSystem::Worker::PopJob()
+{
+    Job* job = nullptr;
+
+    pthread_mutex_lock(&this->dequeMutex);
+    if(this->jobDeque.size() > 0)
+    {
+        job = this->jobDeque.back();
+        this->jobDeque.pop_back();
+    }
+    pthread_mutex_unlock(&this->dequeMutex);
+
+    return job;
+}
+
+JobSystem::Job* JobSystem::Worker::StealJob()
+{
+    Job* job = nullptr;
+
+    pthread_mutex_lock(&this->dequeMutex);
+    if(this->jobDeque.size() > 0)
+    {
+        job = this->jobDeque.front();
+        this->jobDeque.pop_front();
+    }
+    pthread_mutex_unlock(&this->dequeMutex);
+
+    return job;
+}
+
+//------------------------------ JobSystem::Job ------------------------------
+
+JobSystem::Job::Job()
+{
+    this->unfinishedDependencyCount = 1;
+    this->finished = false;
+}
+
+/*virtual*/ JobSystem::Job::~Job()
+{
+}
+
+void JobSystem::Job::DependsOn(Job* job)
+{
+    this->unfinishedDependencyCount.fetch_add(1);
+    job->dependentJobArray.push_back(this);
+}
+
+bool JobSystem::Job::IsFinished() const
+{
+    return this->finished.load();
+}
+
+//------------------------------ JobSystem::LambdaJob ------------------------------
+
+JobSystem::LambdaJob::LambdaJob(const std::function<void()>& function)
+{
+    this->function = function;
+}
+
+/*virtual*/ JobSystem::LambdaJob::~LambdaJob()
+{
+}
+
+/*virtual*/ void JobSystem::LambdaJob::Execute()
+{
+    this->function();
+}
\ No newline at end of file
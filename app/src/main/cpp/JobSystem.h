@@ -0,0 +1,113 @@
+#pragma once
+
+#include <pthread.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <functional>
+
+// This is a small work-stealing thread pool that any part of the game can use
+// to go wide on a problem.  Each worker owns a deque of jobs.  A worker pops
+// from the back of its own deque (which is cache-friendly, since those jobs
+// were most recently pushed) and steals from the front of other deques when
+// it runs dry.  Threads that aren't workers (e.g., the main thread or the game
+// logic thread) can submit jobs and help execute them while they wait.
+//
+// Everyone should share one instance of this, because if every sub-system spun
+// up its own threads, we'd quickly oversubscribe the device's cores.
+class JobSystem
+{
+public:
+    JobSystem();
+    virtual ~JobSystem();
+
+    // Passing zero here means we pick a worker count based on the number of cores.
+    bool Setup(int numWorkers = 0);
+    bool Shutdown();
+
+    class Job
+    {
+        friend class JobSystem;
+
+    public:
+        Job();
+        virtual ~Job();
+
+        virtual void Execute() = 0;
+
+        // Make this job wait for the given job to finish before it can run.
+        // This must be called before either job is submitted to the system.
+        void DependsOn(Job* job);
+
+        bool IsFinished() const;
+
+    private:
+        // This starts at one to account for the job not yet being submitted.
+        std::atomic<int> unfinishedDependencyCount;
+        std::atomic<bool> finished;
+        std::vector<Job*> dependentJobArray;
+    };
+
+    class LambdaJob : public Job
+    {
+    public:
+        LambdaJob(const std::function<void()>& function);
+        virtual ~LambdaJob();
+
+        virtual void Execute() override;
+
+    private:
+        std::function<void()> function;
+    };
+
+    // The caller retains ownership of the given job.  It must not be deleted until it has finished.
+    void Submit(Job* job);
+
+    // Rather than just block, the calling thread will help execute jobs until the given job finishes.  Once there's
+    // nothing left for it to help with, it sleeps until a job finishes or more work comes in.
+    void WaitForJob(Job* job);
+
+    // Divide the range [begin, end) into chunks of (at most) the given grain size and process them in parallel.
+    // The calling thread participates in the work and this does not return until every chunk is done.
+    void ParallelFor(int begin, int end, int grainSize, const std::function<void(int chunkBegin, int chunkEnd)>& function);
+
+    int GetWorkerCount() const { return (int)this->workerArray.size(); }
+
+private:
+
+    class Worker
+    {
+    public:
+        Worker(JobSystem* jobSystem, int index);
+        virtual ~Worker();
+
+        static void* ThreadEntryPoint(void* arg);
+        void ThreadFunc();
+
+        void PushJob(Job* job);
+        Job* PopJob();
+        Job* StealJob();
+
+        JobSystem* jobSystem;
+        int index;
+        pthread_t threadHandle;
+        pthread_mutex_t dequeMutex;
+        std::deque<Job*> jobDeque;
+    };
+
+    void EnqueueJob(Job* job);
+    Job* FindJob(int workerIndex);
+    void RunJob(Job* job);
+    int GetCurrentWorkerIndex() const;
+
+    std::vector<Worker*> workerArray;
+    std::atomic<int> queuedJobCount;
+    std::atomic<unsigned int> nextSubmitIndex;
+    std::atomic<bool> keepRunning;
+    pthread_mutex_t sleepMutex;
+    pthread_cond_t sleepCondition;
+
+    // Threads in WaitForJob sleep on this instead, so that finishing a job only wakes them and not every idle worker.
+    std::atomic<int> waitingThreadCount;
+    pthread_cond_t waitCondition;
+};
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "LevelStats.h"
+#include "AsyncFileWriter.h"
+#include "Checksum.h"
+#include "AndroidOut.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+LevelStats::LevelStats()
+{
+    this->fileWriter = nullptr;
+}
+
+/*virtual*/ LevelStats::~LevelStats()
+{
+}
+
+bool LevelStats::Open(const std::string& logFile, AsyncFileWriter* fileWriter)
+{
+    this->logFile = logFile;
+    this->fileWriter = fileWriter;
+
+    // We only need the header and the size to know whether the log is fine as it is.
+    bool valid = false;
+    bool torn = false;
+    size_t numRecords = 0;
+    int fd = ::open(logFile.c_str(), O_RDONLY);
+    if(fd >= 0)
+    {
+        Header header;
+        struct stat fileStat;
+        if(sizeof(Header) == ::pread(fd, &header, sizeof(Header), 0) && 0 == ::fstat(fd, &fileStat))
+        {
+            valid = (header.magic == LEVEL_STATS_MAGIC && header.version == LEVEL_STATS_VERSION &&
+                     header.headerSize == sizeof(Header) && header.recordSize == sizeof(Record));
+            numRecords = (size_t(fileStat.st_size) - sizeof(Header)) / sizeof(Record);
+
+            // A record cut short by the app dying mid-append would throw every record after it out of line.
+            torn = ((size_t(fileStat.st_size) - sizeof(Header)) % sizeof(Record) != 0);
+        }
+
+        ::close(fd);
+    }
+
+    if(!valid)
+    {
+        std::vector<Record> recordArray;
+        if(!SaveFile(logFile, recordArray))
+        {
+            aout << "Failed to create level stats log " << logFile << "." << std::endl;
+            return false;
+        }
+    }
+    else if(torn || numRecords > LEVEL_STATS_COMPACT_RECORDS)
+    {
+        if(!Compact(logFile, LEVEL_STATS_KEEP_RECORDS))
+        {
+            aout << "Failed to compact level stats log " << logFile << "." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LevelStats::Add(const Record& record)
+{
+    if(this->logFile.length() == 0)
+        return;
+
+    Record finishedRecord = record;
+    finishedRecord.checksum = CalcRecordChecksum(finishedRecord);
+
+    if(this->fileWriter)
+        this->fileWriter->Append(this->logFile, &finishedRecord, sizeof(Record));
+    else if(!AsyncFileWriter::AppendFile(this->logFile, &finishedRecord, sizeof(Record)))
+        aout << "Failed to append to level stats log " << this->logFile << "." << std::endl;
+}
+
+/*static*/ uint32_t LevelStats::CalcRecordChecksum(const Record& record)
+{
+    return CalcCrc32(&record, offsetof(Record, checksum));
+}
+
+/*static*/ bool LevelStats::LoadFile(const std::string& logFile, std::vector<Record>& recordArray, size_t* numBadRecords /*= nullptr*/)
+{
+    bool success = false;
+    int fd = -1;
+    void* mappedBuf = MAP_FAILED;
+    size_t mappedBufSize = 0;
+
+    recordArray.clear();
+    if(numBadRecords)
+        *numBadRecords = 0;
+
+    do
+    {
+        fd = ::open(logFile.c_str(), O_RDONLY);
+        if(fd < 0)
+            break;
+
+        struct stat fileStat;
+        if(0 != ::fstat(fd, &fileStat) || fileStat.st_size < (off_t)sizeof(Header))
+            break;
+
+        mappedBufSize = (size_t)fileStat.st_size;
+        mappedBuf = ::mmap(nullptr, mappedBufSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mappedBuf == MAP_FAILED)
+            break;
+
+        Header header;
+        ::memcpy(&header, mappedBuf, sizeof(Header));
+
+        if(header.magic != LEVEL_STATS_MAGIC || header.version != LEVEL_STATS_VERSION || header.headerSize != sizeof(Header) || header.recordSize != sizeof(Record))
+        {
+            aout << "Level stats log " << logFile << " has the wrong magic, version or record size." << std::endl;
+            break;
+        }
+
+        // Every record should be whole and check out, but if one doesn't, we don't let it cost us the rest.
+        const uint8_t* recordBuf = static_cast<const uint8_t*>(mappedBuf) + sizeof(Header);
+        size_t numRecords = (mappedBufSize - sizeof(Header)) / sizeof(Record);
+        recordArray.reserve(numRecords);
+        for(size_t i = 0; i < numRecords; i++)
+        {
+            Record record;
+            ::memcpy(&record, recordBuf + i * sizeof(Record), sizeof(Record));
+            if(record.checksum == CalcRecordChecksum(record))
+                recordArray.push_back(record);
+            else if(numBadRecords)
+                (*numBadRecords)++;
+        }
+
+        if(numBadRecords && (mappedBufSize - sizeof(Header)) % sizeof(Record) != 0)
+            (*numBadRecords)++;
+
+        success = true;
+    }
+    while(false);
+
+    if(mappedBuf != MAP_FAILED)
+        ::munmap(mappedBuf, mappedBufSize);
+
+    if(fd >= 0)
+        ::close(fd);
+
+    return success;
+}
+
+/*static*/ bool LevelStats::SaveFile(const std::string& logFile, const std::vector<Record>& recordArray)
+{
+    Header header;
+    ::memset(&header, 0, sizeof(Header));
+    header.magic = LEVEL_STATS_MAGIC;
+    header.version = LEVEL_STATS_VERSION;
+    header.headerSize = sizeof(Header);
+    header.recordSize = sizeof(Record);
+
+    std::string fileData;
+    fileData.resize(sizeof(Header) + recordArray.size() * sizeof(Record));
+    ::memcpy(&fileData[0], &header, sizeof(Header));
+    if(recordArray.size() > 0)
+        ::memcpy(&fileData[sizeof(Header)], recordArray.data(), recordArray.size() * sizeof(Record));
+
+    return AsyncFileWriter::WriteFileAtomically(logFile, fileData.data(), fileData.size());
+}
+
+/*static*/ bool LevelStats::Compact(const std::string& logFile, size_t keepRecords)
+{
+    std::vector<Record> recordArray;
+    size_t numBadRecords = 0;
+    if(!LoadFile(logFile, recordArray, &numBadRecords))
+        return false;
+
+    size_t numDroppedRecords = 0;
+    if(recordArray.size() > keepRecords)
+    {
+        numDroppedRecords = recordArray.size() - keepRecords;
+        recordArray.erase(recordArray.begin(), recordArray.begin() + numDroppedRecords);
+    }
+
+    if(!SaveFile(logFile, recordArray))
+        return false;
+
+    aout << "Compacted level stats log " << logFile << ": kept " << recordArray.size() << " records, dropped " << numDroppedRecords << " old and " << numBadRecords << " bad." << std::endl;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#define LEVEL_STATS_MAGIC               0x534C4D47      // "GMLS" when read as little-endian bytes.
+#define LEVEL_STATS_VERSION             1
+
+// Once the log has more records than this, it's compacted down to the newest so many of them.
+#define LEVEL_STATS_COMPACT_RECORDS     8192
+#define LEVEL_STATS_KEEP_RECORDS        4096
+
+class AsyncFileWriter;
+
+// This is a log of how every level went: how long it took, what it took, and how smoothly the
+// game ran while it was being played.  It's an append-only file of fixed-size records behind a
+// small header, so adding to it never means rewriting it.  Each record has its own checksum, so
+// if the app dies partway through an append, we just lose that record and not the log.  Every
+// so often, when the log is opened, it gets compacted: bad records are dropped, along with the
+// oldest ones if it's grown too long.
+//
+// LevelStatsTool reads these on a host and summarizes them.
+class LevelStats
+{
+public:
+    LevelStats();
+    virtual ~LevelStats();
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t recordSize;
+    };
+
+    enum Flag : uint32_t
+    {
+        REPLAYED = 0x00000001       // The level was played back from an input log, not by the player.
+    };
+
+    struct Record
+    {
+        int64_t finishTime;             // This is when the level was solved, in seconds since the epoch.
+        int32_t level;
+        int32_t seed;
+        int32_t rows;
+        int32_t cols;
+        uint32_t topology;
+        uint32_t flags;
+        float solveSeconds;
+        uint32_t physicsSteps;
+        uint32_t collisions;
+        uint32_t evilBlockResets;
+        uint32_t frameCount;
+        float frameMeanMilliseconds;
+        float frameP99Milliseconds;
+        float frameMaxMilliseconds;
+        uint32_t reserved;
+        uint32_t checksum;              // This covers everything above it.
+    };
+
+    // This creates the log if need be, and compacts it if it's due.
+    bool Open(const std::string& logFile, AsyncFileWriter* fileWriter);
+
+    // Each record goes to the file writer as soon as it's added, because a backgrounded app can be killed at any time.
+    // The writer holds appends back for a moment anyway, so records added close together still go out in one write.
+    void Add(const Record& record);
+
+    // These work with any file path so that we can use them from host tools too.
+    static bool LoadFile(const std::string& logFile, std::vector<Record>& recordArray, size_t* numBadRecords = nullptr);
+    static bool SaveFile(const std::string& logFile, const std::vector<Record>& recordArray);
+    static bool Compact(const std::string& logFile, size_t keepRecords);
+
+    static uint32_t CalcRecordChecksum(const Record& record);
+
+private:
+    std::string logFile;
+    AsyncFileWriter* fileWriter;
+};
\ No newline at end of file
@@ -7,11 +7,11 @@
 #include "Engine.h"
 #include "Math/Utilities/BoundingBox.h"
 #include "Math/GeometricAlgebra/PScalar2D.h"
-#include "Math/Utilities/Random.h"
 #include <math.h>
-#include <stdlib.h>
+#include <string.h>
 #include <list>
 #include <set>
+#include <algorithm>
 
 using namespace PlanarPhysics;
 
@@ -19,8 +19,11 @@ using namespace PlanarPhysics;
 
 Maze::Maze()
 {
+    this->topology = Topology::RECTANGULAR;
     this->rows = 0;
     this->cols = 0;
+    this->wormVelocity = Vector2D(0.0, 0.0);
+    this->wormSeed = 0;
 }
 
 /*virtual*/ Maze::~Maze()
@@ -28,74 +31,61 @@ Maze::Maze()
     this->Clear();
 }
 
-bool Maze::Generate(int rows, int cols, int seedModifier)
+/*static*/ const char* Maze::GetTopologyName(Topology topology)
 {
-    this->Clear();
-
-    this->rows = rows;
-    this->cols = cols;
-
-    ::srand(rows * cols * cols + seedModifier);
-
-    Node*** matrix = new Node**[rows];
-    for(int i = 0; i < rows; i++)
+    switch(topology)
     {
-        matrix[i] = new Node*[cols];
-        for(int j = 0; j < cols; j++)
-        {
-            Node* node = new Node();
-            matrix[i][j] = node;
-            this->nodeArray.push_back(node);
-            sprintf(node->debugName, "%d, %d", i, j);
-        }
+        case Topology::RECTANGULAR:
+            return "rectangular";
+        case Topology::HEXAGONAL:
+            return "hexagonal";
+        case Topology::POLAR:
+            return "polar";
     }
 
-    for(int i = 0; i < rows; i++)
-    {
-        for(int j = 0; j < cols; j++)
-        {
-            if(i > 0)
-                matrix[i][j]->adjacentNodeArray.push_back(matrix[i - 1][j]);
-            if(i < rows - 1)
-                matrix[i][j]->adjacentNodeArray.push_back(matrix[i + 1][j]);
-            if(j > 0)
-                matrix[i][j]->adjacentNodeArray.push_back(matrix[i][j - 1]);
-            if(j < cols - 1)
-                matrix[i][j]->adjacentNodeArray.push_back(matrix[i][j + 1]);
-        }
-    }
+    return "?";
+}
 
-    for(int i = 0; i < rows; i++)
+/*static*/ bool Maze::FindTopologyByName(const char* name, Topology& topology)
+{
+    for(Topology candidate : {Topology::RECTANGULAR, Topology::HEXAGONAL, Topology::POLAR})
     {
-        for(int j = 0; j < cols; j++)
+        if(::strcmp(name, GetTopologyName(candidate)) == 0)
         {
-            Node* node = matrix[i][j];
-            node->center.x = double(j) * MAZE_CELL_SIZE + MAZE_CELL_SIZE / 2.0;
-            node->center.y = double(i) * MAZE_CELL_SIZE + MAZE_CELL_SIZE / 2.0;
+            topology = candidate;
+            return true;
         }
     }
 
-    // Free the memory we used to build the graph.
-    for(int i = 0; i < rows; i++)
-        delete[] matrix[i];
-    delete[] matrix;
+    return false;
+}
+
+/*static*/ void Maze::CalcLevelSize(int level, double aspectRatio, int& rows, int& cols)
+{
+    rows = level + 5;
+    cols = (int)::round(double(rows) * aspectRatio);
+}
+
+bool Maze::Generate(int rows, int cols, RandomGenerator& random, Topology topology /*= Topology::RECTANGULAR*/)
+{
+    this->BuildGrid(topology, rows, cols);
 
     // Go generate the maze graph.
     std::list<Node*> nodeQueue;
-    Node* node = this->RandomNode(this->nodeArray);
+    Node* node = this->RandomNode(this->nodeArray, random);
     nodeQueue.push_back(node);
     node->queued = true;
     while(nodeQueue.size() > 0)
     {
         // Pull a random node off the queue.  The queue is the periphery of a random BFS.
-        node = this->RandomNode(nodeQueue, true);
+        node = this->RandomNode(nodeQueue, true, random);
 
         // Integrate the node with the rest of the growing maze.
         Node* adjacentNode = nullptr;
         int lastRandom = -1;
         for(int i = 0; i < node->adjacentNodeArray.size(); i++)
         {
-            adjacentNode = this->RandomNode(node->adjacentNodeArray, &lastRandom);
+            adjacentNode = this->RandomNode(node->adjacentNodeArray, random, &lastRandom);
             if(adjacentNode->integrated)
             {
                 node->connectedNodeArray.push_back(adjacentNode);
@@ -116,10 +106,284 @@ bool Maze::Generate(int rows, int cols, int seedModifier)
         }
     }
 
+    this->PlaceObjects(random);
+
     return true;
 }
 
-Maze::Node* Maze::RandomNode(std::vector<Node*>& nodeArray, int* lastRandom /*= nullptr*/)
+void Maze::BuildGrid(Topology topology, int rows, int cols)
+{
+    this->Clear();
+
+    this->topology = topology;
+    this->rows = rows;
+    this->cols = cols;
+
+    switch(topology)
+    {
+        case Topology::RECTANGULAR:
+            this->BuildRectangularGrid();
+            break;
+        case Topology::HEXAGONAL:
+            this->BuildHexagonalGrid();
+            break;
+        case Topology::POLAR:
+            this->BuildPolarGrid();
+            break;
+    }
+
+    this->IndexNodes();
+}
+
+Maze::Node* Maze::AddNode(const PlanarPhysics::Vector2D& center)
+{
+    Node* node = new Node();
+    node->index = (int)this->nodeArray.size();
+    node->center = center;
+    this->nodeArray.push_back(node);
+    return node;
+}
+
+// The wall between two cells is perpendicular to the line joining their centers and half-way between them.
+// This also works for the boundary, where we just make up a center for the cell that would be on the other side.
+/*static*/ PlanarPhysics::LineSegment Maze::MakeWallBetween(const PlanarPhysics::Vector2D& centerA, const PlanarPhysics::Vector2D& centerB, double wallLength)
+{
+    Vector2D wallCenter = (centerA + centerB) / 2.0;
+    Vector2D wallNormal = (centerB - centerA).Normalized();
+    Vector2D wallTangent = wallNormal * PScalar2D(1.0);
+
+    return LineSegment(wallCenter + wallTangent * wallLength / 2.0, wallCenter - wallTangent * wallLength / 2.0);
+}
+
+void Maze::BuildRectangularGrid()
+{
+    int rows = this->rows;
+    int cols = this->cols;
+
+    std::vector<Node*> matrix;
+    matrix.reserve(rows * cols);
+    for(int i = 0; i < rows; i++)
+    {
+        for(int j = 0; j < cols; j++)
+        {
+            Node* node = this->AddNode(Vector2D(double(j) * MAZE_CELL_SIZE + MAZE_CELL_SIZE / 2.0, double(i) * MAZE_CELL_SIZE + MAZE_CELL_SIZE / 2.0));
+            sprintf(node->debugName, "%d, %d", i, j);
+            matrix.push_back(node);
+        }
+    }
+
+    // Note that the order of adjacency here matters, because it decides which way the maze
+    // generation goes for a given seed, and it's also the order of the bits in the cached wall masks.
+    static const int offsetArray[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    for(int i = 0; i < rows; i++)
+    {
+        for(int j = 0; j < cols; j++)
+        {
+            Node* node = matrix[i * cols + j];
+
+            for(int k = 0; k < 4; k++)
+            {
+                int adjacentI = i + offsetArray[k][0];
+                int adjacentJ = j + offsetArray[k][1];
+                Vector2D adjacentCenter = node->center + Vector2D(double(offsetArray[k][1]), double(offsetArray[k][0])) * MAZE_CELL_SIZE;
+                LineSegment wallSegment = MakeWallBetween(node->center, adjacentCenter, MAZE_CELL_SIZE);
+
+                if(0 <= adjacentI && adjacentI < rows && 0 <= adjacentJ && adjacentJ < cols)
+                    node->AddAdjacency(matrix[adjacentI * cols + adjacentJ], wallSegment);
+                else
+                    this->boundaryWallArray.push_back(wallSegment);
+            }
+        }
+    }
+}
+
+// The cells here are pointy-topped hexagons with every other row shifted right by half a cell.
+// The centers of adjacent cells are always one cell size apart, which is what the physics is calibrated for.
+void Maze::BuildHexagonalGrid()
+{
+    int rows = this->rows;
+    int cols = this->cols;
+
+    double rowHeight = MAZE_CELL_SIZE * ::sqrt(3.0) / 2.0;
+    double edgeLength = MAZE_CELL_SIZE / ::sqrt(3.0);
+
+    std::vector<Node*> matrix;
+    matrix.reserve(rows * cols);
+    for(int i = 0; i < rows; i++)
+    {
+        for(int j = 0; j < cols; j++)
+        {
+            Vector2D center;
+            center.x = MAZE_CELL_SIZE / 2.0 + double(j) * MAZE_CELL_SIZE + ((i & 1) ? MAZE_CELL_SIZE / 2.0 : 0.0);
+            center.y = edgeLength + double(i) * rowHeight;
+            Node* node = this->AddNode(center);
+            sprintf(node->debugName, "%d, %d", i, j);
+            matrix.push_back(node);
+        }
+    }
+
+    // Going counter-clockwise from the east, these are the row and column offsets to the
+    // six neighbors of a cell, which depend on whether the cell is in an even or odd row.
+    static const int offsetArray[2][6][2] = {
+        {{0, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}},
+        {{0, 1}, {1, 1}, {1, 0}, {0, -1}, {-1, 0}, {-1, 1}}
+    };
+
+    for(int i = 0; i < rows; i++)
+    {
+        for(int j = 0; j < cols; j++)
+        {
+            Node* node = matrix[i * cols + j];
+
+            for(int k = 0; k < 6; k++)
+            {
+                int adjacentI = i + offsetArray[i & 1][k][0];
+                int adjacentJ = j + offsetArray[i & 1][k][1];
+                double angle = double(k) * PLNR_PHY_PI / 3.0;
+                Vector2D adjacentCenter = node->center + Vector2D(::cos(angle), ::sin(angle)) * MAZE_CELL_SIZE;
+                LineSegment wallSegment = MakeWallBetween(node->center, adjacentCenter, edgeLength);
+
+                if(0 <= adjacentI && adjacentI < rows && 0 <= adjacentJ && adjacentJ < cols)
+                    node->AddAdjacency(matrix[adjacentI * cols + adjacentJ], wallSegment);
+                else
+                    this->boundaryWallArray.push_back(wallSegment);
+            }
+        }
+    }
+}
+
+// A polar maze is a disc cut into concentric rings, each ring being one cell thick.  A ring
+// has as many cells as the ring inside it, unless the cells would get too wide, in which case
+// it has twice as many.  That way, a cell always has one inward neighbor and one or two outward.
+// The center of the disc is one round cell, which is where the ball starts.
+void Maze::BuildPolarGrid()
+{
+    int numRings = (int)::round(::sqrt(double(this->rows * this->cols) / PLNR_PHY_PI));
+    if(numRings < 2)
+        numRings = 2;
+
+    Vector2D mazeCenter(double(numRings) * MAZE_CELL_SIZE, double(numRings) * MAZE_CELL_SIZE);
+
+    auto polarPoint = [&mazeCenter](double radius, double angle) -> Vector2D
+    {
+        return mazeCenter + Vector2D(radius * ::cos(angle), radius * ::sin(angle));
+    };
+
+    // We approximate the arcs between rings with chords.  The cells are small enough that you can't really tell.
+    auto ringChord = [&polarPoint](int ring, int numCells, int j) -> LineSegment
+    {
+        double radius = double(ring) * MAZE_CELL_SIZE;
+        double angleA = double(j) * 2.0 * PLNR_PHY_PI / double(numCells);
+        double angleB = double(j + 1) * 2.0 * PLNR_PHY_PI / double(numCells);
+        return LineSegment(polarPoint(radius, angleA), polarPoint(radius, angleB));
+    };
+
+    std::vector<std::vector<Node*>> ringArray(numRings);
+
+    Node* centerNode = this->AddNode(mazeCenter);
+    sprintf(centerNode->debugName, "center");
+    ringArray[0].push_back(centerNode);
+
+    int numCells = 6;
+    for(int k = 1; k < numRings; k++)
+    {
+        if(k > 1)
+        {
+            double cellWidth = 2.0 * double(k) * MAZE_CELL_SIZE * ::sin(PLNR_PHY_PI / double(2 * numCells));
+            if(cellWidth >= MAZE_CELL_SIZE)
+                numCells *= 2;
+        }
+
+        for(int j = 0; j < numCells; j++)
+        {
+            double angle = (double(j) + 0.5) * 2.0 * PLNR_PHY_PI / double(numCells);
+            Node* node = this->AddNode(polarPoint((double(k) + 0.5) * MAZE_CELL_SIZE, angle));
+            sprintf(node->debugName, "%d, %d", k, j);
+            ringArray[k].push_back(node);
+        }
+    }
+
+    for(int j = 0; j < (signed)ringArray[1].size(); j++)
+        centerNode->AddAdjacency(ringArray[1][j], ringChord(1, (int)ringArray[1].size(), j));
+
+    for(int k = 1; k < numRings; k++)
+    {
+        std::vector<Node*>& ring = ringArray[k];
+        int n = (int)ring.size();
+
+        for(int j = 0; j < n; j++)
+        {
+            Node* node = ring[j];
+
+            // The clockwise and counter-clockwise neighbors are separated by radial walls.
+            double angleCW = double(j) * 2.0 * PLNR_PHY_PI / double(n);
+            double angleCCW = double(j + 1) * 2.0 * PLNR_PHY_PI / double(n);
+            node->AddAdjacency(ring[(j + n - 1) % n], LineSegment(polarPoint(double(k) * MAZE_CELL_SIZE, angleCW), polarPoint(double(k + 1) * MAZE_CELL_SIZE, angleCW)));
+            node->AddAdjacency(ring[(j + 1) % n], LineSegment(polarPoint(double(k) * MAZE_CELL_SIZE, angleCCW), polarPoint(double(k + 1) * MAZE_CELL_SIZE, angleCCW)));
+
+            std::vector<Node*>& innerRing = ringArray[k - 1];
+            int innerIndex = j / (n / (int)innerRing.size());
+            node->AddAdjacency(innerRing[innerIndex], ringChord(k, n, j));
+
+            if(k == numRings - 1)
+                this->boundaryWallArray.push_back(ringChord(k + 1, n, j));
+            else
+            {
+                std::vector<Node*>& outerRing = ringArray[k + 1];
+                int m = (int)outerRing.size();
+                int ratio = m / n;
+                for(int l = 0; l < ratio; l++)
+                    node->AddAdjacency(outerRing[j * ratio + l], ringChord(k + 1, m, j * ratio + l));
+            }
+        }
+    }
+}
+
+/*static*/ uint64_t Maze::MakeBucketKey(const PlanarPhysics::Vector2D& point)
+{
+    auto i = (int32_t)::floor(point.x / MAZE_CELL_SIZE);
+    auto j = (int32_t)::floor(point.y / MAZE_CELL_SIZE);
+    return (uint64_t(uint32_t(i)) << 32) | uint64_t(uint32_t(j));
+}
+
+void Maze::IndexNodes()
+{
+    this->nodeBucketMap.clear();
+    for(const Node* node : this->nodeArray)
+        this->nodeBucketMap[MakeBucketKey(node->center)].push_back(node->index);
+}
+
+void Maze::CountObjects(int& numGoodMazeBlocks, int& numEvilMazeBlocks, int& numMazeWorms) const
+{
+    numGoodMazeBlocks = this->cols - 1;
+    numEvilMazeBlocks = numGoodMazeBlocks / 4;
+    numMazeWorms = (numGoodMazeBlocks > 10) ? 1 : 0;
+}
+
+void Maze::PlaceObjects(RandomGenerator& random)
+{
+    std::vector<int> availableSlots;
+    for(int i = 1; i < this->nodeArray.size(); i++)
+        availableSlots.push_back(i);
+
+    random.ShuffleArray<int>(availableSlots);
+
+    int numGoodMazeBlocks = 0, numEvilMazeBlocks = 0, numMazeWorms = 0;
+    this->CountObjects(numGoodMazeBlocks, numEvilMazeBlocks, numMazeWorms);
+
+    int numSlots = std::min(numGoodMazeBlocks + numEvilMazeBlocks + numMazeWorms + 1, (int)availableSlots.size());
+    this->objectSlotArray.assign(availableSlots.begin(), availableSlots.begin() + numSlots);
+
+    this->goodBlockSideCountArray.clear();
+    for(int i = 0; i < numGoodMazeBlocks; i++)
+        this->goodBlockSideCountArray.push_back((uint8_t)random.Integer(3, 5));
+
+    this->wormVelocity = random.Vector(200.0, 250.0);
+    this->wormSeed = random.Next();
+}
+
+Maze::Node* Maze::RandomNode(std::vector<Node*>& nodeArray, RandomGenerator& random, int* lastRandom /*= nullptr*/)
 {
     if(lastRandom && *lastRandom >= 0)
     {
@@ -127,7 +391,7 @@ Maze::Node* Maze::RandomNode(std::vector<Node*>& nodeArray, int* lastRandom /*=
         return nodeArray[*lastRandom];
     }
 
-    int i = Random::Integer(0, nodeArray.size() - 1);
+    int i = random.Integer(0, nodeArray.size() - 1);
     Node* node = nodeArray[i];
 
     if(lastRandom)
@@ -136,9 +400,9 @@ Maze::Node* Maze::RandomNode(std::vector<Node*>& nodeArray, int* lastRandom /*=
     return node;
 }
 
-Maze::Node* Maze::RandomNode(std::list<Node*>& nodeList, bool remove)
+Maze::Node* Maze::RandomNode(std::list<Node*>& nodeList, bool remove, RandomGenerator& random)
 {
-    int i = Random::Integer(0, nodeList.size() - 1);
+    int i = random.Integer(0, nodeList.size() - 1);
     std::list<Node*>::iterator iter = nodeList.begin();
     while(i > 0)
     {
@@ -154,17 +418,126 @@ Maze::Node* Maze::RandomNode(std::list<Node*>& nodeList, bool remove)
     return node;
 }
 
+const Maze::Node* Maze::FindNearestNode(const PlanarPhysics::Vector2D& point) const
+{
+    const Node* nearestNode = nullptr;
+    double smallestDistanceSquared = 0.0;
+
+    auto considerNode = [&nearestNode, &smallestDistanceSquared, &point](const Node* node)
+    {
+        Vector2D delta = node->center - point;
+        double distanceSquared = delta.x * delta.x + delta.y * delta.y;
+        if(!nearestNode || distanceSquared < smallestDistanceSquared)
+        {
+            nearestNode = node;
+            smallestDistanceSquared = distanceSquared;
+        }
+    };
+
+    // Cell centers are never more than a cell size apart, so if the point is inside the maze,
+    // the nearest center is in the point's bucket or one of the buckets around it.
+    for(int i = -1; i <= 1; i++)
+    {
+        for(int j = -1; j <= 1; j++)
+        {
+            auto iter = this->nodeBucketMap.find(MakeBucketKey(point + Vector2D(double(i), double(j)) * MAZE_CELL_SIZE));
+            if(iter != this->nodeBucketMap.end())
+                for(int k : iter->second)
+                    considerNode(this->nodeArray[k]);
+        }
+    }
+
+    // Points outside the maze (or way off in a corner of it) fall back on checking every cell.
+    if(!nearestNode)
+        for(const Node* node : this->nodeArray)
+            considerNode(node);
+
+    return nearestNode;
+}
+
+bool Maze::FindPathToNearestGoal(const PlanarPhysics::Vector2D& startPoint, const std::vector<PlanarPhysics::Vector2D>& goalPointArray, std::vector<PlanarPhysics::Vector2D>& pathArray) const
+{
+    pathArray.clear();
+
+    const Node* startNode = this->FindNearestNode(startPoint);
+    if(!startNode)
+        return false;
+
+    std::vector<bool> goalArray(this->nodeArray.size(), false);
+    for(const Vector2D& goalPoint : goalPointArray)
+    {
+        const Node* goalNode = this->FindNearestNode(goalPoint);
+        if(goalNode)
+            goalArray[goalNode->index] = true;
+    }
+
+    // The parent of the start node is itself, which also serves to mark it as visited.
+    std::vector<int> parentArray(this->nodeArray.size(), -1);
+    parentArray[startNode->index] = startNode->index;
+
+    std::list<const Node*> nodeQueue;
+    nodeQueue.push_back(startNode);
+    const Node* foundNode = nullptr;
+    while(nodeQueue.size() > 0)
+    {
+        const Node* node = nodeQueue.front();
+        nodeQueue.pop_front();
+
+        if(goalArray[node->index])
+        {
+            foundNode = node;
+            break;
+        }
+
+        for(const Node* connectedNode : node->connectedNodeArray)
+        {
+            if(parentArray[connectedNode->index] < 0)
+            {
+                parentArray[connectedNode->index] = node->index;
+                nodeQueue.push_back(connectedNode);
+            }
+        }
+    }
+
+    if(!foundNode)
+        return false;
+
+    for(int i = foundNode->index; ; i = parentArray[i])
+    {
+        pathArray.push_back(this->nodeArray[i]->center);
+        if(parentArray[i] == i)
+            break;
+    }
+
+    std::reverse(pathArray.begin(), pathArray.end());
+    return true;
+}
+
 void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool queen, double bounceFactor) const
 {
     engine->Clear();
 
+    // Every shared wall is stored twice, once by each node, so we only take it from the node with the smaller index.
+    std::vector<LineSegment> wallSegmentArray(this->boundaryWallArray);
+    for(const Node* node : this->nodeArray)
+    {
+        for(int k = 0; k < (signed)node->adjacentNodeArray.size(); k++)
+        {
+            const Node* adjacentNode = node->adjacentNodeArray[k];
+            if(adjacentNode->index > node->index && !node->IsConnectedTo(adjacentNode))
+                wallSegmentArray.push_back(node->adjacentWallArray[k]);
+        }
+    }
+
+    MergeCollinearWalls(wallSegmentArray);
+
     PlanarPhysics::BoundingBox mazeBox;
     mazeBox.min = Vector2D(0.0, 0.0);
     mazeBox.max = Vector2D(0.0, 0.0);
-    for(const Node* node : this->nodeArray)
+    for(const LineSegment& wallSegment : this->boundaryWallArray)
     {
-        mazeBox.ExpandToIncludePoint(node->center + Vector2D(MAZE_CELL_SIZE / 2.0, MAZE_CELL_SIZE / 2.0));
-        mazeBox.ExpandToIncludePoint(node->center - Vector2D(MAZE_CELL_SIZE / 2.0, MAZE_CELL_SIZE / 2.0));
+        mazeBox.ExpandToIncludePoint(wallSegment.vertexA);
+        mazeBox.ExpandToIncludePoint(wallSegment.vertexB);
     }
 
     mazeBox.min.x -= 5.0;
@@ -174,27 +547,11 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
 
     engine->SetWorldBox(mazeBox);
 
-    for(const Node* node : this->nodeArray)
-        node->GenerateWalls(engine, this);
-
-    double mazeWidth = MAZE_CELL_SIZE * this->cols;
-    double mazeHeight = MAZE_CELL_SIZE * this->rows;
-
-    MazeWall* mazeWallLeft = engine->AddPlanarObject<MazeWall>();
-    mazeWallLeft->lineSeg.vertexA = Vector2D(0.0, 0.0);
-    mazeWallLeft->lineSeg.vertexB = Vector2D(0.0, mazeHeight);
-
-    MazeWall* mazeWallRight = engine->AddPlanarObject<MazeWall>();
-    mazeWallRight->lineSeg.vertexA = Vector2D(mazeWidth, 0.0);
-    mazeWallRight->lineSeg.vertexB = Vector2D(mazeWidth, mazeHeight);
-
-    MazeWall* mazeWallBottom = engine->AddPlanarObject<MazeWall>();
-    mazeWallBottom->lineSeg.vertexA = Vector2D(0.0, 0.0);
-    mazeWallBottom->lineSeg.vertexB = Vector2D(mazeWidth, 0.0);
-
-    MazeWall* mazeWallTop = engine->AddPlanarObject<MazeWall>();
-    mazeWallTop->lineSeg.vertexA = Vector2D(0.0, mazeHeight);
-    mazeWallTop->lineSeg.vertexB = Vector2D(mazeWidth, mazeHeight);
+    for(const LineSegment& wallSegment : wallSegmentArray)
+    {
+        MazeWall* mazeWall = engine->AddPlanarObject<MazeWall>();
+        mazeWall->lineSeg = wallSegment;
+    }
 
     MazeBall* mazeBall = engine->AddPlanarObject<MazeBall>();
     mazeBall->position = this->nodeArray[0]->center;
@@ -203,14 +560,11 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
     mazeBall->SetBounceFactor(bounceFactor);
     mazeBall->SetFlags(PLNR_OBJ_FLAG_INFLUENCED_BY_GRAVITY | PLNR_OBJ_FLAG_CALL_COLLISION_FUNC);
 
-    std::vector<int> availableSlots;
-    for(int i = 1; i < this->nodeArray.size(); i++)
-        availableSlots.push_back(i);
+    int numGoodMazeBlocks = 0, numEvilMazeBlocks = 0, numMazeWorms = 0;
+    this->CountObjects(numGoodMazeBlocks, numEvilMazeBlocks, numMazeWorms);
 
-    Random::ShuffleArray<int>(availableSlots);
-    int* slot = availableSlots.data();
+    const int* slot = this->objectSlotArray.data();
 
-    int numGoodMazeBlocks = this->cols - 1;
     for(int i = 0; i < numGoodMazeBlocks; i++)
     {
         GoodMazeBlock* mazeBlock = engine->AddPlanarObject<GoodMazeBlock>();
@@ -221,7 +575,7 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
 
         std::vector<Vector2D> pointArray;
         double radius = MAZE_CELL_SIZE / 6.0;
-        int k = Random::Integer(3, 5);
+        int k = this->goodBlockSideCountArray[i];
         for(int j = 0; j < k; j++)
         {
             double angle = (double(j) / double(k)) * 2.0 * PLNR_PHY_PI;
@@ -232,7 +586,6 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
         mazeBlock->MakeShape(pointArray, 1.0);
     }
 
-    int numEvilMazeBlocks = numGoodMazeBlocks / 4;
     for(int i = 0; i < numEvilMazeBlocks; i++)
     {
         MazeBlock* mazeBlock = engine->AddPlanarObject<EvilMazeBlock>();
@@ -251,13 +604,14 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
         mazeBlock->MakeShape(pointArray, 1.0);
     }
 
-    if(numGoodMazeBlocks > 10)
+    for(int i = 0; i < numMazeWorms; i++)
     {
         MazeWorm* mazeWorm = engine->AddPlanarObject<MazeWorm>();
         mazeWorm->position = nodeArray[*slot++]->center;
         mazeWorm->radius = MAZE_CELL_SIZE / 7.0;
         mazeWorm->SetBounceFactor(1.0);
-        mazeWorm->velocity = Random::Vector(200.0, 250.0);
+        mazeWorm->velocity = this->wormVelocity;
+        mazeWorm->SetRandomSeed(this->wormSeed);
         mazeWorm->SetFlags(PLNR_OBJ_FLAG_CALL_COLLISION_FUNC);
     }
 
@@ -273,69 +627,258 @@ void Maze::PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool
     engine->ConsolidateWalls();
 }
 
+// Lots of little walls in a row make for a lot of extra collision work, so we join up
+// walls that meet end-to-end and point the same way.  Rather than compare every wall with
+// every other wall, we hash the end-points and only look at walls sharing a vertex.
+/*static*/ void Maze::MergeCollinearWalls(std::vector<PlanarPhysics::LineSegment>& wallSegmentArray)
+{
+    // End-points computed from different cells don't always agree to the last bit, so snap them to a fine grid.
+    auto vertexKey = [](const Vector2D& vertex) -> uint64_t
+    {
+        auto x = (int32_t)::llround(vertex.x * 1000.0);
+        auto y = (int32_t)::llround(vertex.y * 1000.0);
+        return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(y));
+    };
+
+    std::unordered_map<uint64_t, std::vector<int>> vertexMap;
+    vertexMap.reserve(wallSegmentArray.size() * 2);
+    for(int i = 0; i < (signed)wallSegmentArray.size(); i++)
+    {
+        vertexMap[vertexKey(wallSegmentArray[i].vertexA)].push_back(i);
+        vertexMap[vertexKey(wallSegmentArray[i].vertexB)].push_back(i);
+    }
+
+    std::vector<bool> mergedAwayArray(wallSegmentArray.size(), false);
+
+    for(auto& pair : vertexMap)
+    {
+        uint64_t key = pair.first;
+        std::vector<int>& wallList = pair.second;
+
+        bool merged = true;
+        while(merged)
+        {
+            merged = false;
+
+            for(int i = 0; i < (signed)wallList.size() && !merged; i++)
+            {
+                for(int j = i + 1; j < (signed)wallList.size() && !merged; j++)
+                {
+                    if(wallList[i] == wallList[j])
+                        continue;
+
+                    LineSegment& wallA = wallSegmentArray[wallList[i]];
+                    LineSegment& wallB = wallSegmentArray[wallList[j]];
+
+                    // Find the far end of each wall as seen from the shared vertex.
+                    const Vector2D& vertex = (vertexKey(wallA.vertexA) == key) ? wallA.vertexA : wallA.vertexB;
+                    Vector2D farVertexA = (vertexKey(wallA.vertexA) == key) ? wallA.vertexB : wallA.vertexA;
+                    Vector2D farVertexB = (vertexKey(wallB.vertexA) == key) ? wallB.vertexB : wallB.vertexA;
+
+                    Vector2D directionA = farVertexA - vertex;
+                    Vector2D directionB = farVertexB - vertex;
+                    double cross = directionA.x * directionB.y - directionA.y * directionB.x;
+                    double dot = directionA.x * directionB.x + directionA.y * directionB.y;
+                    if(dot >= 0.0 || ::fabs(cross) > 1e-6 * directionA.Magnitude() * directionB.Magnitude())
+                        continue;
+
+                    // Wall A now spans both walls, and takes over wall B's place at wall B's far end.
+                    int wallIndexA = wallList[i];
+                    int wallIndexB = wallList[j];
+                    wallA = LineSegment(farVertexA, farVertexB);
+                    mergedAwayArray[wallIndexB] = true;
+
+                    auto iter = vertexMap.find(vertexKey(farVertexB));
+                    if(iter != vertexMap.end())
+                        for(int& wallIndex : iter->second)
+                            if(wallIndex == wallIndexB)
+                                wallIndex = wallIndexA;
+
+                    wallList.erase(wallList.begin() + j);
+                    wallList.erase(wallList.begin() + i);
+                    merged = true;
+                }
+            }
+        }
+    }
+
+    int numWalls = 0;
+    for(int i = 0; i < (signed)wallSegmentArray.size(); i++)
+        if(!mergedAwayArray[i])
+            wallSegmentArray[numWalls++] = wallSegmentArray[i];
+
+    wallSegmentArray.resize(numWalls);
+}
+
 void Maze::Clear()
 {
     for(Node* node : this->nodeArray)
         delete node;
 
     this->nodeArray.clear();
+    this->boundaryWallArray.clear();
+    this->nodeBucketMap.clear();
+    this->objectSlotArray.clear();
+    this->goodBlockSideCountArray.clear();
+    this->wormVelocity = Vector2D(0.0, 0.0);
+    this->wormSeed = 0;
 }
 
-//--------------------------------- Maze::Node ---------------------------------
-
-Maze::Node::Node()
+// Note that we just write everything in the native byte order.  That's little-endian
+// on every device we run on and on the Linux machines we use to inspect cache files.
+template<typename T>
+static void WritePayload(std::vector<uint8_t>& payloadArray, const T& value)
 {
-    this->queued = false;
-    this->integrated = false;
-    this->debugName[0] = '\0';
+    const uint8_t* valueBuf = reinterpret_cast<const uint8_t*>(&value);
+    payloadArray.insert(payloadArray.end(), valueBuf, valueBuf + sizeof(T));
 }
 
-/*virtual*/ Maze::Node::~Node()
+template<typename T>
+static bool ReadPayload(const uint8_t*& payloadBuf, const uint8_t* payloadBufEnd, T& value)
 {
+    if(payloadBufEnd - payloadBuf < (ptrdiff_t)sizeof(T))
+        return false;
+
+    ::memcpy(&value, payloadBuf, sizeof(T));
+    payloadBuf += sizeof(T);
+    return true;
 }
 
-bool Maze::Node::IsConnectedTo(const Node* node) const
+bool Maze::Serialize(std::vector<uint8_t>& payloadArray) const
 {
-    for(const Node* connectedNode : this->connectedNodeArray)
-        if(connectedNode == node)
-            return true;
+    payloadArray.clear();
 
-    return false;
+    for(const Node* node : this->nodeArray)
+    {
+        if(node->adjacentNodeArray.size() > 8)
+            return false;
+
+        uint8_t wallMask = 0;
+        for(int k = 0; k < (signed)node->adjacentNodeArray.size(); k++)
+            if(!node->IsConnectedTo(node->adjacentNodeArray[k]))
+                wallMask |= (1 << k);
+
+        payloadArray.push_back(wallMask);
+    }
+
+    WritePayload(payloadArray, uint32_t(this->objectSlotArray.size()));
+    for(int slot : this->objectSlotArray)
+        WritePayload(payloadArray, int32_t(slot));
+
+    WritePayload(payloadArray, uint32_t(this->goodBlockSideCountArray.size()));
+    payloadArray.insert(payloadArray.end(), this->goodBlockSideCountArray.begin(), this->goodBlockSideCountArray.end());
+
+    WritePayload(payloadArray, this->wormVelocity.x);
+    WritePayload(payloadArray, this->wormVelocity.y);
+    WritePayload(payloadArray, this->wormSeed);
+
+    return true;
 }
 
-void Maze::Node::GenerateWalls(PlanarPhysics::Engine* engine, const Maze* maze) const
+bool Maze::Deserialize(Topology topology, int rows, int cols, const uint8_t* payloadBuf, size_t payloadBufSize)
 {
-    for(const Node* adjacentNode : this->adjacentNodeArray)
-    {
-        if(this->IsConnectedTo(adjacentNode))
-            continue;
+    const uint8_t* payloadBufEnd = payloadBuf + payloadBufSize;
 
-        Vector2D wallCenter = (this->center + adjacentNode->center) / 2.0;
-        Vector2D wallNormal = (adjacentNode->center - this->center).Normalized();
-        Vector2D wallTangent = wallNormal * PScalar2D(1.0);
+    this->BuildGrid(topology, rows, cols);
 
-        LineSegment wallSegment(wallCenter + wallTangent * MAZE_CELL_SIZE / 2.0, wallCenter - wallTangent * MAZE_CELL_SIZE / 2.0);
-        if(this->WallAlreadyExists(wallSegment, engine))
-            continue;
+    if(payloadBufSize < this->nodeArray.size())
+    {
+        this->Clear();
+        return false;
+    }
 
-        MazeWall* mazeWall = engine->AddPlanarObject<MazeWall>();
-        mazeWall->lineSeg = wallSegment;
+    for(Node* node : this->nodeArray)
+    {
+        uint8_t wallMask = *payloadBuf++;
+        for(int k = 0; k < (signed)node->adjacentNodeArray.size(); k++)
+        {
+            Node* adjacentNode = node->adjacentNodeArray[k];
+            if((wallMask & (1 << k)) == 0 && !node->IsConnectedTo(adjacentNode))
+            {
+                node->connectedNodeArray.push_back(adjacentNode);
+                adjacentNode->connectedNodeArray.push_back(node);
+            }
+        }
     }
-}
 
-bool Maze::Node::WallAlreadyExists(const PlanarPhysics::LineSegment& wallSegment, PlanarPhysics::Engine* engine) const
-{
-    const std::vector<PlanarObject*>& planarObjectArray = engine->GetPlanarObjectArray();
+    bool success = false;
 
-    for(const PlanarObject* planarObject : planarObjectArray)
+    do
     {
-        auto wall = dynamic_cast<const Wall*>(planarObject);
-        if(wall)
+        uint32_t numSlots = 0;
+        if(!ReadPayload(payloadBuf, payloadBufEnd, numSlots) || numSlots > this->nodeArray.size())
+            break;
+
+        this->objectSlotArray.resize(numSlots);
+        bool slotsValid = true;
+        for(uint32_t i = 0; i < numSlots && slotsValid; i++)
+        {
+            int32_t slot = 0;
+            slotsValid = ReadPayload(payloadBuf, payloadBufEnd, slot) && slot >= 0 && slot < (int32_t)this->nodeArray.size();
+            this->objectSlotArray[i] = slot;
+        }
+
+        if(!slotsValid)
+            break;
+
+        uint32_t numGoodMazeBlocks = 0;
+        if(!ReadPayload(payloadBuf, payloadBufEnd, numGoodMazeBlocks) || payloadBufEnd - payloadBuf < (ptrdiff_t)numGoodMazeBlocks)
+            break;
+
+        this->goodBlockSideCountArray.assign(payloadBuf, payloadBuf + numGoodMazeBlocks);
+        payloadBuf += numGoodMazeBlocks;
+
+        if(!ReadPayload(payloadBuf, payloadBufEnd, this->wormVelocity.x) ||
+           !ReadPayload(payloadBuf, payloadBufEnd, this->wormVelocity.y) ||
+           !ReadPayload(payloadBuf, payloadBufEnd, this->wormSeed))
         {
-            if(wall->lineSeg.SameGeometryAs(wallSegment))
-                return true;
+            break;
         }
+
+        // Make sure what we read is consistent with what populating the physics world is going to expect.
+        int expectedGoodMazeBlocks = 0, expectedEvilMazeBlocks = 0, expectedMazeWorms = 0;
+        this->CountObjects(expectedGoodMazeBlocks, expectedEvilMazeBlocks, expectedMazeWorms);
+        if((int)numGoodMazeBlocks != expectedGoodMazeBlocks)
+            break;
+
+        if((int)numSlots < expectedGoodMazeBlocks + expectedEvilMazeBlocks + expectedMazeWorms + 1)
+            break;
+
+        success = true;
     }
+    while(false);
+
+    if(!success)
+        this->Clear();
+
+    return success;
+}
+
+//--------------------------------- Maze::Node ---------------------------------
+
+Maze::Node::Node()
+{
+    this->index = -1;
+    this->queued = false;
+    this->integrated = false;
+    this->debugName[0] = '\0';
+}
+
+/*virtual*/ Maze::Node::~Node()
+{
+}
+
+void Maze::Node::AddAdjacency(Node* adjacentNode, const PlanarPhysics::LineSegment& wallSegment)
+{
+    this->adjacentNodeArray.push_back(adjacentNode);
+    this->adjacentWallArray.push_back(wallSegment);
+}
+
+bool Maze::Node::IsConnectedTo(const Node* node) const
+{
+    for(const Node* connectedNode : this->connectedNodeArray)
+        if(connectedNode == node)
+            return true;
 
     return false;
 }
\ No newline at end of file
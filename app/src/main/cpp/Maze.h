@@ -3,7 +3,9 @@
 #include "Engine.h"
 #include "Math/GeometricAlgebra/Vector2D.h"
 #include "Math/Utilities/LineSegment.h"
+#include "RandomGenerator.h"
 #include <vector>
+#include <unordered_map>
 
 // Mazes can very in size in terms of rows and columns, but the cell
 // size should always remain the same so that the physics can work
@@ -11,8 +13,10 @@
 // the maze is, we can always render it to fit the screen.
 #define MAZE_CELL_SIZE       40.0
 
-// TODO: It wouldn't be too hard to make mazes with different geometries; e.g., those
-//       that aren't necessarily rectangular, but, say, honey-comb shapes or circular.
+// Mazes can be laid out on a few different kinds of grids.  Whatever the grid,
+// each cell just knows its adjacent cells and the wall it would share with each
+// of them, so generation, caching and populating the physics world all work
+// the same way for every topology.
 class Maze
 {
     friend class Node;
@@ -21,10 +25,42 @@ public:
     Maze();
     virtual ~Maze();
 
-    bool Generate(int rows, int cols, int seedModifier);
+    enum class Topology
+    {
+        RECTANGULAR,
+        HEXAGONAL,
+        POLAR
+    };
+
+    static const char* GetTopologyName(Topology topology);
+    static bool FindTopologyByName(const char* name, Topology& topology);
+
+    // This is how big the maze for a given level is.  The game and the host tools both size levels this way,
+    // so that what we measure off the device is what the player actually gets.
+    static void CalcLevelSize(int level, double aspectRatio, int& rows, int& cols);
+
+    // All randomness comes from the given generator, so the same seed always gives the same maze.
+    // This decides where all the objects will go too, so populating the physics world is deterministic.
+    // For hexagonal mazes, the rows and columns are those of the honey-comb.  For polar (circular) mazes,
+    // we pick a number of rings that gives roughly the same number of cells as rows by columns would.
+    bool Generate(int rows, int cols, RandomGenerator& random, Topology topology = Topology::RECTANGULAR);
     void PopulatePhysicsWorld(PlanarPhysics::Engine* engine, int touches, bool queen, double bounceFactor) const;
     void Clear();
 
+    Topology GetTopology() const { return this->topology; }
+    int GetRows() const { return this->rows; }
+    int GetCols() const { return this->cols; }
+    int GetCellCount() const { return (int)this->nodeArray.size(); }
+
+    // This is the compact form of a generated maze that we write to (and read from) the maze cache.
+    // For each cell, bit k of its wall mask is set if there is a wall between it and its k-th adjacent cell.
+    bool Serialize(std::vector<uint8_t>& payloadArray) const;
+    bool Deserialize(Topology topology, int rows, int cols, const uint8_t* payloadBuf, size_t payloadBufSize);
+
+    // Breadth-first search the maze graph from the cell containing the given start point to the nearest
+    // cell containing any of the given goal points.  The path is returned as a sequence of cell centers.
+    bool FindPathToNearestGoal(const PlanarPhysics::Vector2D& startPoint, const std::vector<PlanarPhysics::Vector2D>& goalPointArray, std::vector<PlanarPhysics::Vector2D>& pathArray) const;
+
 private:
     class Node
     {
@@ -32,23 +68,51 @@ private:
         Node();
         virtual ~Node();
 
+        // These two arrays go together: the k-th wall is the one we'd share with the k-th adjacent node.
         std::vector<Node*> adjacentNodeArray;
+        std::vector<PlanarPhysics::LineSegment> adjacentWallArray;
         std::vector<Node*> connectedNodeArray;
 
+        void AddAdjacency(Node* adjacentNode, const PlanarPhysics::LineSegment& wallSegment);
         bool IsConnectedTo(const Node* node) const;
-        void GenerateWalls(PlanarPhysics::Engine* engine, const Maze* maze) const;
-        bool WallAlreadyExists(const PlanarPhysics::LineSegment& wallSegment, PlanarPhysics::Engine* engine) const;
 
         PlanarPhysics::Vector2D center;
+        int index;
         bool queued;
         bool integrated;
         char debugName[128];
     };
 
-    Node* RandomNode(std::vector<Node*>& nodeArray, int* lastRandom = nullptr);
-    Node* RandomNode(std::list<Node*>& nodeList, bool remove);
+    void BuildGrid(Topology topology, int rows, int cols);
+    void BuildRectangularGrid();
+    void BuildHexagonalGrid();
+    void BuildPolarGrid();
+    void IndexNodes();
+    Node* AddNode(const PlanarPhysics::Vector2D& center);
+    static uint64_t MakeBucketKey(const PlanarPhysics::Vector2D& point);
+    static PlanarPhysics::LineSegment MakeWallBetween(const PlanarPhysics::Vector2D& centerA, const PlanarPhysics::Vector2D& centerB, double wallLength);
+    static void MergeCollinearWalls(std::vector<PlanarPhysics::LineSegment>& wallSegmentArray);
+    void PlaceObjects(RandomGenerator& random);
+    void CountObjects(int& numGoodMazeBlocks, int& numEvilMazeBlocks, int& numMazeWorms) const;
+    Node* RandomNode(std::vector<Node*>& nodeArray, RandomGenerator& random, int* lastRandom = nullptr);
+    Node* RandomNode(std::list<Node*>& nodeList, bool remove, RandomGenerator& random);
+    const Node* FindNearestNode(const PlanarPhysics::Vector2D& point) const;
 
     std::vector<Node*> nodeArray;
 
+    // These are the walls around the outside of the maze, one per cell edge.
+    std::vector<PlanarPhysics::LineSegment> boundaryWallArray;
+
+    // This buckets the nodes by position on a grid the size of a cell so that we can find them quickly.
+    std::unordered_map<uint64_t, std::vector<int>> nodeBucketMap;
+
+    Topology topology;
     int rows, cols;
+
+    // These are the node indices where objects go, in this order: good blocks, evil blocks, worms and the queen.
+    // We always reserve a slot for the queen, whether or not she's needed.
+    std::vector<int> objectSlotArray;
+    std::vector<uint8_t> goodBlockSideCountArray;
+    PlanarPhysics::Vector2D wormVelocity;
+    uint64_t wormSeed;
 };
\ No newline at end of file
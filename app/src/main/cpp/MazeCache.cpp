@@ -0,0 +1,212 @@
+#include "MazeCache.h"
+#include "Maze.h"
+#include "Checksum.h"
+#include "AndroidOut.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+MazeCache::MazeCache()
+{
+}
+
+/*virtual*/ MazeCache::~MazeCache()
+{
+}
+
+bool MazeCache::SetFolder(const std::string& cacheFolder)
+{
+    this->cacheFolder = cacheFolder;
+
+    if(0 != ::mkdir(this->cacheFolder.c_str(), 0700) && errno != EEXIST)
+    {
+        aout << "Failed to create maze cache folder: " << this->cacheFolder << std::endl;
+        this->cacheFolder = "";
+        return false;
+    }
+
+    return true;
+}
+
+std::string MazeCache::MakeCacheFilePath(Maze::Topology topology, int rows, int cols, int seed) const
+{
+    char cacheFileName[128];
+    sprintf(cacheFileName, "/maze_%d_%d_%d_%d.bin", int(topology), rows, cols, seed);
+    return this->cacheFolder + cacheFileName;
+}
+
+bool MazeCache::Load(Maze::Topology topology, int rows, int cols, int seed, Maze& maze)
+{
+    if(this->cacheFolder.length() == 0)
+        return false;
+
+    Header header;
+    if(!LoadFile(this->MakeCacheFilePath(topology, rows, cols, seed), maze, &header))
+        return false;
+
+    // The file name should guarantee this, but it costs nothing to check.
+    if(header.topology != uint32_t(topology) || header.rows != rows || header.cols != cols || header.seed != seed)
+    {
+        maze.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool MazeCache::Save(int seed, const Maze& maze, AsyncFileWriter& fileWriter)
+{
+    if(this->cacheFolder.length() == 0)
+        return false;
+
+    std::string cachedData;
+    if(!PackFile(seed, maze, cachedData))
+        return false;
+
+    // The cache only ever gets one file bigger per save, so making room for this one before it's written is enough.
+    std::string cacheFolder = this->cacheFolder;
+    fileWriter.Write(this->MakeCacheFilePath(maze.GetTopology(), maze.GetRows(), maze.GetCols(), seed), [cachedData, cacheFolder](std::string& fileData) -> bool
+    {
+        PruneOldEntries(cacheFolder, MAZE_CACHE_MAX_ENTRIES - 1);
+        fileData = cachedData;
+        return true;
+    });
+
+    return true;
+}
+
+/*static*/ bool MazeCache::LoadFile(const std::string& cacheFile, Maze& maze, Header* header /*= nullptr*/)
+{
+    bool success = false;
+    int fd = -1;
+    void* mappedBuf = MAP_FAILED;
+    size_t mappedBufSize = 0;
+
+    do
+    {
+        fd = ::open(cacheFile.c_str(), O_RDONLY);
+        if(fd < 0)
+            break;
+
+        struct stat fileStat;
+        if(0 != ::fstat(fd, &fileStat) || fileStat.st_size < (off_t)sizeof(Header))
+            break;
+
+        mappedBufSize = (size_t)fileStat.st_size;
+        mappedBuf = ::mmap(nullptr, mappedBufSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mappedBuf == MAP_FAILED)
+            break;
+
+        Header fileHeader;
+        ::memcpy(&fileHeader, mappedBuf, sizeof(Header));
+
+        if(fileHeader.magic != MAZE_CACHE_MAGIC || fileHeader.version != MAZE_CACHE_VERSION || fileHeader.headerSize != sizeof(Header))
+        {
+            aout << "Maze cache file " << cacheFile << " has the wrong magic or version." << std::endl;
+            break;
+        }
+
+        if(fileHeader.payloadSize != mappedBufSize - sizeof(Header))
+        {
+            aout << "Maze cache file " << cacheFile << " is truncated." << std::endl;
+            break;
+        }
+
+        const uint8_t* payloadBuf = static_cast<const uint8_t*>(mappedBuf) + sizeof(Header);
+        if(CalcCrc32(payloadBuf, fileHeader.payloadSize) != fileHeader.payloadChecksum)
+        {
+            aout << "Maze cache file " << cacheFile << " failed its checksum." << std::endl;
+            break;
+        }
+
+        if(fileHeader.topology > uint32_t(Maze::Topology::POLAR))
+            break;
+
+        if(!maze.Deserialize(Maze::Topology(fileHeader.topology), fileHeader.rows, fileHeader.cols, payloadBuf, fileHeader.payloadSize))
+            break;
+
+        if(header)
+            *header = fileHeader;
+
+        success = true;
+    }
+    while(false);
+
+    if(mappedBuf != MAP_FAILED)
+        ::munmap(mappedBuf, mappedBufSize);
+
+    if(fd >= 0)
+        ::close(fd);
+
+    return success;
+}
+
+/*static*/ bool MazeCache::SaveFile(const std::string& cacheFile, int seed, const Maze& maze)
+{
+    std::string fileData;
+    if(!PackFile(seed, maze, fileData))
+        return false;
+
+    return AsyncFileWriter::WriteFileAtomically(cacheFile, fileData.data(), fileData.size());
+}
+
+/*static*/ bool MazeCache::PackFile(int seed, const Maze& maze, std::string& fileData)
+{
+    std::vector<uint8_t> payloadArray;
+    if(!maze.Serialize(payloadArray))
+        return false;
+
+    Header header;
+    ::memset(&header, 0, sizeof(Header));
+    header.magic = MAZE_CACHE_MAGIC;
+    header.version = MAZE_CACHE_VERSION;
+    header.headerSize = sizeof(Header);
+    header.topology = uint32_t(maze.GetTopology());
+    header.rows = maze.GetRows();
+    header.cols = maze.GetCols();
+    header.seed = seed;
+    header.payloadSize = (uint32_t)payloadArray.size();
+    header.payloadChecksum = CalcCrc32(payloadArray.data(), payloadArray.size());
+
+    fileData.resize(sizeof(Header) + payloadArray.size());
+    ::memcpy(&fileData[0], &header, sizeof(Header));
+    if(payloadArray.size() > 0)
+        ::memcpy(&fileData[sizeof(Header)], payloadArray.data(), payloadArray.size());
+
+    return true;
+}
+
+/*static*/ void MazeCache::PruneOldEntries(const std::string& cacheFolder, int maxEntries)
+{
+    DIR* dir = ::opendir(cacheFolder.c_str());
+    if(!dir)
+        return;
+
+    std::vector<std::pair<time_t, std::string>> entryArray;
+    while(struct dirent* entry = ::readdir(dir))
+    {
+        if(::strstr(entry->d_name, "maze_") != entry->d_name)
+            continue;
+
+        std::string cacheFile = cacheFolder + "/" + entry->d_name;
+        struct stat fileStat;
+        if(0 == ::stat(cacheFile.c_str(), &fileStat))
+            entryArray.push_back(std::pair<time_t, std::string>(fileStat.st_mtime, cacheFile));
+    }
+
+    ::closedir(dir);
+
+    if((signed)entryArray.size() <= maxEntries)
+        return;
+
+    // Oldest first, so we throw away whatever we haven't written in the longest time.
+    std::sort(entryArray.begin(), entryArray.end());
+    for(int i = 0; i < (signed)entryArray.size() - maxEntries; i++)
+        ::unlink(entryArray[i].second.c_str());
+}
\ No newline at end of file
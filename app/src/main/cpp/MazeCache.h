@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Maze.h"
+#include "AsyncFileWriter.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#define MAZE_CACHE_MAGIC            0x435A4D47      // "GMZC" when read as little-endian bytes.
+#define MAZE_CACHE_VERSION          2
+#define MAZE_CACHE_MAX_ENTRIES      64
+
+// Generating a maze isn't free, especially for the later levels, so we keep the
+// ones we've generated in internal storage, keyed by their topology, dimensions and seed.
+// A level resumed after the app restarts, or any maze we revisit, is then just
+// a matter of mapping in a small file and rebuilding the graph from it.
+class MazeCache
+{
+public:
+    MazeCache();
+    virtual ~MazeCache();
+
+    // Every cache file starts with this.  The checksum covers just the payload that follows.
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t topology;
+        int32_t rows;
+        int32_t cols;
+        int32_t seed;
+        uint32_t payloadSize;
+        uint32_t payloadChecksum;
+    };
+
+    bool SetFolder(const std::string& cacheFolder);
+
+    bool Load(Maze::Topology topology, int rows, int cols, int seed, Maze& maze);
+
+    // The maze is packed up right here, but the file is written (and old entries pruned) on the writer's thread.
+    bool Save(int seed, const Maze& maze, AsyncFileWriter& fileWriter);
+
+    // These work with any file path so that we can use them from host tools too.
+    static bool LoadFile(const std::string& cacheFile, Maze& maze, Header* header = nullptr);
+    static bool SaveFile(const std::string& cacheFile, int seed, const Maze& maze);
+    static bool PackFile(int seed, const Maze& maze, std::string& fileData);
+
+private:
+    std::string MakeCacheFilePath(Maze::Topology topology, int rows, int cols, int seed) const;
+    static void PruneOldEntries(const std::string& cacheFolder, int maxEntries);
+
+    std::string cacheFolder;
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "MazeBall.h"
 #include "MazeBlock.h"
 #include "../DrawHelper.h"
+#include "../PhysicsWorld.h"
 
 using namespace PlanarPhysics;
 
@@ -42,4 +43,8 @@ MazeBall::MazeBall()
     auto mazeBlock = dynamic_cast<GoodMazeBlock*>(planarObject);
     if(mazeBlock)
         mazeBlock->SetTouched(true);
+
+    auto physicsWorld = dynamic_cast<PhysicsWorld*>(engine);
+    if(physicsWorld)
+        physicsWorld->CountBallCollision();
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../DrawHelper.h"
 #include "Math/Utilities/LineSegment.h"
 #include "../Progress.h"
+#include "../PhysicsWorld.h"
 
 using namespace PlanarPhysics;
 
@@ -107,5 +108,9 @@ EvilMazeBlock::EvilMazeBlock()
             if (goodMazeBlock)
                 goodMazeBlock->SetTouched(false);
         }
+
+        auto physicsWorld = dynamic_cast<PhysicsWorld*>(engine);
+        if(physicsWorld)
+            physicsWorld->CountEvilBlockReset();
     }
 }
\ No newline at end of file
@@ -1,9 +1,8 @@
 #include "MazeWorm.h"
 #include "MazeBlock.h"
 #include "MazeQueen.h"
-#include "Math/Utilities/Random.h"
 #include "../DrawHelper.h"
-#include "../GameLogic.h"
+#include "../PhysicsWorld.h"
 
 using namespace PlanarPhysics;
 
@@ -34,7 +33,7 @@ MazeWorm::MazeWorm()
     double speed = this->velocity.Magnitude();
     if(speed < 200.0)
     {
-        speed = Random::Number(200.0, 250.0);
+        speed = this->random.Number(200.0, 250.0);
         this->velocity = this->velocity.Normalized() * speed;
     }
 
@@ -70,7 +69,7 @@ MazeWorm::MazeWorm()
     auto mazeQueen = dynamic_cast<MazeQueen*>(planarObject);
     if(mazeQueen)
     {
-        auto physicsWorld = dynamic_cast<GameLogic::PhysicsWorld*>(engine);
+        auto physicsWorld = dynamic_cast<PhysicsWorld*>(engine);
         if(physicsWorld)
         {
             if(physicsWorld->GetGoodMazeBlockCount() == physicsWorld->GetGoodMazeBlockTouchedCount())
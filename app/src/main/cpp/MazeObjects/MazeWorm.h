@@ -2,6 +2,7 @@
 
 #include "PlanarObjects/Ball.h"
 #include "../MazeObject.h"
+#include "../RandomGenerator.h"
 
 class MazeWorm : public PlanarPhysics::Ball, public MazeObject
 {
@@ -17,8 +18,13 @@ public:
     virtual PlanarPhysics::Vector2D GetPosition() const override;
     virtual void CollisionOccurredWith(PlanarPhysics::PlanarObject* planarObject, PlanarPhysics::Engine* engine) override;
 
+    void SetRandomSeed(uint64_t seed) { this->random.Seed(seed); }
+
 private:
 
+    // The worm gets its own generator so that a simulation plays out the same way every time.
+    RandomGenerator random;
+
     std::vector<PlanarPhysics::Vector2D> positionFifo;
     int maxPositionFifoSize;
 };
\ No newline at end of file
@@ -1,23 +1,23 @@
 #include "MidiManager.h"
 #include "AndroidOut.h"
-#include "MidiFileFormat.h"
-#include "MidiData.h"
-#include "Error.h"
+#include "MidiSynth.h"
 #include "Math/Utilities/Random.h"
 #include <android/asset_manager.h>
 #include <jni.h>
 
-using namespace AudioDataLib;
-
-MidiManager::MidiManager(android_app* app) : AudioDataLib::MidiPlayer(nullptr)
+MidiManager::MidiManager(android_app* app)
 {
     this->app = app;
     this->midiDevice = nullptr;
     this->midiInputPort = nullptr;
+    this->synth = nullptr;
+    this->port = nullptr;
+    this->jobSystem = nullptr;
     this->nextSongOffset = 0;
-    this->currentMidiData = nullptr;
+    this->playingSong = nullptr;
+    this->timelineCursor = 0;
     this->waitTimeBetweenSongsSeconds = 0.0;
-    this->waitTimeBegin = 0;
+    this->waitTimeBeginNanoseconds = 0;
     this->state = State::INITIAL;
     this->stateMethodMap.insert(std::pair<State, StateMethod>(State::INITIAL, &MidiManager::InitialStateHandler));
     this->stateMethodMap.insert(std::pair<State, StateMethod>(State::SHUTDOWN, &MidiManager::ShutdownStateHandler));
@@ -31,6 +31,7 @@ MidiManager::MidiManager(android_app* app) : AudioDataLib::MidiPlayer(nullptr)
 
 /*virtual*/ MidiManager::~MidiManager()
 {
+    this->ClearSongCache();
 }
 
 void MidiManager::Manage()
@@ -43,6 +44,17 @@ void MidiManager::Manage()
         this->state = (this->*method)();
 }
 
+void MidiManager::SetSynth(MidiSynth* synth)
+{
+    this->synth = synth;
+    this->synthMidiPort.synth = synth;
+}
+
+void MidiManager::SetJobSystem(JobSystem* jobSystem)
+{
+    this->jobSystem = jobSystem;
+}
+
 void MidiManager::Abort()
 {
     this->state = State::SHUTDOWN;
@@ -75,6 +87,14 @@ MidiManager::State MidiManager::InitialStateHandler()
     }
 
     aout << "Failed to kick off MIDI device open." << std::endl;
+
+    if(this->synth)
+    {
+        aout << "Falling back on the built-in synthesizer." << std::endl;
+        this->port = &this->synthMidiPort;
+        return State::PICK_NEW_SONG;
+    }
+
     return State::SHUTDOWN;
 }
 
@@ -82,14 +102,17 @@ MidiManager::State MidiManager::ShutdownStateHandler()
 {
     aout << "Shutdown down MIDI stuff..." << std::endl;
 
-    Error error;
-    this->EndPlayback(error);
+    // The timeline belongs to the scheduler's thread until that thread is gone.
+    this->scheduler.Stop();
 
-    if(this->currentMidiData)
-    {
-        MidiData::Destroy(this->currentMidiData);
-        this->currentMidiData = nullptr;
-    }
+    if(this->port == &this->synthMidiPort)
+        this->synth->Reset();
+    else if(this->port)
+        this->SendAllNotesOff();
+
+    this->port = nullptr;
+    this->androidMidiPort.midiInputPort = nullptr;
+    this->ClearSongCache();
 
     if(this->midiInputPort)
     {
@@ -177,18 +200,20 @@ MidiManager::State MidiManager::WaitForMidiDeviceOpenStateHandler()
     if(!this->midiInputPort)
         return State::SHUTDOWN;
 
+    this->androidMidiPort.midiInputPort = this->midiInputPort;
+    this->port = &this->androidMidiPort;
     return State::PICK_NEW_SONG;
 }
 
 MidiManager::State MidiManager::PickNewSongStateHandler()
 {
-    AAssetManager* assetManager = this->app->activity->assetManager;
+    if(!this->jobSystem)
+        return State::SHUTDOWN;
 
-    if(this->shuffledSongArray.size() == 0 || this->nextSongOffset >= this->shuffledSongArray.size())
+    // The song list never changes, so we only ever need to read it once.  After that, we just reshuffle it.
+    if(this->shuffledSongArray.size() == 0)
     {
-        this->shuffledSongArray.clear();
-
-        AAssetDir* songDir = AAssetManager_openDir(assetManager, "midi_songs");
+        AAssetDir* songDir = AAssetManager_openDir(this->app->activity->assetManager, "midi_songs");
         if(!songDir)
             return State::SHUTDOWN;
 
@@ -210,51 +235,37 @@ MidiManager::State MidiManager::PickNewSongStateHandler()
         this->nextSongOffset = 0;
     }
 
-    std::string songFile = "midi_songs/" + this->shuffledSongArray[this->nextSongOffset++];
-    aout << "Loading song: " + songFile << std::endl;
-    AAsset* songAsset = AAssetManager_open(assetManager, songFile.c_str(), AASSET_MODE_BUFFER);
-    if(!songAsset)
-        return State::SHUTDOWN;
-
-    int songAssetSize = AAsset_getLength(songAsset);
-    const unsigned char* songAssetBuf = static_cast<const unsigned char*>(AAsset_getBuffer(songAsset));
-    Error error;
-    FileData* fileData = nullptr;
-    ReadOnlyBufferStream bufferStream(songAssetBuf, songAssetSize);
-    MidiFileFormat fileFormat;
-    bool success = fileFormat.ReadFromStream(bufferStream, fileData, error);
-    AAsset_close(songAsset);
+    // Normally, this song was fetched when the last one started, and it's been ready for ages.
+    // If not (say, for the very first song), we just check back next frame rather than wait on it.
+    Song* song = this->FetchSong(this->shuffledSongArray[this->nextSongOffset]);
+    if(song->IsLoading())
+        return State::PICK_NEW_SONG;
 
-    if(!success)
+    if(!song->loaded)
     {
-        delete fileData;
-        aout << "Failed to read MIDI file: " + songFile << std::endl;
-        aout << "Reason: " + error.GetMessage() << std::endl;
+        aout << "Failed to read MIDI file: " + song->filePath << std::endl;
         return State::SHUTDOWN;
     }
 
-    this->currentMidiData = dynamic_cast<MidiData*>(fileData);
-    if(!this->currentMidiData)
+    if(++this->nextSongOffset >= int(this->shuffledSongArray.size()))
     {
-        delete fileData;
-        return State::SHUTDOWN;
+        PlanarPhysics::Random::ShuffleArray<std::string>(this->shuffledSongArray);
+        this->nextSongOffset = 0;
     }
 
-    this->SetMidiData(this->currentMidiData);
-
-    std::set<uint32_t> tracksToPlaySet;
-    this->GetSimultaneouslyPlayableTracks(tracksToPlaySet);
+    aout << "Playing song: " + song->filePath << std::endl;
+    aout << "Song has " << song->timeline.GetTrackCount() << " tracks and " << song->timeline.GetEventCount() << " events over " << song->timeline.GetLengthSeconds() << " seconds." << std::endl;
 
-    for(uint32_t i : tracksToPlaySet)
+    this->playingSong = song;
+    this->timelineCursor = 0;
+    if(!this->scheduler.Start(this, this->port, MIDI_SCHEDULER_LOOKAHEAD_SECONDS, MIDI_SCHEDULER_PERIOD_SECONDS))
     {
-        double trackTimeSeconds = 0.0;
-        this->currentMidiData->CalculateTrackLengthInSeconds(i, trackTimeSeconds, error);
-        aout << "Track " << i << " is " << trackTimeSeconds << " seconds." << std::endl;
+        aout << "Failed to start MIDI scheduler thread!" << std::endl;
+        return State::SHUTDOWN;
     }
 
-    this->SetTimeSeconds(0.0);
-    if(!this->BeginPlayback(tracksToPlaySet, error))
-        return State::SHUTDOWN;
+    // Get the next song loading while this one plays.
+    this->FetchSong(this->shuffledSongArray[this->nextSongOffset]);
 
     aout << "Song should now play!!!" << std::endl;
     return State::PLAY_SONG;
@@ -262,75 +273,193 @@ MidiManager::State MidiManager::PickNewSongStateHandler()
 
 MidiManager::State MidiManager::PlaySongStateHandler()
 {
-    Error error;
-
-    if(this->NoMoreToPlay())
-    {
-        aout << "Hit end of song!" << std::endl;
-        this->EndPlayback(error);
-        this->SetMidiData(nullptr);
-        delete this->currentMidiData;
-        this->currentMidiData = nullptr;
-        return State::PICK_WAIT_TIME_BETWEEN_SONGS;
-    }
-
+    // All the real work happens on the scheduler's thread.  We just wait here for it to finish the song.
     // TODO: If the app window is destroyed or something like that, we need
     //       to send a NOTE-OFF event for all channels.  We should probably
     //       do this after the window is recreated too.
-    if(!this->ManagePlayback(error))
-    {
-        aout << "Error occurred during playback management!" << std::endl;
-        aout << "Error: " + error.GetMessage() << std::endl;
-        return State::SHUTDOWN;
-    }
+    if(!this->scheduler.IsFinished())
+        return State::PLAY_SONG;
 
-    int32_t timeSeconds = ::round(this->GetTimeSeconds());
-    static int32_t lastTimeSeconds = 0;
-    if(timeSeconds != lastTimeSeconds)
-    {
-        aout << "Playback at " << timeSeconds << " seconds." << std::endl;
-        lastTimeSeconds = timeSeconds;
-    }
+    this->scheduler.Stop();
 
-    return State::PLAY_SONG;
+    aout << "Hit end of song!" << std::endl;
+    aout << "Sent " << this->scheduler.GetSentCount() << " MIDI batches (" << this->scheduler.GetLateCount() << " late, " << this->scheduler.GetFailedCount() << " failed)." << std::endl;
+
+    // Songs don't always let go of every note they play, so make sure nothing hangs over into the silence.
+    this->SendAllNotesOff();
+    this->playingSong = nullptr;
+    return State::PICK_WAIT_TIME_BETWEEN_SONGS;
 }
 
 MidiManager::State MidiManager::PickWaitTimeBetweenSongsStateHandler()
 {
     this->waitTimeBetweenSongsSeconds = PlanarPhysics::Random::Number(10.0, 20.0);
-    this->waitTimeBegin = ::clock();
+    this->waitTimeBeginNanoseconds = MidiScheduler::GetTimeNanoseconds();
     aout << "Waiting " << this->waitTimeBetweenSongsSeconds << " seconds before playing another song." << std::endl;
     return State::WAIT_BETWEEN_SONGS;
 }
 
 MidiManager::State MidiManager::WaitBetweenSongsStateHandler()
 {
-    clock_t waitTimeNow = ::clock();
-    clock_t waitTimeElapsed = waitTimeNow - this->waitTimeBegin;
-    double waitTimeElapsedSeconds = double(waitTimeElapsed) / double(CLOCKS_PER_SEC);
+    // This has to be the monotonic clock.  The CPU clock barely moves while the main thread sleeps on its looper.
+    int64_t waitTimeElapsed = MidiScheduler::GetTimeNanoseconds() - this->waitTimeBeginNanoseconds;
+    double waitTimeElapsedSeconds = double(waitTimeElapsed) / 1e9;
     if(waitTimeElapsedSeconds >= this->waitTimeBetweenSongsSeconds)
         return State::PICK_NEW_SONG;
 
     return State::WAIT_BETWEEN_SONGS;
 }
 
-/*virtual*/ bool MidiManager::SendMessage(const uint8_t* message, uint64_t messageSize, AudioDataLib::Error& error)
+/*virtual*/ bool MidiManager::Pump(double untilSeconds, MidiScheduler& scheduler)
 {
-    if(!this->midiInputPort)
+    const MidiTimeline& timeline = this->playingSong->timeline;
+    while(this->timelineCursor < timeline.GetEventCount())
     {
-        error.Add("No MIDI input port to which we can send the message!");
-        return false;
+        const MidiTimeline::Event& event = timeline.GetEvent(this->timelineCursor);
+        if(event.timeSeconds > untilSeconds)
+            break;
+
+        scheduler.AddEvent(event.timeSeconds, event.byteArray, event.size);
+        this->timelineCursor++;
+    }
+
+    // Even once the last event is out, the song isn't over until its tracks end.
+    return this->timelineCursor < timeline.GetEventCount() || untilSeconds < timeline.GetLengthSeconds();
+}
+
+MidiManager::Song* MidiManager::FetchSong(const std::string& songFile)
+{
+    std::string filePath = "midi_songs/" + songFile;
+
+    for(auto iter = this->songCacheList.begin(); iter != this->songCacheList.end(); iter++)
+    {
+        Song* song = *iter;
+        if(song->filePath == filePath)
+        {
+            this->songCacheList.splice(this->songCacheList.begin(), this->songCacheList, iter);
+            return song;
+        }
     }
 
-    // Hmmm...not so sure this loop is such a good idea.
-    ssize_t bytesRemaining = messageSize;
-    ssize_t totalBytesSent = 0;
-    while(bytesRemaining > 0)
+    // Make room by throwing out whatever's gone unused the longest.  If everything is busy, we just go over for a while.
+    if(this->songCacheList.size() >= MIDI_SONG_CACHE_SIZE)
     {
-        ssize_t numBytesSent = AMidiInputPort_send(this->midiInputPort, &message[totalBytesSent], bytesRemaining);
-        totalBytesSent += numBytesSent;
-        bytesRemaining -= numBytesSent;
+        for(auto iter = this->songCacheList.rbegin(); iter != this->songCacheList.rend(); iter++)
+        {
+            Song* song = *iter;
+            if(song != this->playingSong && !song->IsLoading())
+            {
+                this->songCacheList.erase(std::next(iter).base());
+                delete song;
+                break;
+            }
+        }
+    }
+
+    auto song = new Song();
+    song->filePath = filePath;
+    this->songCacheList.push_front(song);
+
+    aout << "Loading song: " + filePath << std::endl;
+    AAssetManager* assetManager = this->app->activity->assetManager;
+    song->loadJob = new JobSystem::LambdaJob([song, assetManager]()
+    {
+        song->Load(assetManager);
+    });
+
+    this->jobSystem->Submit(song->loadJob);
+    return song;
+}
+
+void MidiManager::ClearSongCache()
+{
+    // Songs still loading have to finish before we can free them.
+    for(Song* song : this->songCacheList)
+    {
+        if(song->loadJob)
+            this->jobSystem->WaitForJob(song->loadJob);
+
+        delete song;
     }
 
-    return true;
+    this->songCacheList.clear();
+    this->playingSong = nullptr;
+}
+
+void MidiManager::SendAllNotesOff()
+{
+    if(!this->port)
+        return;
+
+    // That's all-notes-off and a sustain pedal release on every channel, sent right away.
+    // If the synthesizer can't keep up, it drops the message and counts it, but that's no reason to stop the music.
+    uint8_t messageArray[16 * 6];
+    for(int channel = 0; channel < 16; channel++)
+    {
+        uint8_t* message = &messageArray[channel * 6];
+        message[0] = uint8_t(0xB0 | channel);
+        message[1] = 123;
+        message[2] = 0;
+        message[3] = uint8_t(0xB0 | channel);
+        message[4] = 64;
+        message[5] = 0;
+    }
+
+    this->port->Send(messageArray, sizeof(messageArray), MidiScheduler::GetTimeNanoseconds());
+}
+
+//------------------------------ MidiManager::Song ------------------------------
+
+MidiManager::Song::Song()
+{
+    this->loadJob = nullptr;
+    this->loaded = false;
+}
+
+/*virtual*/ MidiManager::Song::~Song()
+{
+    delete this->loadJob;
+}
+
+// Note: This is called on a worker thread.  The asset manager is fine with that, and nobody else touches the song until its job is done.
+bool MidiManager::Song::Load(AAssetManager* assetManager)
+{
+    AAsset* songAsset = AAssetManager_open(assetManager, this->filePath.c_str(), AASSET_MODE_BUFFER);
+    if(!songAsset)
+        return false;
+
+    size_t songAssetSize = AAsset_getLength(songAsset);
+    const uint8_t* songAssetBuf = static_cast<const uint8_t*>(AAsset_getBuffer(songAsset));
+    bool success = songAssetBuf && this->timeline.Compile(songAssetBuf, songAssetSize);
+    AAsset_close(songAsset);
+
+    this->loaded.store(success);
+    return success;
+}
+
+bool MidiManager::Song::IsLoading() const
+{
+    return this->loadJob && !this->loadJob->IsFinished();
+}
+
+//------------------------------ MidiManager::AndroidMidiPort ------------------------------
+
+MidiManager::AndroidMidiPort::AndroidMidiPort()
+{
+    this->midiInputPort = nullptr;
+}
+
+/*virtual*/ MidiManager::AndroidMidiPort::~AndroidMidiPort()
+{
+}
+
+/*virtual*/ bool MidiManager::AndroidMidiPort::Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds)
+{
+    if(!this->midiInputPort)
+        return false;
+
+    // The whole batch goes to the device in one go, and the device (not us) waits until the time comes to play it.
+    // If the port can't take it all right now, we'd rather drop the rest than spin here waiting on it.
+    ssize_t numBytesSent = AMidiInputPort_sendWithTimestamp(this->midiInputPort, messageBuf, messageBufSize, timeNanoseconds);
+    return numBytesSent == ssize_t(messageBufSize);
 }
\ No newline at end of file
@@ -2,13 +2,31 @@
 
 #include <game-activity/native_app_glue/android_native_app_glue.h>
 #include <AMidi/AMidi.h>
+#include <atomic>
+#include <list>
 #include <map>
 #include <string>
 #include <vector>
-#include "MidiPlayer.h"
-#include "MidiData.h"
+#include "MidiPort.h"
+#include "MidiScheduler.h"
+#include "MidiTimeline.h"
+#include "JobSystem.h"
 
-class MidiManager : public AudioDataLib::MidiPlayer
+// How far ahead of the music the scheduler thread stays, and how often it wakes up to top that up.
+#define MIDI_SCHEDULER_LOOKAHEAD_SECONDS        0.04
+#define MIDI_SCHEDULER_PERIOD_SECONDS           0.005
+
+// This many compiled songs are kept around, counting the one playing and the one coming up next.
+#define MIDI_SONG_CACHE_SIZE                    4
+
+class MidiSynth;
+
+// The state machine here runs on the main thread, but once a song is going, the playing
+// itself happens on the scheduler's thread, which walks the song's timeline and sends
+// everything on to whichever port we have.  Songs are compiled by jobs, never on the main
+// thread: as soon as one song starts, the next one in the shuffle starts loading, so it's
+// almost always ready long before it's needed.
+class MidiManager : public MidiScheduler::Source
 {
 public:
     MidiManager(android_app* app);
@@ -17,10 +35,42 @@ public:
     void Manage();
     void Abort();
 
-    virtual bool SendMessage(const uint8_t* message, uint64_t messageSize, AudioDataLib::Error& error) override;
+    // If given, songs play through this synthesizer when there's no MIDI device to play them on.
+    void SetSynth(MidiSynth* synth);
+
+    // This has to be given before any song can load, and has to outlive our last call to Abort.
+    void SetJobSystem(JobSystem* jobSystem);
+
+    virtual bool Pump(double untilSeconds, MidiScheduler& scheduler) override;
 
 private:
 
+    class AndroidMidiPort : public MidiPort
+    {
+    public:
+        AndroidMidiPort();
+        virtual ~AndroidMidiPort();
+
+        virtual bool Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds) override;
+
+        AMidiInputPort* midiInputPort;
+    };
+
+    class Song
+    {
+    public:
+        Song();
+        virtual ~Song();
+
+        bool Load(AAssetManager* assetManager);
+        bool IsLoading() const;
+
+        std::string filePath;
+        MidiTimeline timeline;
+        JobSystem::LambdaJob* loadJob;
+        std::atomic<bool> loaded;
+    };
+
     enum State
     {
         INITIAL,
@@ -45,14 +95,28 @@ private:
     State PickWaitTimeBetweenSongsStateHandler();
     State WaitBetweenSongsStateHandler();
 
+    void SendAllNotesOff();
+    Song* FetchSong(const std::string& songFile);
+    void ClearSongCache();
+
     android_app* app;
     State state;
     StateMethodMap stateMethodMap;
     AMidiDevice* midiDevice;
     AMidiInputPort* midiInputPort;
+    MidiSynth* synth;
+    AndroidMidiPort androidMidiPort;
+    SynthMidiPort synthMidiPort;
+    MidiPort* port;
+    MidiScheduler scheduler;
+    JobSystem* jobSystem;
     std::vector<std::string> shuffledSongArray;
     int nextSongOffset;
-    AudioDataLib::MidiData* currentMidiData;
+
+    // The most recently used song is at the front.  The song playing is never evicted, and neither is one still loading.
+    std::list<Song*> songCacheList;
+    Song* playingSong;
+    size_t timelineCursor;
     double waitTimeBetweenSongsSeconds;
-    clock_t waitTimeBegin;
+    int64_t waitTimeBeginNanoseconds;
 };
\ No newline at end of file
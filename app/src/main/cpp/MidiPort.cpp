@@ -0,0 +1,55 @@
+#include "MidiPort.h"
+#include "MidiSynth.h"
+#include "MidiScheduler.h"
+
+//------------------------------ MidiPort ------------------------------
+
+MidiPort::MidiPort()
+{
+}
+
+/*virtual*/ MidiPort::~MidiPort()
+{
+}
+
+//------------------------------ SynthMidiPort ------------------------------
+
+SynthMidiPort::SynthMidiPort()
+{
+    this->synth = nullptr;
+}
+
+/*virtual*/ SynthMidiPort::~SynthMidiPort()
+{
+}
+
+/*virtual*/ bool SynthMidiPort::Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds)
+{
+    if(!this->synth)
+        return false;
+
+    return this->synth->SendMessage(messageBuf, messageBufSize, timeNanoseconds);
+}
+
+//------------------------------ RecordingMidiPort ------------------------------
+
+RecordingMidiPort::RecordingMidiPort()
+{
+}
+
+/*virtual*/ RecordingMidiPort::~RecordingMidiPort()
+{
+}
+
+/*virtual*/ bool RecordingMidiPort::Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds)
+{
+    Record record{};
+    record.timeNanoseconds = timeNanoseconds;
+    record.sentNanoseconds = MidiScheduler::GetTimeNanoseconds();
+    record.messageOffset = this->messageArray.size();
+    record.messageSize = messageBufSize;
+    this->recordArray.push_back(record);
+
+    this->messageArray.insert(this->messageArray.end(), messageBuf, messageBuf + messageBufSize);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+class MidiSynth;
+
+// This is wherever MIDI messages end up: a device, our own synthesizer, or (for testing) a
+// recording.  Messages come in batches of whole messages that are all meant to be played at
+// the same time, given in nanoseconds on the monotonic clock.  That time is usually a little
+// in the future, and the port is expected to hold on to them until then.
+class MidiPort
+{
+public:
+    MidiPort();
+    virtual ~MidiPort();
+
+    virtual bool Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds) = 0;
+};
+
+//------------------------------ SynthMidiPort ------------------------------
+
+class SynthMidiPort : public MidiPort
+{
+public:
+    SynthMidiPort();
+    virtual ~SynthMidiPort();
+
+    virtual bool Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds) override;
+
+    MidiSynth* synth;
+};
+
+//------------------------------ RecordingMidiPort ------------------------------
+
+// This just writes down what it was sent, and when, so that we can see how well the
+// scheduler keeps time without any device or audio involved.
+class RecordingMidiPort : public MidiPort
+{
+public:
+    RecordingMidiPort();
+    virtual ~RecordingMidiPort();
+
+    virtual bool Send(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds) override;
+
+    struct Record
+    {
+        int64_t timeNanoseconds;
+        int64_t sentNanoseconds;
+        size_t messageOffset;
+        size_t messageSize;
+    };
+
+    // These may only be looked at while nothing is sending.
+    std::vector<Record> recordArray;
+    std::vector<uint8_t> messageArray;
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "MidiScheduler.h"
+#include "MidiPort.h"
+#include <time.h>
+
+MidiScheduler::MidiScheduler()
+{
+    this->source = nullptr;
+    this->port = nullptr;
+    this->lookaheadNanoseconds = 0;
+    this->periodNanoseconds = 0;
+    this->startTimeNanoseconds = 0;
+    this->threadHandle = 0;
+    this->keepRunning = false;
+    this->finished = false;
+    this->batchTimeNanoseconds = 0;
+    this->sentCount = 0;
+    this->lateCount = 0;
+    this->failedCount = 0;
+}
+
+/*virtual*/ MidiScheduler::~MidiScheduler()
+{
+    this->Stop();
+}
+
+/*static*/ int64_t MidiScheduler::GetTimeNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000000000 + int64_t(now.tv_nsec);
+}
+
+bool MidiScheduler::Start(Source* source, MidiPort* port, double lookaheadSeconds, double periodSeconds)
+{
+    if(this->threadHandle != 0 || !source || !port || lookaheadSeconds <= 0.0 || periodSeconds <= 0.0)
+        return false;
+
+    this->source = source;
+    this->port = port;
+    this->lookaheadNanoseconds = int64_t(lookaheadSeconds * 1e9);
+    this->periodNanoseconds = int64_t(periodSeconds * 1e9);
+    this->startTimeNanoseconds = GetTimeNanoseconds() + this->lookaheadNanoseconds;
+    this->batchArray.clear();
+    this->keepRunning = true;
+    this->finished = false;
+    this->sentCount = 0;
+    this->lateCount = 0;
+    this->failedCount = 0;
+
+    if(0 != pthread_create(&this->threadHandle, nullptr, &MidiScheduler::ThreadEntryPoint, this))
+    {
+        this->threadHandle = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void MidiScheduler::Stop()
+{
+    this->keepRunning = false;
+
+    if(this->threadHandle)
+    {
+        pthread_join(this->threadHandle, nullptr);
+        this->threadHandle = 0;
+    }
+
+    this->source = nullptr;
+    this->port = nullptr;
+}
+
+/*static*/ void* MidiScheduler::ThreadEntryPoint(void* arg)
+{
+    auto scheduler = static_cast<MidiScheduler*>(arg);
+    scheduler->ThreadFunc();
+    return nullptr;
+}
+
+void MidiScheduler::ThreadFunc()
+{
+    int64_t wakeTimeNanoseconds = GetTimeNanoseconds();
+
+    while(this->keepRunning)
+    {
+        int64_t nowNanoseconds = GetTimeNanoseconds();
+        double untilSeconds = double(nowNanoseconds + this->lookaheadNanoseconds - this->startTimeNanoseconds) / 1e9;
+
+        bool morePending = this->source->Pump(untilSeconds, *this);
+        this->Flush();
+
+        if(!morePending)
+        {
+            this->finished = true;
+            break;
+        }
+
+        // We sleep until an absolute time so that the time spent pumping doesn't push every wake-up later.  If we
+        // overslept by more than a period, though, there's no use trying to catch up on the ones we missed.
+        wakeTimeNanoseconds += this->periodNanoseconds;
+        if(wakeTimeNanoseconds < nowNanoseconds)
+            wakeTimeNanoseconds = nowNanoseconds + this->periodNanoseconds;
+
+        struct timespec wakeTime;
+        wakeTime.tv_sec = time_t(wakeTimeNanoseconds / 1000000000);
+        wakeTime.tv_nsec = long(wakeTimeNanoseconds % 1000000000);
+        while(::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, nullptr) != 0 && this->keepRunning)
+        {
+        }
+    }
+}
+
+void MidiScheduler::AddEvent(double timeSeconds, const uint8_t* messageBuf, size_t messageBufSize)
+{
+    int64_t timeNanoseconds = this->startTimeNanoseconds + int64_t(timeSeconds * 1e9);
+    if(this->batchArray.size() > 0 && timeNanoseconds != this->batchTimeNanoseconds)
+        this->Flush();
+
+    this->batchTimeNanoseconds = timeNanoseconds;
+    this->batchArray.insert(this->batchArray.end(), messageBuf, messageBuf + messageBufSize);
+}
+
+void MidiScheduler::Flush()
+{
+    if(this->batchArray.size() == 0)
+        return;
+
+    if(this->batchTimeNanoseconds < GetTimeNanoseconds())
+        this->lateCount++;
+
+    if(this->port->Send(this->batchArray.data(), this->batchArray.size(), this->batchTimeNanoseconds))
+        this->sentCount++;
+    else
+        this->failedCount++;
+
+    this->batchArray.clear();
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <atomic>
+#include <vector>
+
+class MidiPort;
+
+// This plays a song out to a MIDI port from its own thread, so that note timing has nothing
+// to do with how long frames take to render.  The thread wakes up on a fixed period, pulls
+// every event from the song that falls within a short lookahead window, and sends them out
+// stamped with exactly when they should play.  Events that share a time go out together in
+// one send.  As long as the thread wakes up at least once per lookahead, nothing is late, and
+// the port (a device, or our own synthesizer) takes care of the rest of the timing.
+//
+// The song starts playing one lookahead after Start is called.
+class MidiScheduler
+{
+public:
+    MidiScheduler();
+    virtual ~MidiScheduler();
+
+    // This is where the events come from.  It's only ever pumped from the scheduler's thread.
+    class Source
+    {
+    public:
+        virtual ~Source() {}
+
+        // Give the scheduler (via AddEvent) every event at or before the given song time that it hasn't had yet, in order.
+        // Return false when there's nothing left to play.
+        virtual bool Pump(double untilSeconds, MidiScheduler& scheduler) = 0;
+    };
+
+    bool Start(Source* source, MidiPort* port, double lookaheadSeconds, double periodSeconds);
+    void Stop();
+
+    // This may only be called from within Pump.  The message buffer must hold whole messages.
+    void AddEvent(double timeSeconds, const uint8_t* messageBuf, size_t messageBufSize);
+
+    // A song is finished once its source has run dry and everything has been sent.
+    bool IsRunning() const { return this->threadHandle != 0; }
+    bool IsFinished() const { return this->finished.load(); }
+
+    uint32_t GetSentCount() const { return this->sentCount.load(); }
+    uint32_t GetLateCount() const { return this->lateCount.load(); }
+    uint32_t GetFailedCount() const { return this->failedCount.load(); }
+
+    static int64_t GetTimeNanoseconds();
+
+private:
+    static void* ThreadEntryPoint(void* arg);
+    void ThreadFunc();
+    void Flush();
+
+    Source* source;
+    MidiPort* port;
+    int64_t lookaheadNanoseconds;
+    int64_t periodNanoseconds;
+    int64_t startTimeNanoseconds;
+
+    pthread_t threadHandle;
+    std::atomic<bool> keepRunning;
+    std::atomic<bool> finished;
+
+    // These collect events that share a time until they can all be sent together.
+    std::vector<uint8_t> batchArray;
+    int64_t batchTimeNanoseconds;
+
+    std::atomic<uint32_t> sentCount;
+    std::atomic<uint32_t> lateCount;
+    std::atomic<uint32_t> failedCount;
+};
\ No newline at end of file
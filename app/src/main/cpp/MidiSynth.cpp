@@ -0,0 +1,695 @@
+#include "MidiSynth.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#define MIDI_SYNTH_PERCUSSION_CHANNEL   9
+#define MIDI_SYNTH_LOWEST_BAND_HZ       20.0        // Band b holds fundamentals up to this times 2^(b+1).
+#define MIDI_SYNTH_MAX_HARMONICS        48
+#define MIDI_SYNTH_HARMONIC_MARGIN      0.8         // Leaves room under Nyquist for a pitch bend up.
+#define MIDI_SYNTH_MASTER_GAIN          0.2f
+#define MIDI_SYNTH_PITCH_BEND_RANGE     2.0         // In semitones, which is the General MIDI default.
+#define MIDI_SYNTH_PHASE_SHIFT          (32 - MIDI_SYNTH_TABLE_BITS)
+#define MIDI_SYNTH_PHASE_MASK           ((1u << MIDI_SYNTH_PHASE_SHIFT) - 1)
+
+//------------------------------ MidiSynth ------------------------------
+
+MidiSynth::MidiSynth()
+{
+    this->framesPerSecond = 0;
+    this->numChannels = 0;
+    this->numActiveVoices = 0;
+    this->nextStartOrder = 0;
+    this->runningStatus = 0;
+    this->activeVoiceCount = 0;
+    this->droppedCount = 0;
+    this->stolenCount = 0;
+    this->ResetChannels();
+}
+
+/*virtual*/ MidiSynth::~MidiSynth()
+{
+}
+
+bool MidiSynth::Setup(uint32_t framesPerSecond, uint32_t numChannels, uint32_t maxVoices)
+{
+    if(framesPerSecond == 0 || numChannels == 0 || maxVoices == 0)
+        return false;
+
+    // A busy song can send a good few messages between callbacks, so we leave plenty of room.
+    if(!this->messageQueue.Setup(1024))
+        return false;
+
+    this->framesPerSecond = framesPerSecond;
+    this->numChannels = numChannels;
+
+    this->voiceArray.resize(maxVoices);
+    this->numActiveVoices = 0;
+    this->nextStartOrder = 0;
+    this->voiceBuffer.resize(MIDI_SYNTH_BLOCK_FRAMES);
+
+    this->BuildTables();
+    this->ResetChannels();
+
+    this->runningStatus = 0;
+    this->activeVoiceCount = 0;
+    this->droppedCount = 0;
+    this->stolenCount = 0;
+    return true;
+}
+
+void MidiSynth::Shutdown()
+{
+    this->voiceArray.clear();
+    this->numActiveVoices = 0;
+    this->activeVoiceCount = 0;
+    this->waveTableArray.clear();
+    this->noiseTableArray.clear();
+}
+
+void MidiSynth::BuildTables()
+{
+    const uint32_t tableStride = MIDI_SYNTH_TABLE_SIZE + 1;
+
+    // Every harmonic of a table is just the sine table read at a multiple of the rate, so we never call sin() more than once a sample.
+    std::vector<float> sineArray(MIDI_SYNTH_TABLE_SIZE);
+    for(uint32_t i = 0; i < MIDI_SYNTH_TABLE_SIZE; i++)
+        sineArray[i] = float(::sin(2.0 * M_PI * double(i) / double(MIDI_SYNTH_TABLE_SIZE)));
+
+    this->waveTableArray.resize(NUM_WAVEFORMS * MIDI_SYNTH_NUM_BANDS * tableStride);
+    std::vector<double> sumArray(MIDI_SYNTH_TABLE_SIZE);
+
+    for(int waveform = 0; waveform < NUM_WAVEFORMS; waveform++)
+    {
+        for(int band = 0; band < MIDI_SYNTH_NUM_BANDS; band++)
+        {
+            double bandTopFrequency = MIDI_SYNTH_LOWEST_BAND_HZ * double(1 << (band + 1));
+            auto numHarmonics = int(MIDI_SYNTH_HARMONIC_MARGIN * 0.5 * double(this->framesPerSecond) / bandTopFrequency);
+            numHarmonics = (numHarmonics < 1) ? 1 : ((numHarmonics > MIDI_SYNTH_MAX_HARMONICS) ? MIDI_SYNTH_MAX_HARMONICS : numHarmonics);
+
+            std::fill(sumArray.begin(), sumArray.end(), 0.0);
+            for(int harmonic = 1; harmonic <= numHarmonics; harmonic++)
+            {
+                double amplitude = 0.0;
+                switch(waveform)
+                {
+                    case SINE:
+                        amplitude = (harmonic == 1) ? 1.0 : 0.0;
+                        break;
+                    case MELLOW:
+                        amplitude = (harmonic <= 8) ? 1.0 / double(harmonic * harmonic) : 0.0;
+                        break;
+                    case BRIGHT:
+                        amplitude = 1.0 / double(harmonic);
+                        break;
+                    case HOLLOW:
+                        amplitude = (harmonic & 1) ? 1.0 / double(harmonic) : 0.0;
+                        break;
+                }
+
+                if(amplitude == 0.0)
+                    continue;
+
+                for(uint32_t i = 0; i < MIDI_SYNTH_TABLE_SIZE; i++)
+                    sumArray[i] += amplitude * sineArray[(uint64_t(i) * harmonic) & (MIDI_SYNTH_TABLE_SIZE - 1)];
+            }
+
+            double peak = 0.0;
+            for(double sum : sumArray)
+                peak = (::fabs(sum) > peak) ? ::fabs(sum) : peak;
+
+            float* tableBuf = &this->waveTableArray[(waveform * MIDI_SYNTH_NUM_BANDS + band) * tableStride];
+            for(uint32_t i = 0; i < MIDI_SYNTH_TABLE_SIZE; i++)
+                tableBuf[i] = float(sumArray[i] / peak);
+            tableBuf[MIDI_SYNTH_TABLE_SIZE] = tableBuf[0];
+        }
+    }
+
+    // The noise doesn't need to be very random; it just needs to not sound pitched when it loops.
+    this->noiseTableArray.resize(tableStride);
+    uint32_t state = 0x12345678;
+    for(uint32_t i = 0; i < MIDI_SYNTH_TABLE_SIZE; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        this->noiseTableArray[i] = float(int32_t(state)) / 2147483648.0f;
+    }
+    this->noiseTableArray[MIDI_SYNTH_TABLE_SIZE] = this->noiseTableArray[0];
+}
+
+void MidiSynth::ResetChannels()
+{
+    for(Channel& channel : this->channelArray)
+    {
+        channel.program = 0;
+        channel.volume = 100.0f / 127.0f;
+        channel.expression = 1.0f;
+        channel.leftGain = float(M_SQRT1_2);
+        channel.rightGain = float(M_SQRT1_2);
+        channel.pitchBendFactor = 1.0f;
+        channel.sustainPedal = false;
+    }
+}
+
+bool MidiSynth::SendMessage(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds /*= 0*/)
+{
+    bool success = true;
+
+    size_t i = 0;
+    while(i < messageBufSize)
+    {
+        uint8_t status = messageBuf[i];
+        if(status & 0x80)
+        {
+            i++;
+
+            // System messages (and system exclusive data) are of no interest to us, and they cancel running status.
+            if(status >= 0xF0)
+            {
+                this->runningStatus = 0;
+                if(status == 0xF0)
+                {
+                    while(i < messageBufSize && messageBuf[i] != 0xF7)
+                        i++;
+                    i++;
+                }
+                continue;
+            }
+
+            this->runningStatus = status;
+        }
+        else if(this->runningStatus == 0)
+        {
+            // A stray data byte with no status to go with it.
+            i++;
+            continue;
+        }
+
+        Message message{};
+        message.timeNanoseconds = timeNanoseconds;
+        message.byteArray[0] = this->runningStatus;
+        uint8_t numDataBytes = ((this->runningStatus & 0xF0) == 0xC0 || (this->runningStatus & 0xF0) == 0xD0) ? 1 : 2;
+        if(i + numDataBytes > messageBufSize)
+            break;
+
+        for(uint8_t j = 0; j < numDataBytes; j++)
+            message.byteArray[1 + j] = messageBuf[i++] & 0x7F;
+        message.size = 1 + numDataBytes;
+
+        if(!this->messageQueue.Push(message))
+        {
+            this->droppedCount++;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+bool MidiSynth::Reset()
+{
+    this->runningStatus = 0;
+
+    Message message{};
+    message.size = 0;
+    if(!this->messageQueue.Push(message))
+    {
+        this->droppedCount++;
+        return false;
+    }
+
+    return true;
+}
+
+void MidiSynth::ExecuteMessages(int64_t untilNanoseconds)
+{
+    Message message;
+    while(this->messageQueue.Peek(message) && message.timeNanoseconds <= untilNanoseconds)
+    {
+        this->messageQueue.Pop(message);
+        this->ExecuteMessage(message);
+    }
+}
+
+void MidiSynth::ExecuteMessage(const Message& message)
+{
+    if(message.size == 0)
+    {
+        this->numActiveVoices = 0;
+        this->ResetChannels();
+        return;
+    }
+
+    uint8_t channel = message.byteArray[0] & 0x0F;
+    switch(message.byteArray[0] & 0xF0)
+    {
+        case 0x80:
+        {
+            this->NoteOff(channel, message.byteArray[1]);
+            break;
+        }
+        case 0x90:
+        {
+            // A note-on with no velocity is how a lot of files say note-off.
+            if(message.byteArray[2] == 0)
+                this->NoteOff(channel, message.byteArray[1]);
+            else
+                this->NoteOn(channel, message.byteArray[1], message.byteArray[2]);
+            break;
+        }
+        case 0xB0:
+        {
+            this->ControlChange(channel, message.byteArray[1], message.byteArray[2]);
+            break;
+        }
+        case 0xC0:
+        {
+            this->channelArray[channel].program = message.byteArray[1];
+            break;
+        }
+        case 0xE0:
+        {
+            int bend = int(message.byteArray[1] | (message.byteArray[2] << 7)) - 8192;
+            double semitones = MIDI_SYNTH_PITCH_BEND_RANGE * double(bend) / 8192.0;
+            this->channelArray[channel].pitchBendFactor = float(::pow(2.0, semitones / 12.0));
+            break;
+        }
+    }
+}
+
+void MidiSynth::NoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
+{
+    const Patch* patch = nullptr;
+    const float* tableBuf = nullptr;
+    double frequency = 0.0;
+
+    if(channel == MIDI_SYNTH_PERCUSSION_CHANNEL)
+    {
+        bool useNoise = false;
+        patch = GetDrumPatch(note, frequency, useNoise);
+        if(!patch)
+            return;
+
+        tableBuf = useNoise ? this->noiseTableArray.data() : this->FindTable(patch->waveform, frequency);
+    }
+    else
+    {
+        patch = GetMelodicPatch(this->channelArray[channel].program);
+        frequency = 440.0 * ::pow(2.0, (double(note) - 69.0) / 12.0);
+        tableBuf = this->FindTable(patch->waveform, frequency);
+    }
+
+    // If the key is already sounding, we just start it over rather than pile up another voice on it.
+    Voice* voice = nullptr;
+    for(uint32_t i = 0; i < this->numActiveVoices; i++)
+    {
+        Voice& activeVoice = this->voiceArray[i];
+        if(activeVoice.channel == channel && activeVoice.note == note)
+        {
+            voice = &activeVoice;
+            break;
+        }
+    }
+
+    if(!voice)
+    {
+        voice = this->AllocateVoice();
+        voice->phase = 0;
+        voice->level = 0.0f;
+    }
+
+    auto framesPerSecond = float(this->framesPerSecond);
+    float normalizedVelocity = float(velocity) / 127.0f;
+
+    voice->tableBuf = tableBuf;
+    voice->basePhaseIncrement = uint32_t(frequency / double(this->framesPerSecond) * 4294967296.0);
+    voice->channel = channel;
+    voice->note = note;
+    voice->keyDown = true;
+    voice->stage = EnvelopeStage::ATTACK;
+    voice->attackRate = 1.0f / (patch->attackSeconds * framesPerSecond);
+    voice->decayRate = (1.0f - patch->sustainLevel) / (patch->decaySeconds * framesPerSecond);
+    voice->sustainLevel = patch->sustainLevel;
+    voice->releaseRate = 1.0f / (patch->releaseSeconds * framesPerSecond);
+    voice->velocityGain = normalizedVelocity * normalizedVelocity * patch->gain;
+    voice->startOrder = this->nextStartOrder++;
+}
+
+void MidiSynth::NoteOff(uint8_t channel, uint8_t note)
+{
+    // Drums just ring out.
+    if(channel == MIDI_SYNTH_PERCUSSION_CHANNEL)
+        return;
+
+    for(uint32_t i = 0; i < this->numActiveVoices; i++)
+    {
+        Voice& voice = this->voiceArray[i];
+        if(voice.channel == channel && voice.note == note && voice.keyDown)
+        {
+            voice.keyDown = false;
+            if(!this->channelArray[channel].sustainPedal)
+                this->ReleaseVoice(voice);
+        }
+    }
+}
+
+void MidiSynth::ReleaseVoice(Voice& voice) const
+{
+    if(voice.stage != EnvelopeStage::DONE)
+        voice.stage = EnvelopeStage::RELEASE;
+}
+
+void MidiSynth::ControlChange(uint8_t channel, uint8_t controller, uint8_t value)
+{
+    Channel& channelState = this->channelArray[channel];
+
+    switch(controller)
+    {
+        case 7:
+        {
+            channelState.volume = float(value) / 127.0f;
+            break;
+        }
+        case 10:
+        {
+            // This is an equal-power pan, so a sound doesn't get quieter in the middle.
+            double angle = 0.5 * M_PI * double(value) / 127.0;
+            channelState.leftGain = float(::cos(angle));
+            channelState.rightGain = float(::sin(angle));
+            break;
+        }
+        case 11:
+        {
+            channelState.expression = float(value) / 127.0f;
+            break;
+        }
+        case 64:
+        {
+            channelState.sustainPedal = (value >= 64);
+            if(!channelState.sustainPedal)
+            {
+                for(uint32_t i = 0; i < this->numActiveVoices; i++)
+                {
+                    Voice& voice = this->voiceArray[i];
+                    if(voice.channel == channel && !voice.keyDown)
+                        this->ReleaseVoice(voice);
+                }
+            }
+            break;
+        }
+        case 120:
+        {
+            // All sound off.  Unlike all notes off, this doesn't wait for the release.
+            for(uint32_t i = 0; i < this->numActiveVoices; i++)
+                if(this->voiceArray[i].channel == channel)
+                    this->voiceArray[i].stage = EnvelopeStage::DONE;
+            break;
+        }
+        case 121:
+        {
+            channelState.expression = 1.0f;
+            channelState.pitchBendFactor = 1.0f;
+            channelState.sustainPedal = false;
+            break;
+        }
+        case 123:
+        {
+            for(uint32_t i = 0; i < this->numActiveVoices; i++)
+            {
+                Voice& voice = this->voiceArray[i];
+                if(voice.channel == channel)
+                {
+                    voice.keyDown = false;
+                    this->ReleaseVoice(voice);
+                }
+            }
+            break;
+        }
+    }
+}
+
+MidiSynth::Voice* MidiSynth::AllocateVoice()
+{
+    if(this->numActiveVoices < this->voiceArray.size())
+        return &this->voiceArray[this->numActiveVoices++];
+
+    // Every voice is busy.  The quietest voice that's already on its way out is the one we'd miss the least,
+    // and failing that, the oldest one, which has most likely decayed the most.
+    Voice* stolenVoice = nullptr;
+    for(uint32_t i = 0; i < this->numActiveVoices; i++)
+    {
+        Voice* voice = &this->voiceArray[i];
+        if(voice->stage == EnvelopeStage::RELEASE || voice->stage == EnvelopeStage::DONE)
+        {
+            if(!stolenVoice || voice->level < stolenVoice->level)
+                stolenVoice = voice;
+        }
+    }
+
+    if(!stolenVoice)
+    {
+        stolenVoice = &this->voiceArray[0];
+        for(uint32_t i = 1; i < this->numActiveVoices; i++)
+            if(int32_t(this->voiceArray[i].startOrder - stolenVoice->startOrder) < 0)
+                stolenVoice = &this->voiceArray[i];
+    }
+
+    this->stolenCount++;
+    return stolenVoice;
+}
+
+const float* MidiSynth::FindTable(Waveform waveform, double frequency) const
+{
+    int band = 0;
+    double bandTopFrequency = MIDI_SYNTH_LOWEST_BAND_HZ * 2.0;
+    while(band < MIDI_SYNTH_NUM_BANDS - 1 && frequency > bandTopFrequency)
+    {
+        band++;
+        bandTopFrequency *= 2.0;
+    }
+
+    return &this->waveTableArray[(waveform * MIDI_SYNTH_NUM_BANDS + band) * (MIDI_SYNTH_TABLE_SIZE + 1)];
+}
+
+void MidiSynth::AdvanceEnvelope(Voice& voice, uint32_t numFrames) const
+{
+    auto elapsed = float(numFrames);
+
+    switch(voice.stage)
+    {
+        case EnvelopeStage::ATTACK:
+        {
+            voice.level += voice.attackRate * elapsed;
+            if(voice.level >= 1.0f)
+            {
+                voice.level = 1.0f;
+                voice.stage = EnvelopeStage::DECAY;
+            }
+            break;
+        }
+        case EnvelopeStage::DECAY:
+        {
+            voice.level -= voice.decayRate * elapsed;
+            if(voice.level <= voice.sustainLevel)
+            {
+                voice.level = voice.sustainLevel;
+                voice.stage = (voice.sustainLevel > 0.0f) ? EnvelopeStage::SUSTAIN : EnvelopeStage::DONE;
+            }
+            break;
+        }
+        case EnvelopeStage::SUSTAIN:
+        {
+            break;
+        }
+        case EnvelopeStage::RELEASE:
+        {
+            voice.level -= voice.releaseRate * elapsed;
+            if(voice.level <= 0.0f)
+            {
+                voice.level = 0.0f;
+                voice.stage = EnvelopeStage::DONE;
+            }
+            break;
+        }
+        case EnvelopeStage::DONE:
+        {
+            voice.level = 0.0f;
+            break;
+        }
+    }
+}
+
+void MidiSynth::Render(float* mixBuf, uint32_t numFrames)
+{
+    // We take the time the callback started as the time of its first frame, and count forward from there, so a
+    // message takes effect at the start of the block it falls in.  The output latency is the same for every
+    // block, so it doesn't make the timing any less even.
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t renderTimeNanoseconds = int64_t(now.tv_sec) * 1000000000 + int64_t(now.tv_nsec);
+    uint32_t numFramesRendered = 0;
+
+    while(numFrames > 0)
+    {
+        this->ExecuteMessages(renderTimeNanoseconds + int64_t(numFramesRendered) * 1000000000 / this->framesPerSecond);
+
+        uint32_t numBlockFrames = (numFrames < MIDI_SYNTH_BLOCK_FRAMES) ? numFrames : MIDI_SYNTH_BLOCK_FRAMES;
+        this->RenderBlock(mixBuf, numBlockFrames);
+        mixBuf += numBlockFrames * this->numChannels;
+        numFrames -= numBlockFrames;
+        numFramesRendered += numBlockFrames;
+    }
+
+    this->activeVoiceCount.store(this->numActiveVoices);
+}
+
+void MidiSynth::RenderBlock(float* mixBuf, uint32_t numFrames)
+{
+    float* voiceBuf = this->voiceBuffer.data();
+    uint32_t numChannels = this->numChannels;
+
+    uint32_t i = 0;
+    while(i < this->numActiveVoices)
+    {
+        Voice& voice = this->voiceArray[i];
+        const Channel& channel = this->channelArray[voice.channel];
+
+        // The gain ramps from where the envelope is now to where it'll be at the end of the block.
+        float gainScale = voice.velocityGain * channel.volume * channel.expression * MIDI_SYNTH_MASTER_GAIN;
+        float startGain = voice.level * gainScale;
+        this->AdvanceEnvelope(voice, numFrames);
+        float endGain = voice.level * gainScale;
+        float gainStep = (endGain - startGain) / float(numFrames);
+
+        // The table lookups can't be vectorized, but they're cheap, and everything after them can be.
+        const float* tableBuf = voice.tableBuf;
+        uint32_t phase = voice.phase;
+        uint32_t phaseIncrement = uint32_t(float(voice.basePhaseIncrement) * ((voice.channel == MIDI_SYNTH_PERCUSSION_CHANNEL) ? 1.0f : channel.pitchBendFactor));
+        for(uint32_t j = 0; j < numFrames; j++)
+        {
+            uint32_t k = phase >> MIDI_SYNTH_PHASE_SHIFT;
+            float fraction = float(phase & MIDI_SYNTH_PHASE_MASK) * (1.0f / float(1u << MIDI_SYNTH_PHASE_SHIFT));
+            voiceBuf[j] = tableBuf[k] + (tableBuf[k + 1] - tableBuf[k]) * fraction;
+            phase += phaseIncrement;
+        }
+        voice.phase = phase;
+
+        for(uint32_t j = 0; j < numFrames; j++)
+            voiceBuf[j] *= startGain + gainStep * float(j);
+
+        if(numChannels == 1)
+        {
+            for(uint32_t j = 0; j < numFrames; j++)
+                mixBuf[j] += voiceBuf[j];
+        }
+        else
+        {
+            // Anything past the first two channels is left alone.
+            float leftGain = channel.leftGain;
+            float rightGain = channel.rightGain;
+            for(uint32_t j = 0; j < numFrames; j++)
+            {
+                mixBuf[j * numChannels] += voiceBuf[j] * leftGain;
+                mixBuf[j * numChannels + 1] += voiceBuf[j] * rightGain;
+            }
+        }
+
+        // A finished voice is replaced by the last active one, so don't advance past it.
+        if(voice.stage == EnvelopeStage::DONE)
+            voice = this->voiceArray[--this->numActiveVoices];
+        else
+            i++;
+    }
+}
+
+// These are picked by General MIDI instrument family, which is the program number divided by eight.
+// None of them are faithful, but each family at least sounds different from its neighbors.
+/*static*/ const MidiSynth::Patch* MidiSynth::GetMelodicPatch(uint8_t program)
+{
+    static const Patch pianoPatch{MELLOW, 0.002f, 1.5f, 0.0f, 0.2f, 1.0f};
+    static const Patch chromaticPercussionPatch{SINE, 0.001f, 0.6f, 0.0f, 0.2f, 1.0f};
+    static const Patch organPatch{MELLOW, 0.01f, 0.05f, 1.0f, 0.05f, 0.7f};
+    static const Patch guitarPatch{BRIGHT, 0.002f, 1.0f, 0.0f, 0.1f, 0.8f};
+    static const Patch bassPatch{MELLOW, 0.002f, 0.8f, 0.4f, 0.08f, 1.0f};
+    static const Patch stringsPatch{BRIGHT, 0.08f, 0.2f, 0.8f, 0.3f, 0.6f};
+    static const Patch ensemblePatch{BRIGHT, 0.1f, 0.2f, 0.8f, 0.4f, 0.6f};
+    static const Patch brassPatch{BRIGHT, 0.03f, 0.1f, 0.8f, 0.1f, 0.7f};
+    static const Patch reedPatch{HOLLOW, 0.02f, 0.1f, 0.8f, 0.08f, 0.7f};
+    static const Patch pipePatch{SINE, 0.03f, 0.1f, 0.9f, 0.1f, 0.9f};
+    static const Patch leadPatch{HOLLOW, 0.005f, 0.1f, 0.8f, 0.1f, 0.6f};
+    static const Patch padPatch{MELLOW, 0.3f, 0.5f, 0.7f, 0.6f, 0.7f};
+    static const Patch effectsPatch{BRIGHT, 0.2f, 0.5f, 0.6f, 0.5f, 0.5f};
+    static const Patch ethnicPatch{MELLOW, 0.002f, 0.8f, 0.0f, 0.2f, 0.9f};
+    static const Patch percussivePatch{SINE, 0.001f, 0.4f, 0.0f, 0.1f, 1.0f};
+    static const Patch soundEffectsPatch{SINE, 0.01f, 0.3f, 0.5f, 0.2f, 0.5f};
+
+    static const Patch* const familyPatchArray[16] =
+    {
+        &pianoPatch, &chromaticPercussionPatch, &organPatch, &guitarPatch,
+        &bassPatch, &stringsPatch, &ensemblePatch, &brassPatch,
+        &reedPatch, &pipePatch, &leadPatch, &padPatch,
+        &effectsPatch, &ethnicPatch, &percussivePatch, &soundEffectsPatch
+    };
+
+    return familyPatchArray[(program & 0x7F) / 8];
+}
+
+/*static*/ const MidiSynth::Patch* MidiSynth::GetDrumPatch(uint8_t note, double& frequency, bool& useNoise)
+{
+    static const Patch kickPatch{SINE, 0.002f, 0.25f, 0.0f, 0.05f, 1.2f};
+    static const Patch tomPatch{SINE, 0.002f, 0.35f, 0.0f, 0.05f, 0.9f};
+    static const Patch snarePatch{SINE, 0.001f, 0.15f, 0.0f, 0.05f, 0.6f};
+    static const Patch closedHatPatch{SINE, 0.001f, 0.05f, 0.0f, 0.02f, 0.3f};
+    static const Patch openHatPatch{SINE, 0.001f, 0.3f, 0.0f, 0.05f, 0.3f};
+    static const Patch cymbalPatch{SINE, 0.002f, 0.9f, 0.0f, 0.1f, 0.3f};
+    static const Patch otherPatch{SINE, 0.001f, 0.1f, 0.0f, 0.05f, 0.4f};
+
+    // Noise is played back at a rate that depends on the note, so higher drums come out brighter.
+    frequency = 20.0 * ::pow(2.0, (double(note) - 35.0) / 24.0);
+    useNoise = true;
+
+    switch(note)
+    {
+        case 35:
+        case 36:
+        {
+            frequency = 55.0;
+            useNoise = false;
+            return &kickPatch;
+        }
+        case 41:
+        case 43:
+        case 45:
+        case 47:
+        case 48:
+        case 50:
+        {
+            // The toms go up in pitch with the note, from floor tom to high tom.
+            frequency = 80.0 * ::pow(2.0, (double(note) - 41.0) / 9.0);
+            useNoise = false;
+            return &tomPatch;
+        }
+        case 38:
+        case 40:
+            return &snarePatch;
+        case 42:
+        case 44:
+            return &closedHatPatch;
+        case 46:
+            return &openHatPatch;
+        case 49:
+        case 51:
+        case 52:
+        case 55:
+        case 57:
+        case 59:
+            return &cymbalPatch;
+    }
+
+    if(note < 27 || note > 87)
+        return nullptr;
+
+    return &otherPatch;
+}
\ No newline at end of file
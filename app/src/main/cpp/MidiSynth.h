@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "AudioMixer.h"
+#include "RingBuffer.h"
+
+#define MIDI_SYNTH_NUM_CHANNELS         16
+#define MIDI_SYNTH_TABLE_BITS           10
+#define MIDI_SYNTH_TABLE_SIZE           (1 << MIDI_SYNTH_TABLE_BITS)
+#define MIDI_SYNTH_NUM_BANDS            10
+#define MIDI_SYNTH_BLOCK_FRAMES         32
+
+// This is a small synthesizer for when there's no MIDI device to play our songs on.  It's
+// nothing like a real General MIDI synth; each instrument family gets one of a handful of
+// wavetables and an ADSR envelope, and the drums are sine thumps and filtered-ish noise.
+// But it's cheap, and it sounds like music.  The wavetables are built once in Setup, one
+// per octave band with only as many harmonics as that band can hold below Nyquist, so
+// high notes don't alias.  Envelopes, volume and pan are worked out once per short block,
+// and applied as a linear ramp across it, so the per-sample loops are simple enough for
+// the compiler to vectorize.  The number of voices is fixed; when they're all busy, a new
+// note steals whichever one we'd miss the least.
+//
+// Like the mixer, MIDI messages come in through a lock-free queue from exactly one thread,
+// and everything else happens in the audio callback, where the mixer calls Render.  Each
+// message can say when (on the monotonic clock) it should take effect, and the callback
+// holds on to it until the block that covers that time.
+class MidiSynth : public AudioMixer::Source
+{
+public:
+    MidiSynth();
+    virtual ~MidiSynth();
+
+    bool Setup(uint32_t framesPerSecond, uint32_t numChannels, uint32_t maxVoices);
+    void Shutdown();
+
+    // These may only be called from one thread.  A buffer may hold several messages, and running status is understood.
+    // System messages are skipped.  Reset silences everything and puts every channel back the way Setup left it.
+    // A time of zero means as soon as possible, but messages are always executed in the order they were sent.
+    bool SendMessage(const uint8_t* messageBuf, size_t messageBufSize, int64_t timeNanoseconds = 0);
+    bool Reset();
+
+    // This is only ever called from the audio thread.  It never allocates, locks or blocks.
+    virtual void Render(float* mixBuf, uint32_t numFrames) override;
+
+    uint32_t GetActiveVoiceCount() const { return this->activeVoiceCount.load(); }
+    uint32_t GetDroppedCount() const { return this->droppedCount.load(); }
+    uint32_t GetStolenCount() const { return this->stolenCount.load(); }
+
+private:
+    enum Waveform
+    {
+        SINE,
+        MELLOW,
+        BRIGHT,
+        HOLLOW,
+        NUM_WAVEFORMS
+    };
+
+    struct Patch
+    {
+        Waveform waveform;
+        float attackSeconds;
+        float decaySeconds;
+        float sustainLevel;
+        float releaseSeconds;
+        float gain;
+    };
+
+    enum class EnvelopeStage
+    {
+        ATTACK,
+        DECAY,
+        SUSTAIN,
+        RELEASE,
+        DONE
+    };
+
+    struct Message
+    {
+        int64_t timeNanoseconds;
+        uint8_t byteArray[3];
+        uint8_t size;       // Zero means reset.
+    };
+
+    struct Channel
+    {
+        uint8_t program;
+        float volume;
+        float expression;
+        float leftGain;
+        float rightGain;
+        float pitchBendFactor;
+        bool sustainPedal;
+    };
+
+    struct Voice
+    {
+        const float* tableBuf;
+        uint32_t phase;
+        uint32_t basePhaseIncrement;
+        uint8_t channel;
+        uint8_t note;
+        bool keyDown;
+        EnvelopeStage stage;
+        float level;
+        float attackRate;
+        float decayRate;
+        float sustainLevel;
+        float releaseRate;
+        float velocityGain;
+        uint32_t startOrder;
+    };
+
+    void BuildTables();
+    void ResetChannels();
+    void ExecuteMessages(int64_t untilNanoseconds);
+    void ExecuteMessage(const Message& message);
+    void NoteOn(uint8_t channel, uint8_t note, uint8_t velocity);
+    void NoteOff(uint8_t channel, uint8_t note);
+    void ControlChange(uint8_t channel, uint8_t controller, uint8_t value);
+    void ReleaseVoice(Voice& voice) const;
+    Voice* AllocateVoice();
+    const float* FindTable(Waveform waveform, double frequency) const;
+    void AdvanceEnvelope(Voice& voice, uint32_t numFrames) const;
+    void RenderBlock(float* mixBuf, uint32_t numFrames);
+
+    static const Patch* GetMelodicPatch(uint8_t program);
+    static const Patch* GetDrumPatch(uint8_t note, double& frequency, bool& useNoise);
+
+    uint32_t framesPerSecond;
+    uint32_t numChannels;
+
+    // Each table has one extra sample at the end, a copy of the first, so interpolation never has to wrap.
+    std::vector<float> waveTableArray;
+    std::vector<float> noiseTableArray;
+
+    Channel channelArray[MIDI_SYNTH_NUM_CHANNELS];
+
+    // The first numActiveVoices voices are the ones playing.
+    std::vector<Voice> voiceArray;
+    uint32_t numActiveVoices;
+    uint32_t nextStartOrder;
+    std::vector<float> voiceBuffer;
+
+    RingBuffer<Message> messageQueue;
+    uint8_t runningStatus;
+    std::atomic<uint32_t> activeVoiceCount;
+    std::atomic<uint32_t> droppedCount;
+    std::atomic<uint32_t> stolenCount;
+};
\ No newline at end of file
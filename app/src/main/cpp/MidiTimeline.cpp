@@ -0,0 +1,259 @@
+#include "MidiTimeline.h"
+#include <string.h>
+#include <algorithm>
+
+#define MIDI_DEFAULT_TEMPO      500000      // Microseconds per quarter note, which is 120 BPM.
+
+// Everything in a MIDI file is big-endian.
+static uint32_t ReadUInt32(const uint8_t* buf)
+{
+    return (uint32_t(buf[0]) << 24) | (uint32_t(buf[1]) << 16) | (uint32_t(buf[2]) << 8) | uint32_t(buf[3]);
+}
+
+static uint16_t ReadUInt16(const uint8_t* buf)
+{
+    return uint16_t((buf[0] << 8) | buf[1]);
+}
+
+// Variable-length quantities are at most four bytes, seven bits at a time, with the top bit set on all but the last.
+static bool ReadVariableLength(const uint8_t* buf, size_t bufSize, size_t& offset, uint32_t& value)
+{
+    value = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        if(offset >= bufSize)
+            return false;
+
+        uint8_t byte = buf[offset++];
+        value = (value << 7) | (byte & 0x7F);
+        if((byte & 0x80) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+MidiTimeline::MidiTimeline()
+{
+    this->lengthSeconds = 0.0;
+    this->numTracks = 0;
+    this->numTempoChanges = 0;
+}
+
+/*virtual*/ MidiTimeline::~MidiTimeline()
+{
+}
+
+void MidiTimeline::Clear()
+{
+    this->eventArray.clear();
+    this->tickEventArray.clear();
+    this->lengthSeconds = 0.0;
+    this->numTracks = 0;
+    this->numTempoChanges = 0;
+}
+
+bool MidiTimeline::Compile(const uint8_t* fileBuf, size_t fileBufSize)
+{
+    this->Clear();
+
+    bool success = false;
+
+    do
+    {
+        if(fileBufSize < 14 || ::memcmp(fileBuf, "MThd", 4) != 0 || ReadUInt32(fileBuf + 4) < 6)
+            break;
+
+        uint16_t format = ReadUInt16(fileBuf + 8);
+        uint16_t numTrackChunks = ReadUInt16(fileBuf + 10);
+        uint16_t division = ReadUInt16(fileBuf + 12);
+        if(format > 2 || division == 0)
+            break;
+
+        // With SMPTE timing, ticks are a fixed fraction of a second and tempo changes don't matter.
+        // Otherwise, the division is ticks per quarter note, and tempo says how long a quarter note is.
+        double smpteSecondsPerTick = 0.0;
+        if(division & 0x8000)
+        {
+            int framesPerSecond = -int(int8_t(division >> 8));
+            int ticksPerFrame = division & 0xFF;
+            if(framesPerSecond <= 0 || ticksPerFrame == 0)
+                break;
+
+            double exactFramesPerSecond = (framesPerSecond == 29) ? 29.97 : double(framesPerSecond);
+            smpteSecondsPerTick = 1.0 / (exactFramesPerSecond * double(ticksPerFrame));
+        }
+
+        // In a type 1 file, the tracks all play at once.  In a type 2 file, each track is its own
+        // sequence, so we just play them one after another.
+        size_t offset = 8 + ReadUInt32(fileBuf + 4);
+        uint64_t songEndTick = 0;
+        bool tracksRead = true;
+        while(this->numTracks < numTrackChunks && offset + 8 <= fileBufSize)
+        {
+            const uint8_t* chunkBuf = fileBuf + offset;
+            uint32_t chunkSize = ReadUInt32(chunkBuf + 4);
+            size_t chunkDataBufSize = std::min(size_t(chunkSize), fileBufSize - offset - 8);
+            offset += 8 + size_t(chunkSize);
+
+            // Unknown chunk types are allowed, and are to be skipped.
+            if(::memcmp(chunkBuf, "MTrk", 4) != 0)
+                continue;
+
+            uint64_t trackEndTick = 0;
+            if(!this->ReadTrack(chunkBuf + 8, chunkDataBufSize, (format == 2) ? songEndTick : 0, trackEndTick))
+            {
+                tracksRead = false;
+                break;
+            }
+
+            songEndTick = std::max(songEndTick, trackEndTick);
+            this->numTracks++;
+        }
+
+        if(!tracksRead || this->numTracks == 0)
+            break;
+
+        // The tracks were read one after another, and a stable sort keeps events at the same tick in track order.
+        // That's what we want, since tempo changes normally live in the first track and should apply to
+        // everything that happens on the same tick.
+        std::stable_sort(this->tickEventArray.begin(), this->tickEventArray.end(), [](const TickEvent& eventA, const TickEvent& eventB)
+        {
+            return eventA.tick < eventB.tick;
+        });
+
+        // Now each tick gets turned into seconds, measured from the last tempo change so that error doesn't accumulate.
+        uint64_t tempoTick = 0;
+        double tempoSeconds = 0.0;
+        double secondsPerTick = (division & 0x8000) ? smpteSecondsPerTick : double(MIDI_DEFAULT_TEMPO) / (1e6 * double(division));
+        this->eventArray.reserve(this->tickEventArray.size());
+        for(const TickEvent& tickEvent : this->tickEventArray)
+        {
+            double timeSeconds = tempoSeconds + double(tickEvent.tick - tempoTick) * secondsPerTick;
+
+            if(tickEvent.tempo == 0)
+            {
+                this->eventArray.push_back(tickEvent.event);
+                this->eventArray.back().timeSeconds = timeSeconds;
+            }
+            else if((division & 0x8000) == 0)
+            {
+                tempoTick = tickEvent.tick;
+                tempoSeconds = timeSeconds;
+                secondsPerTick = double(tickEvent.tempo) / (1e6 * double(division));
+                this->numTempoChanges++;
+            }
+        }
+
+        this->lengthSeconds = tempoSeconds + double(songEndTick - tempoTick) * secondsPerTick;
+        if(this->eventArray.size() > 0)
+            this->lengthSeconds = std::max(this->lengthSeconds, this->eventArray.back().timeSeconds);
+
+        success = true;
+    } while(false);
+
+    // We only need the ticks while compiling, so don't hang on to that memory.
+    std::vector<TickEvent>().swap(this->tickEventArray);
+
+    if(!success)
+        this->Clear();
+
+    return success;
+}
+
+bool MidiTimeline::ReadTrack(const uint8_t* trackBuf, size_t trackBufSize, uint64_t startTick, uint64_t& endTick)
+{
+    uint64_t tick = startTick;
+    uint8_t runningStatus = 0;
+    size_t offset = 0;
+
+    while(offset < trackBufSize)
+    {
+        uint32_t deltaTicks = 0;
+        if(!ReadVariableLength(trackBuf, trackBufSize, offset, deltaTicks) || offset >= trackBufSize)
+            return false;
+
+        tick += deltaTicks;
+
+        uint8_t status = trackBuf[offset];
+        if(status & 0x80)
+            offset++;
+        else if(runningStatus != 0)
+            status = runningStatus;
+        else
+            return false;
+
+        if(status == 0xFF)
+        {
+            // Meta events cancel running status.  The only ones we care about are tempo changes and the end of the track.
+            runningStatus = 0;
+            if(offset >= trackBufSize)
+                return false;
+
+            uint8_t metaType = trackBuf[offset++];
+            uint32_t length = 0;
+            if(!ReadVariableLength(trackBuf, trackBufSize, offset, length) || length > trackBufSize - offset)
+                return false;
+
+            if(metaType == 0x51 && length == 3)
+            {
+                TickEvent tickEvent{};
+                tickEvent.tick = tick;
+                tickEvent.tempo = (uint32_t(trackBuf[offset]) << 16) | (uint32_t(trackBuf[offset + 1]) << 8) | uint32_t(trackBuf[offset + 2]);
+                if(tickEvent.tempo != 0)
+                    this->tickEventArray.push_back(tickEvent);
+            }
+
+            offset += length;
+
+            if(metaType == 0x2F)
+                break;
+        }
+        else if(status == 0xF0 || status == 0xF7)
+        {
+            // System exclusive messages are skipped, and they cancel running status too.
+            runningStatus = 0;
+            uint32_t length = 0;
+            if(!ReadVariableLength(trackBuf, trackBufSize, offset, length) || length > trackBufSize - offset)
+                return false;
+
+            offset += length;
+        }
+        else if(status >= 0xF0)
+        {
+            // Nothing else from the system range belongs in a file.
+            return false;
+        }
+        else
+        {
+            runningStatus = status;
+
+            // Program change and channel pressure have one data byte.  Everything else has two.
+            uint8_t numDataBytes = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 1 : 2;
+            if(numDataBytes > trackBufSize - offset)
+                return false;
+
+            TickEvent tickEvent{};
+            tickEvent.tick = tick;
+            tickEvent.event.byteArray[0] = status;
+            tickEvent.event.size = 1 + numDataBytes;
+            for(uint8_t i = 0; i < numDataBytes; i++)
+                tickEvent.event.byteArray[1 + i] = trackBuf[offset++] & 0x7F;
+
+            this->tickEventArray.push_back(tickEvent);
+        }
+    }
+
+    endTick = tick;
+    return true;
+}
+
+size_t MidiTimeline::FindEvent(double timeSeconds) const
+{
+    auto iter = std::lower_bound(this->eventArray.begin(), this->eventArray.end(), timeSeconds, [](const Event& event, double timeSeconds)
+    {
+        return event.timeSeconds < timeSeconds;
+    });
+
+    return size_t(iter - this->eventArray.begin());
+}
\ No newline at end of file
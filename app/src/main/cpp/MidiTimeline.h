@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// This is a standard MIDI file compiled down to exactly what playback needs: one array of
+// channel messages from every track, merged and sorted by time, with each time already in
+// seconds from the start of the song.  All the tempo math happens once, here, so playing a
+// song is just a cursor walking forward through the array, finding a time is a binary
+// search, and the length of the song falls out for free.  Meta events and system exclusive
+// messages are dropped once their tempo changes have been applied.
+//
+// Once compiled, a timeline is never changed, so any number of threads may read it.
+class MidiTimeline
+{
+public:
+    MidiTimeline();
+    virtual ~MidiTimeline();
+
+    struct Event
+    {
+        double timeSeconds;
+        uint8_t byteArray[3];
+        uint8_t size;
+    };
+
+    bool Compile(const uint8_t* fileBuf, size_t fileBufSize);
+    void Clear();
+
+    size_t GetEventCount() const { return this->eventArray.size(); }
+    const Event& GetEvent(size_t i) const { return this->eventArray[i]; }
+
+    // This runs until the last track ends, which can be a while after the last note starts.
+    double GetLengthSeconds() const { return this->lengthSeconds; }
+
+    // This gives the offset of the first event at or after the given time, or the event count if there isn't one.
+    size_t FindEvent(double timeSeconds) const;
+
+    uint32_t GetTrackCount() const { return this->numTracks; }
+    uint32_t GetTempoChangeCount() const { return this->numTempoChanges; }
+
+private:
+
+    // While compiling, everything is still in ticks, and tempo changes are kept in line with the other events.
+    struct TickEvent
+    {
+        uint64_t tick;
+        uint32_t tempo;
+        Event event;
+    };
+
+    bool ReadTrack(const uint8_t* trackBuf, size_t trackBufSize, uint64_t startTick, uint64_t& endTick);
+
+    std::vector<Event> eventArray;
+    std::vector<TickEvent> tickEventArray;
+    double lengthSeconds;
+    uint32_t numTracks;
+    uint32_t numTempoChanges;
+};
\ No newline at end of file
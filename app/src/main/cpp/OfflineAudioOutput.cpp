@@ -0,0 +1,74 @@
+#include "OfflineAudioOutput.h"
+#include "AudioMixer.h"
+#include "WaveFile.h"
+#include <time.h>
+
+OfflineAudioOutput::OfflineAudioOutput()
+{
+    this->mixer = nullptr;
+    this->framesPerBurst = 0;
+    this->bytesPerFrame = 0;
+    this->keepOutput = false;
+}
+
+/*virtual*/ OfflineAudioOutput::~OfflineAudioOutput()
+{
+}
+
+bool OfflineAudioOutput::Setup(AudioMixer* mixer, uint32_t framesPerBurst, bool keepOutput)
+{
+    if(!mixer || framesPerBurst == 0 || mixer->GetNumChannels() == 0)
+        return false;
+
+    this->mixer = mixer;
+    this->framesPerBurst = framesPerBurst;
+    this->keepOutput = keepOutput;
+
+    uint32_t bytesPerSample = (mixer->GetSampleFormat() == AudioMixer::SampleFormat::INT16) ? 2 : 4;
+    this->bytesPerFrame = bytesPerSample * mixer->GetNumChannels();
+    this->burstArray.resize(framesPerBurst * this->bytesPerFrame);
+
+    this->Clear();
+    return true;
+}
+
+void OfflineAudioOutput::Clear()
+{
+    this->outputArray.clear();
+    this->burstNanosecondsArray.clear();
+}
+
+void OfflineAudioOutput::Render(uint32_t numBursts)
+{
+    if(!this->mixer)
+        return;
+
+    this->burstNanosecondsArray.reserve(this->burstNanosecondsArray.size() + numBursts);
+    if(this->keepOutput)
+        this->outputArray.reserve(this->outputArray.size() + size_t(numBursts) * this->burstArray.size());
+
+    for(uint32_t i = 0; i < numBursts; i++)
+    {
+        struct timespec startTime, endTime;
+        ::clock_gettime(CLOCK_MONOTONIC, &startTime);
+        this->mixer->Mix(this->burstArray.data(), this->framesPerBurst);
+        ::clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+        this->burstNanosecondsArray.push_back(double(endTime.tv_sec - startTime.tv_sec) * 1e9 + double(endTime.tv_nsec - startTime.tv_nsec));
+
+        if(this->keepOutput)
+            this->outputArray.insert(this->outputArray.end(), this->burstArray.begin(), this->burstArray.end());
+    }
+}
+
+bool OfflineAudioOutput::WriteWaveFile(const char* filePath) const
+{
+    if(!this->mixer)
+        return false;
+
+    AudioMixer::SampleFormat sampleFormat = this->mixer->GetSampleFormat();
+    WaveFile::SampleType sampleType = (sampleFormat == AudioMixer::SampleFormat::FLOAT) ? WaveFile::SampleType::FLOAT : WaveFile::SampleType::SIGNED_INTEGER;
+    uint32_t bitsPerSample = (sampleFormat == AudioMixer::SampleFormat::INT16) ? 16 : 32;
+
+    return WaveFile::Write(filePath, sampleType, this->mixer->GetNumChannels(), this->mixer->GetFramesPerSecond(), bitsPerSample, this->outputArray.data(), this->outputArray.size());
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class AudioMixer;
+
+// This stands in for the audio device when there isn't one, such as on a build machine.
+// It pulls from the mixer a burst at a time, just like the device's callback would, but
+// as fast as it can rather than in real time.  What comes out can be kept in memory
+// and written to a WAV file, and how long each burst took is recorded so that we can
+// keep an eye on what the mixer costs.
+class OfflineAudioOutput
+{
+public:
+    OfflineAudioOutput();
+    virtual ~OfflineAudioOutput();
+
+    bool Setup(AudioMixer* mixer, uint32_t framesPerBurst, bool keepOutput);
+
+    // Each burst is timed separately, and any output is appended to what was rendered before.
+    void Render(uint32_t numBursts);
+    void Clear();
+
+    bool WriteWaveFile(const char* filePath) const;
+
+    uint32_t GetFramesPerBurst() const { return this->framesPerBurst; }
+    const std::vector<uint8_t>& GetOutputBuffer() const { return this->outputArray; }
+    const std::vector<double>& GetBurstTimeArray() const { return this->burstNanosecondsArray; }
+
+private:
+    AudioMixer* mixer;
+    uint32_t framesPerBurst;
+    uint32_t bytesPerFrame;
+    bool keepOutput;
+    std::vector<uint8_t> burstArray;
+    std::vector<uint8_t> outputArray;
+    std::vector<double> burstNanosecondsArray;
+};
\ No newline at end of file
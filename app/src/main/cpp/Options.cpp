@@ -1,8 +1,9 @@
 #include "Options.h"
+#include "BinaryRecord.h"
+#include "AsyncFileWriter.h"
+#include "Checksum.h"
 #include "JsonValue.h"
 #include "AndroidOut.h"
-#include <game-activity/native_app_glue/android_native_app_glue.h>
-#include <android/native_activity.h>
 #include <android/asset_manager.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,57 +15,144 @@ Options::Options()
 {
     this->gravity = 980.0;
     this->bounce = 0.5;
+    this->gravitySmoothingSeconds = 0.02;
+    this->gravityPredictionSeconds = 0.0;
+    this->recordGravitySamples = false;
+    this->recordInput = false;
+    this->replayInputFile = "";
     this->audio = true;
+    this->audioStats = false;
+    this->audioMinBufferBursts = 1;
+    this->audioMaxBufferBursts = 8;
+    this->audioShrinkAfterSeconds = 30.0;
+    this->mazeShape = "rectangular";
 }
 
 /*virtual*/ Options::~Options()
 {
 }
 
-bool Options::Load(android_app* app)
+bool Options::Load(const std::string& dataFolder, AAssetManager* assetManager)
 {
-    const char* dataFolder = app->activity->internalDataPath;
-    char optionsFile[256];
-    sprintf(optionsFile, "%s/options.json", dataFolder);
-    FILE* fp = fopen(optionsFile, "r");
+    std::string recordFile = dataFolder + "/options.bin";
+    std::string optionsFile = dataFolder + "/options.json";
+    FILE* fp = fopen(optionsFile.c_str(), "r");
     if(fp)
     {
         fseek(fp, 0, SEEK_END);
         size_t optionsJsonBufSize = ftell(fp);
-        char* optionsJsonBuf = new char[optionsJsonBufSize];
+        std::string optionsJsonStr(optionsJsonBufSize, '\0');
         fseek(fp, 0, SEEK_SET);
-        fread(optionsJsonBuf, optionsJsonBufSize, 1, fp);
-        bool optionsLoaded = this->LoadFromString(optionsJsonBuf, optionsJsonBufSize);
-        delete[] optionsJsonBuf;
+        if(optionsJsonBufSize > 0)
+            fread(&optionsJsonStr[0], optionsJsonBufSize, 1, fp);
         fclose(fp);
-        if(optionsLoaded)
+        if(this->LoadFromJsonSource(optionsJsonStr, recordFile))
             return true;
     }
 
     aout << "Options file didn't exist or didn't open, so falling back on default options." << std::endl;
 
-    strcpy(optionsFile, "default_options.json");
-    AAsset* optionsAsset = AAssetManager_open(app->activity->assetManager, optionsFile, AASSET_MODE_STREAMING);
+    AAsset* optionsAsset = AAssetManager_open(assetManager, "default_options.json", AASSET_MODE_STREAMING);
     if(!optionsAsset)
     {
         aout << "Failed to open default options file." << std::endl;
         return false;
     }
 
-    const char* optionsJsonBuf = (const char*)AAsset_getBuffer(optionsAsset);
-    int optionsJsonBufSize = AAsset_getLength(optionsAsset);
-    bool optionsLoaded = this->LoadFromString(optionsJsonBuf, optionsJsonBufSize);
+    std::string optionsJsonStr((const char*)AAsset_getBuffer(optionsAsset), (size_t)AAsset_getLength(optionsAsset));
     AAsset_close(optionsAsset);
-    return optionsLoaded;
+    return this->LoadFromJsonSource(optionsJsonStr, recordFile);
 }
 
-bool Options::LoadFromString(const char* optionsJsonBuf, int optionsJsonBufSize)
+bool Options::LoadFromJsonSource(const std::string& jsonString, const std::string& recordFile)
 {
-    char* safeBuffer = new char[optionsJsonBufSize + 1];
-    ::memcpy(safeBuffer, optionsJsonBuf, optionsJsonBufSize);
-    safeBuffer[optionsJsonBufSize] = '\0';
-    std::string optionsJsonStr(safeBuffer);
-    delete[] safeBuffer;
+    auto sourceSize = uint32_t(jsonString.length());
+    uint32_t sourceChecksum = CalcCrc32(jsonString.data(), jsonString.length());
+    if(this->LoadFile(recordFile, sourceSize, sourceChecksum))
+        return true;
+
+    if(!this->ImportJson(jsonString.data(), jsonString.length()))
+        return false;
+
+    // This only happens when the options have changed, so it's not worth handing off to another thread.
+    std::string fileData;
+    if(this->PackRecord(fileData, sourceSize, sourceChecksum) && !AsyncFileWriter::WriteFileAtomically(recordFile, fileData.data(), fileData.size()))
+        aout << "Failed to save options record " << recordFile << "." << std::endl;
+
+    return true;
+}
+
+bool Options::LoadFile(const std::string& recordFile, uint32_t sourceSize, uint32_t sourceChecksum)
+{
+    Record record{};
+    if(!this->MakeRecord(record))
+        return false;
+
+    if(!BinaryRecord::ReadFile(recordFile, OPTIONS_MAGIC, OPTIONS_VERSION, &record, sizeof(Record)))
+        return false;
+
+    if(record.sourceSize != sourceSize || record.sourceChecksum != sourceChecksum)
+        return false;
+
+    this->ApplyRecord(record);
+    return true;
+}
+
+bool Options::PackRecord(std::string& fileData, uint32_t sourceSize, uint32_t sourceChecksum) const
+{
+    Record record{};
+    if(!this->MakeRecord(record))
+        return false;
+
+    record.sourceSize = sourceSize;
+    record.sourceChecksum = sourceChecksum;
+    BinaryRecord::Pack(OPTIONS_MAGIC, OPTIONS_VERSION, &record, sizeof(Record), fileData);
+    return true;
+}
+
+// Strings that don't fit in the record mean we just can't keep one, and have to parse the JSON every time.
+bool Options::MakeRecord(Record& record) const
+{
+    if(this->mazeShape.length() >= sizeof(record.mazeShape) || this->replayInputFile.length() >= sizeof(record.replayInputFile))
+        return false;
+
+    ::memset(&record, 0, sizeof(Record));
+    record.gravity = this->gravity;
+    record.bounce = this->bounce;
+    record.gravitySmoothingSeconds = this->gravitySmoothingSeconds;
+    record.gravityPredictionSeconds = this->gravityPredictionSeconds;
+    record.audioShrinkAfterSeconds = this->audioShrinkAfterSeconds;
+    record.audioMinBufferBursts = this->audioMinBufferBursts;
+    record.audioMaxBufferBursts = this->audioMaxBufferBursts;
+    record.recordGravitySamples = this->recordGravitySamples ? 1 : 0;
+    record.recordInput = this->recordInput ? 1 : 0;
+    record.audio = this->audio ? 1 : 0;
+    record.audioStats = this->audioStats ? 1 : 0;
+    ::strcpy(record.mazeShape, this->mazeShape.c_str());
+    ::strcpy(record.replayInputFile, this->replayInputFile.c_str());
+    return true;
+}
+
+void Options::ApplyRecord(const Record& record)
+{
+    this->gravity = record.gravity;
+    this->bounce = record.bounce;
+    this->gravitySmoothingSeconds = record.gravitySmoothingSeconds;
+    this->gravityPredictionSeconds = record.gravityPredictionSeconds;
+    this->audioShrinkAfterSeconds = record.audioShrinkAfterSeconds;
+    this->audioMinBufferBursts = record.audioMinBufferBursts;
+    this->audioMaxBufferBursts = record.audioMaxBufferBursts;
+    this->recordGravitySamples = (record.recordGravitySamples != 0);
+    this->recordInput = (record.recordInput != 0);
+    this->audio = (record.audio != 0);
+    this->audioStats = (record.audioStats != 0);
+    this->mazeShape = std::string(record.mazeShape, ::strnlen(record.mazeShape, sizeof(record.mazeShape)));
+    this->replayInputFile = std::string(record.replayInputFile, ::strnlen(record.replayInputFile, sizeof(record.replayInputFile)));
+}
+
+bool Options::ImportJson(const char* optionsJsonBuf, size_t optionsJsonBufSize)
+{
+    std::string optionsJsonStr(optionsJsonBuf, optionsJsonBufSize);
 
     std::string parseError;
     std::unique_ptr<JsonValue> jsonData(JsonValue::ParseJson(optionsJsonStr, parseError));
@@ -90,9 +178,96 @@ bool Options::LoadFromString(const char* optionsJsonBuf, int optionsJsonBufSize)
     if(jsonBounce)
         this->bounce = jsonBounce->GetValue();
 
+    auto jsonGravitySmoothingSeconds = dynamic_cast<const JsonFloat*>(jsonOptions->GetValue("gravity_smoothing_seconds"));
+    if(jsonGravitySmoothingSeconds)
+        this->gravitySmoothingSeconds = jsonGravitySmoothingSeconds->GetValue();
+
+    auto jsonGravityPredictionSeconds = dynamic_cast<const JsonFloat*>(jsonOptions->GetValue("gravity_prediction_seconds"));
+    if(jsonGravityPredictionSeconds)
+        this->gravityPredictionSeconds = jsonGravityPredictionSeconds->GetValue();
+
+    auto jsonRecordGravitySamples = dynamic_cast<const JsonBool*>(jsonOptions->GetValue("record_gravity_samples"));
+    if(jsonRecordGravitySamples)
+        this->recordGravitySamples = jsonRecordGravitySamples->GetValue();
+
+    auto jsonRecordInput = dynamic_cast<const JsonBool*>(jsonOptions->GetValue("record_input"));
+    if(jsonRecordInput)
+        this->recordInput = jsonRecordInput->GetValue();
+
+    auto jsonReplayInputFile = dynamic_cast<const JsonString*>(jsonOptions->GetValue("replay_input_file"));
+    if(jsonReplayInputFile)
+        this->replayInputFile = jsonReplayInputFile->GetValue();
+
     auto jsonAudio = dynamic_cast<const JsonBool*>(jsonOptions->GetValue("audio"));
     if(jsonAudio)
         this->audio = jsonAudio->GetValue();
 
+    auto jsonAudioStats = dynamic_cast<const JsonBool*>(jsonOptions->GetValue("audio_stats"));
+    if(jsonAudioStats)
+        this->audioStats = jsonAudioStats->GetValue();
+
+    auto jsonAudioMinBufferBursts = dynamic_cast<const JsonInt*>(jsonOptions->GetValue("audio_min_buffer_bursts"));
+    if(jsonAudioMinBufferBursts)
+        this->audioMinBufferBursts = int(jsonAudioMinBufferBursts->GetValue());
+
+    auto jsonAudioMaxBufferBursts = dynamic_cast<const JsonInt*>(jsonOptions->GetValue("audio_max_buffer_bursts"));
+    if(jsonAudioMaxBufferBursts)
+        this->audioMaxBufferBursts = int(jsonAudioMaxBufferBursts->GetValue());
+
+    auto jsonAudioShrinkAfterSeconds = dynamic_cast<const JsonFloat*>(jsonOptions->GetValue("audio_shrink_after_seconds"));
+    if(jsonAudioShrinkAfterSeconds)
+        this->audioShrinkAfterSeconds = jsonAudioShrinkAfterSeconds->GetValue();
+
+    auto jsonMazeShape = dynamic_cast<const JsonString*>(jsonOptions->GetValue("maze_shape"));
+    if(jsonMazeShape)
+        this->mazeShape = jsonMazeShape->GetValue();
+
+    return true;
+}
+
+// Floats are always written with a decimal point so that they read back as floats and not integers.
+static void AppendJsonFloat(std::string& jsonString, const char* key, double value)
+{
+    char valueText[64];
+    snprintf(valueText, sizeof(valueText), "%.17g", value);
+    if(!::strpbrk(valueText, ".eEn"))
+        ::strcat(valueText, ".0");
+
+    jsonString += std::string("  \"") + key + "\": " + valueText + ",\n";
+}
+
+static void AppendJsonString(std::string& jsonString, const char* key, const std::string& value)
+{
+    jsonString += std::string("  \"") + key + "\": \"";
+    for(char ch : value)
+    {
+        if(ch == '"' || ch == '\\')
+            jsonString += '\\';
+        jsonString += ch;
+    }
+    jsonString += "\",\n";
+}
+
+// This is laid out like default_options.json, so that the two can be compared by eye.
+bool Options::ExportJson(std::string& jsonString) const
+{
+    jsonString = "{\n";
+    AppendJsonFloat(jsonString, "gravity", this->gravity);
+    AppendJsonFloat(jsonString, "bounce", this->bounce);
+    AppendJsonFloat(jsonString, "gravity_smoothing_seconds", this->gravitySmoothingSeconds);
+    AppendJsonFloat(jsonString, "gravity_prediction_seconds", this->gravityPredictionSeconds);
+    jsonString += std::string("  \"record_gravity_samples\": ") + (this->recordGravitySamples ? "true" : "false") + ",\n";
+    jsonString += std::string("  \"record_input\": ") + (this->recordInput ? "true" : "false") + ",\n";
+    AppendJsonString(jsonString, "replay_input_file", this->replayInputFile);
+    jsonString += std::string("  \"audio\": ") + (this->audio ? "true" : "false") + ",\n";
+    jsonString += std::string("  \"audio_stats\": ") + (this->audioStats ? "true" : "false") + ",\n";
+    jsonString += "  \"audio_min_buffer_bursts\": " + std::to_string(this->audioMinBufferBursts) + ",\n";
+    jsonString += "  \"audio_max_buffer_bursts\": " + std::to_string(this->audioMaxBufferBursts) + ",\n";
+    AppendJsonFloat(jsonString, "audio_shrink_after_seconds", this->audioShrinkAfterSeconds);
+    AppendJsonString(jsonString, "maze_shape", this->mazeShape);
+
+    // Take the comma off the last one.
+    jsonString.erase(jsonString.length() - 2, 1);
+    jsonString += "}\n";
     return true;
 }
\ No newline at end of file
@@ -1,20 +1,92 @@
 #pragma once
 
-struct android_app;
+#include <stdint.h>
+#include <string>
 
+#define OPTIONS_MAGIC                   0x504F4D47      // "GMOP" when read as little-endian bytes.
+#define OPTIONS_VERSION                 1
+#define OPTIONS_MAX_NAME_SIZE           32
+#define OPTIONS_MAX_PATH_SIZE           256
+
+struct AAssetManager;
+
+// The options screen writes our options as JSON, so that's where they always come from.  Parsing
+// it is most of the cost of loading them, though, so whenever we do, we keep what we got as a
+// binary record (see BinaryRecord) along with the size and checksum of the JSON it came from.
+// As long as the JSON hasn't changed since, loading the options is just a matter of reading
+// that record back.
 class Options
 {
 public:
     Options();
     virtual ~Options();
 
-    bool Load(android_app* app);
+    // This is how the options are laid out on storage.  New fields only ever go on the end.
+    struct Record
+    {
+        uint32_t sourceSize;
+        uint32_t sourceChecksum;
+        double gravity;
+        double bounce;
+        double gravitySmoothingSeconds;
+        double gravityPredictionSeconds;
+        double audioShrinkAfterSeconds;
+        int32_t audioMinBufferBursts;
+        int32_t audioMaxBufferBursts;
+        uint8_t recordGravitySamples;
+        uint8_t recordInput;
+        uint8_t audio;
+        uint8_t audioStats;
+        char mazeShape[OPTIONS_MAX_NAME_SIZE];
+        char replayInputFile[OPTIONS_MAX_PATH_SIZE];
+    };
+
+    bool Load(const std::string& dataFolder, AAssetManager* assetManager);
+
+    // These work with any file path or string so that we can use them from host tools too.  Loading a record only
+    // succeeds if it was made from JSON of the given size and checksum.
+    bool LoadFile(const std::string& recordFile, uint32_t sourceSize, uint32_t sourceChecksum);
+    bool PackRecord(std::string& fileData, uint32_t sourceSize, uint32_t sourceChecksum) const;
+    bool ImportJson(const char* optionsJsonBuf, size_t optionsJsonBufSize);
+    bool ExportJson(std::string& jsonString) const;
+
+    // Making a record fails if a string option is too long for it.
+    bool MakeRecord(Record& record) const;
+    void ApplyRecord(const Record& record);
 
 private:
-    bool LoadFromString(const char* optionsJsonBuf, int optionsJsonBufSize);
+    bool LoadFromJsonSource(const std::string& jsonString, const std::string& recordFile);
 
 public:
     double gravity;
     double bounce;
+
+    // Gravity readings are low-pass filtered with this time constant.  Zero turns the filter off.
+    double gravitySmoothingSeconds;
+
+    // Each physics step uses gravity predicted this far past the step, to make up for display latency.
+    double gravityPredictionSeconds;
+
+    // This keeps every gravity sample and writes them all out to internal storage when the game exits.
+    bool recordGravitySamples;
+
+    // This logs each level and the gravity for every physics step to internal storage, so that the session can be replayed.
+    bool recordInput;
+
+    // If this names an input log (in internal storage, unless it's an absolute path), it's played back instead of the sensor.
+    std::string replayInputFile;
+
     bool audio;
+
+    // This puts how the audio output is doing (burst and buffer sizes, xruns, latency and callback times) on screen.
+    bool audioStats;
+
+    // The audio output buffer starts at the minimum number of bursts, grows a burst per xrun up to the maximum,
+    // and gives a burst back after this many seconds without any.
+    int audioMinBufferBursts;
+    int audioMaxBufferBursts;
+    double audioShrinkAfterSeconds;
+
+    // This is one of "rectangular", "hexagonal", "polar" or "mixed", the last of which cycles through the others by level.
+    std::string mazeShape;
 };
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "PhysicsWorld.h"
+#include "MazeObjects/MazeBlock.h"
+#include "MazeObjects/MazeQueen.h"
+
+using namespace PlanarPhysics;
+
+PhysicsWorld::PhysicsWorld()
+{
+    this->ballCollisionCount = 0;
+    this->evilBlockResetCount = 0;
+}
+
+/*virtual*/ PhysicsWorld::~PhysicsWorld()
+{
+}
+
+void PhysicsWorld::ResetStats()
+{
+    this->ballCollisionCount = 0;
+    this->evilBlockResetCount = 0;
+}
+
+bool PhysicsWorld::IsMazeSolved()
+{
+    return this->GetGoodMazeBlockCount() == this->GetGoodMazeBlockTouchedCount() && this->QueenDeadOrNonExistent();
+}
+
+int PhysicsWorld::GetGoodMazeBlockCount()
+{
+    int count = 0;
+    for(auto planarObject : this->GetPlanarObjectArray())
+        if(dynamic_cast<GoodMazeBlock*>(planarObject))
+            count++;
+
+    return count;
+}
+
+int PhysicsWorld::GetGoodMazeBlockTouchedCount()
+{
+    int count = 0;
+
+    for(auto planarObject : this->GetPlanarObjectArray())
+    {
+        auto goodMazeBlock = dynamic_cast<GoodMazeBlock *>(planarObject);
+        if (goodMazeBlock && goodMazeBlock->IsTouched())
+            count++;
+    }
+
+    return count;
+}
+
+bool PhysicsWorld::QueenDeadOrNonExistent()
+{
+    MazeQueen* mazeQueen = this->FindTheQueen();
+    return !mazeQueen || !mazeQueen->alive;
+}
+
+MazeQueen* PhysicsWorld::FindTheQueen()
+{
+    for(auto planarObject : this->GetPlanarObjectArray())
+    {
+        auto mazeQueen = dynamic_cast<MazeQueen *>(planarObject);
+        if (mazeQueen)
+            return mazeQueen;
+    }
+
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Engine.h"
+
+// The engine takes a fixed step each time it ticks, and the game ticks it this often, so a level's
+// physics steps divided by this is how long the player spent solving it in game time.
+#define PHYSICS_WORLD_STEPS_PER_SECOND      120
+
+class MazeQueen;
+
+// This is the physics engine with a few game-specific queries on top of it.
+// It doesn't know anything about rendering or Android, so it can be simulated headless.
+class PhysicsWorld : public PlanarPhysics::Engine
+{
+public:
+    PhysicsWorld();
+    virtual ~PhysicsWorld();
+
+    bool IsMazeSolved();
+    int GetGoodMazeBlockCount();
+    int GetGoodMazeBlockTouchedCount();
+    bool QueenDeadOrNonExistent();
+    MazeQueen* FindTheQueen();
+
+    void CountBallCollision() { this->ballCollisionCount++; }
+    int GetBallCollisionCount() const { return this->ballCollisionCount; }
+
+    void CountEvilBlockReset() { this->evilBlockResetCount++; }
+    int GetEvilBlockResetCount() const { return this->evilBlockResetCount; }
+
+    void ResetStats();
+
+private:
+    int ballCollisionCount;
+    int evilBlockResetCount;
+};
\ No newline at end of file
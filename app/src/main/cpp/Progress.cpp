@@ -1,10 +1,15 @@
 #include "Progress.h"
+#include "AsyncFileWriter.h"
+#include "BinaryRecord.h"
 #include "AndroidOut.h"
 #include "JsonValue.h"
-#include <game-activity/native_app_glue/android_native_app_glue.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 using namespace ParseParty;
 
@@ -24,28 +29,106 @@ void Progress::Reset()
     this->seedModifier = (int)::time(nullptr);
 }
 
-bool Progress::Load(android_app* app)
+bool Progress::Load(const std::string& dataFolder)
 {
-    char progressFile[256];
-    this->GetProgressFilepath(app, progressFile, sizeof(progressFile));
-    FILE* fp = fopen(progressFile, "r");
-    if(!fp)
+    this->progressFile = dataFolder + "/progress.bin";
+    if(this->LoadFile(this->progressFile))
+        return true;
+
+    // If there's a record but it's no good, we start over, rather than fall back on whatever old JSON might still be around.
+    struct stat fileStat;
+    if(0 == ::stat(this->progressFile.c_str(), &fileStat) || errno != ENOENT)
     {
-        this->Reset();
-        return this->Save(app);
+        aout << "Failed to load progress from " << this->progressFile << "." << std::endl;
+        return false;
     }
 
+    // Progress saved before we went binary is still in JSON.
+    std::string jsonFile = dataFolder + "/progress.json";
+    FILE* fp = fopen(jsonFile.c_str(), "r");
+    if(!fp)
+        return false;
+
     fseek(fp, 0, SEEK_END);
     size_t progressJsonBufSize = ftell(fp);
-    char* progressJsonBuf = new char[progressJsonBufSize + 1];
+    std::string progressJsonStr(progressJsonBufSize, '\0');
     fseek(fp, 0, SEEK_SET);
-    fread(progressJsonBuf, progressJsonBufSize, 1, fp);
-    progressJsonBuf[progressJsonBufSize] = '\0';
-    std::string parseError;
-    std::unique_ptr<JsonValue> jsonData(JsonValue::ParseJson(progressJsonBuf, parseError));
-    delete[] progressJsonBuf;
+    if(progressJsonBufSize > 0)
+        fread(&progressJsonStr[0], progressJsonBufSize, 1, fp);
     fclose(fp);
 
+    if(!this->ImportJson(progressJsonStr))
+        return false;
+
+    aout << "Imported progress from " << jsonFile << "." << std::endl;
+
+    // The JSON only goes once the progress it held is safely in a record, and from then on it can never be imported
+    // over newer progress.  This only ever happens once, so it's not worth handing off to the file writer.
+    std::string fileData;
+    this->PackRecord(fileData);
+    if(!AsyncFileWriter::WriteFileAtomically(this->progressFile, fileData.data(), fileData.size()))
+        aout << "Failed to write imported progress to " << this->progressFile << "." << std::endl;
+    else if(0 != ::unlink(jsonFile.c_str()))
+        aout << "Failed to remove " << jsonFile << "." << std::endl;
+
+    return true;
+}
+
+void Progress::Save(AsyncFileWriter& fileWriter) const
+{
+    if(this->progressFile.length() == 0)
+    {
+        aout << "Progress can't be saved before it's been loaded." << std::endl;
+        return;
+    }
+
+    Record record{};
+    this->MakeRecord(record);
+
+    fileWriter.Write(this->progressFile, [record](std::string& fileData) -> bool
+    {
+        BinaryRecord::Pack(PROGRESS_MAGIC, PROGRESS_VERSION, &record, sizeof(Record), fileData);
+        return true;
+    });
+}
+
+bool Progress::LoadFile(const std::string& recordFile)
+{
+    Record record{};
+    this->MakeRecord(record);
+
+    if(!BinaryRecord::ReadFile(recordFile, PROGRESS_MAGIC, PROGRESS_VERSION, &record, sizeof(Record)))
+        return false;
+
+    this->ApplyRecord(record);
+    return true;
+}
+
+void Progress::PackRecord(std::string& fileData) const
+{
+    Record record{};
+    this->MakeRecord(record);
+    BinaryRecord::Pack(PROGRESS_MAGIC, PROGRESS_VERSION, &record, sizeof(Record), fileData);
+}
+
+void Progress::MakeRecord(Record& record) const
+{
+    record.level = this->level;
+    record.touches = this->touches;
+    record.seedModifier = this->seedModifier;
+}
+
+void Progress::ApplyRecord(const Record& record)
+{
+    this->level = record.level;
+    this->touches = record.touches;
+    this->seedModifier = record.seedModifier;
+}
+
+bool Progress::ImportJson(const std::string& jsonString)
+{
+    std::string parseError;
+    std::unique_ptr<JsonValue> jsonData(JsonValue::ParseJson(jsonString, parseError));
     if(!jsonData)
     {
         aout << "Failed to parse progress file!" << std::endl;
@@ -87,42 +170,22 @@ bool Progress::Load(android_app* app)
     return true;
 }
 
-bool Progress::Save(android_app* app)
+bool Progress::ExportJson(std::string& jsonString) const
 {
-    char progressFile[256];
-    this->GetProgressFilepath(app, progressFile, sizeof(progressFile));
-    FILE* fp = fopen(progressFile, "w");
-    if(!fp)
-    {
-        aout << "Failed to open progress file (" << progressFile << ") for writing." << std::endl;
-        return false;
-    }
-
     std::shared_ptr<JsonObject> jsonObject(new JsonObject());
     jsonObject->SetValue("level", new JsonInt(this->level));
     jsonObject->SetValue("touches", new JsonInt(this->touches));
     jsonObject->SetValue("seed_mod", new JsonInt(this->seedModifier));
 
-    std::string jsonString;
     if(!jsonObject->PrintJson(jsonString))
     {
         aout << "Failed to generate JSON string." << std::endl;
-        fclose(fp);
         return false;
     }
 
-    fwrite(jsonString.c_str(), jsonString.length(), 1, fp);
-    fclose(fp);
     return true;
 }
 
-void Progress::GetProgressFilepath(android_app* app, char* progressFilepath, int progressFilepathSize)
-{
-    ::memset(progressFilepath, 0, progressFilepathSize);
-    const char* dataFolder = app->activity->internalDataPath;
-    sprintf(progressFilepath, "%s/progress.json", dataFolder);
-}
-
 int Progress::GetLevel() const
 {
     return this->level;
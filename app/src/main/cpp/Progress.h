@@ -1,15 +1,48 @@
 #pragma once
 
-struct android_app;
+#include <stdint.h>
+#include <string>
 
+#define PROGRESS_MAGIC          0x52504D47      // "GMPR" when read as little-endian bytes.
+#define PROGRESS_VERSION        1
+
+class AsyncFileWriter;
+
+// This is kept in memory for the whole run.  It's read from storage once, at startup, and every
+// save after that goes out through the file writer, so the game never waits on storage for it.
+//
+// It's stored as a binary record (see BinaryRecord).  JSON is still understood, though: a
+// progress.json is imported if there's no binary progress file at all, which is how progress
+// from before the binary format carries over, and then it's removed.  SaveDataTool converts
+// either way for debugging.
 class Progress
 {
 public:
     Progress();
     virtual ~Progress();
 
-    bool Load(android_app* app);
-    bool Save(android_app* app);
+    // This is how progress is laid out on storage.  New fields only ever go on the end.
+    struct Record
+    {
+        int32_t level;
+        int32_t touches;
+        int32_t seedModifier;
+    };
+
+    // This returns false if there was no progress to load, or it was no good.
+    bool Load(const std::string& dataFolder);
+
+    // Only a copy of the progress goes to the writer, so this can be called as often as we like, and changes made
+    // after it returns won't leak into the write.
+    void Save(AsyncFileWriter& fileWriter) const;
+
+    // These work with any file path or string so that we can use them from host tools too.
+    bool LoadFile(const std::string& recordFile);
+    void PackRecord(std::string& fileData) const;
+    bool ImportJson(const std::string& jsonString);
+    bool ExportJson(std::string& jsonString) const;
+    void MakeRecord(Record& record) const;
+    void ApplyRecord(const Record& record);
 
     void Reset();
 
@@ -23,8 +56,7 @@ public:
 
 private:
 
-    void GetProgressFilepath(android_app* app, char* progressFilepath, int progressFilepathSize);
-
+    std::string progressFile;
     int level;
     int touches;
     int seedModifier;
@@ -0,0 +1,95 @@
+#include "RandomGenerator.h"
+#include <math.h>
+
+using namespace PlanarPhysics;
+
+static inline uint64_t RotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t SplitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+RandomGenerator::RandomGenerator()
+{
+    this->Seed(0);
+}
+
+RandomGenerator::RandomGenerator(uint64_t seed)
+{
+    this->Seed(seed);
+}
+
+/*virtual*/ RandomGenerator::~RandomGenerator()
+{
+}
+
+void RandomGenerator::Seed(uint64_t seed)
+{
+    // Splitmix guarantees we never end up with the all-zero state, which xoshiro can't escape from.
+    for(int i = 0; i < 4; i++)
+        this->state[i] = SplitMix64(seed);
+}
+
+uint64_t RandomGenerator::Next()
+{
+    uint64_t result = RotateLeft(this->state[1] * 5, 7) * 9;
+    uint64_t t = this->state[1] << 17;
+
+    this->state[2] ^= this->state[0];
+    this->state[3] ^= this->state[1];
+    this->state[1] ^= this->state[2];
+    this->state[0] ^= this->state[3];
+    this->state[2] ^= t;
+    this->state[3] = RotateLeft(this->state[3], 45);
+
+    return result;
+}
+
+int RandomGenerator::Integer(int min, int max)
+{
+    if(max <= min)
+        return min;
+
+    // Reject the few values at the top of the range that would otherwise bias the modulus.
+    uint64_t range = uint64_t(int64_t(max) - int64_t(min)) + 1;
+    uint64_t limit = UINT64_MAX - (UINT64_MAX % range);
+    uint64_t value = 0;
+    do
+    {
+        value = this->Next();
+    }
+    while(value >= limit);
+
+    return int(int64_t(min) + int64_t(value % range));
+}
+
+double RandomGenerator::Number(double min, double max)
+{
+    // Use the top 53 bits, which is exactly the precision of a double.
+    double alpha = double(this->Next() >> 11) * (1.0 / 9007199254740992.0);
+    return min + alpha * (max - min);
+}
+
+Vector2D RandomGenerator::Vector(double minLength, double maxLength)
+{
+    double angle = this->Number(0.0, 2.0 * M_PI);
+    double length = this->Number(minLength, maxLength);
+    return Vector2D(length * ::cos(angle), length * ::sin(angle));
+}
+
+/*static*/ uint64_t RandomGenerator::MixSeed(uint64_t a, uint64_t b /*= 0*/, uint64_t c /*= 0*/)
+{
+    uint64_t x = a;
+    uint64_t seed = SplitMix64(x);
+    x = seed ^ b;
+    seed = SplitMix64(x);
+    x = seed ^ c;
+    return SplitMix64(x);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Math/GeometricAlgebra/Vector2D.h"
+#include <stdint.h>
+#include <vector>
+#include <utility>
+
+// Unlike the global random number generator, each instance of this has its own state,
+// so the same seed always produces the same sequence no matter what any other thread
+// is doing.  This is what lets us reproduce a maze exactly from its seed, generate
+// mazes on worker threads, and get repeatable benchmarks.  Under the hood, this is
+// xoshiro256**, seeded using splitmix64.
+class RandomGenerator
+{
+public:
+    RandomGenerator();
+    RandomGenerator(uint64_t seed);
+    virtual ~RandomGenerator();
+
+    void Seed(uint64_t seed);
+
+    uint64_t Next();
+
+    // Return an integer in the closed interval [min, max].
+    int Integer(int min, int max);
+
+    // Return a number in the half-open interval [min, max).
+    double Number(double min, double max);
+
+    // Return a vector in a random direction with a length in [minLength, maxLength).
+    PlanarPhysics::Vector2D Vector(double minLength, double maxLength);
+
+    template<typename T>
+    void ShuffleArray(std::vector<T>& array)
+    {
+        for(int i = (signed)array.size() - 1; i > 0; i--)
+        {
+            int j = this->Integer(0, i);
+            if(i != j)
+                std::swap(array[i], array[j]);
+        }
+    }
+
+    // Combine the given values into a single, well-mixed seed.
+    static uint64_t MixSeed(uint64_t a, uint64_t b = 0, uint64_t c = 0);
+
+private:
+    uint64_t state[4];
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+
+// This is a wait-free ring buffer for exactly one producer thread and exactly one
+// consumer thread, such as the main thread feeding the real-time audio thread.
+// Neither side ever blocks or spins on the other.  The read and write indices just
+// count up forever and are masked into the buffer, which is why the capacity is
+// always a power of two.  Each index is only ever written by its own side, and the
+// release/acquire pairs make sure the items are visible before the index that
+// publishes them.  All the storage is allocated up front in Setup.
+template<typename T>
+class RingBuffer
+{
+public:
+    RingBuffer()
+    {
+        this->itemArray = nullptr;
+        this->capacity = 0;
+        this->writeIndex = 0;
+        this->readIndex = 0;
+    }
+
+    virtual ~RingBuffer()
+    {
+        delete[] this->itemArray;
+    }
+
+    // The capacity is rounded up to a power of two.  This must not be called while either side is using the buffer.
+    bool Setup(size_t minCapacity)
+    {
+        if(minCapacity == 0)
+            return false;
+
+        size_t newCapacity = 1;
+        while(newCapacity < minCapacity)
+            newCapacity <<= 1;
+
+        delete[] this->itemArray;
+        this->itemArray = new T[newCapacity];
+        this->capacity = newCapacity;
+        this->writeIndex = 0;
+        this->readIndex = 0;
+        return true;
+    }
+
+    // Only the producer may call this.  It returns how many of the given items fit.
+    size_t Write(const T* itemBuf, size_t numItems)
+    {
+        size_t i = this->writeIndex.load(std::memory_order_relaxed);
+        size_t j = this->readIndex.load(std::memory_order_acquire);
+        size_t numFree = this->capacity - (i - j);
+        if(numItems > numFree)
+            numItems = numFree;
+
+        for(size_t k = 0; k < numItems; k++)
+            this->itemArray[(i + k) & (this->capacity - 1)] = itemBuf[k];
+
+        this->writeIndex.store(i + numItems, std::memory_order_release);
+        return numItems;
+    }
+
+    // Only the consumer may call this.  It returns how many items were actually available.
+    size_t Read(T* itemBuf, size_t numItems)
+    {
+        size_t j = this->readIndex.load(std::memory_order_relaxed);
+        size_t i = this->writeIndex.load(std::memory_order_acquire);
+        size_t numAvailable = i - j;
+        if(numItems > numAvailable)
+            numItems = numAvailable;
+
+        for(size_t k = 0; k < numItems; k++)
+            itemBuf[k] = this->itemArray[(j + k) & (this->capacity - 1)];
+
+        this->readIndex.store(j + numItems, std::memory_order_release);
+        return numItems;
+    }
+
+    // Only the consumer may call this.  It copies out the next item without taking it.
+    bool Peek(T& item) const
+    {
+        size_t j = this->readIndex.load(std::memory_order_relaxed);
+        size_t i = this->writeIndex.load(std::memory_order_acquire);
+        if(i == j)
+            return false;
+
+        item = this->itemArray[j & (this->capacity - 1)];
+        return true;
+    }
+
+    bool Push(const T& item) { return this->Write(&item, 1) == 1; }
+    bool Pop(T& item) { return this->Read(&item, 1) == 1; }
+
+    // These are only exact when called from the side that they favor; otherwise, they're just a snapshot.
+    size_t GetReadableCount() const { return this->writeIndex.load(std::memory_order_acquire) - this->readIndex.load(std::memory_order_relaxed); }
+    size_t GetWritableCount() const { return this->capacity - (this->writeIndex.load(std::memory_order_relaxed) - this->readIndex.load(std::memory_order_acquire)); }
+    size_t GetCapacity() const { return this->capacity; }
+
+private:
+    T* itemArray;
+    size_t capacity;
+
+    // Keep the two sides' indices on separate cache lines so that they don't ping-pong between cores.
+    alignas(64) std::atomic<size_t> writeIndex;
+    alignas(64) std::atomic<size_t> readIndex;
+};
\ No newline at end of file
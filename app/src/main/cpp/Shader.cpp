@@ -14,23 +14,41 @@ Shader::Shader(GLenum type)
 }
 
 bool Shader::Load(const char* shaderFile, AAssetManager* assetManager)
+{
+    std::string shaderSource;
+    if(!LoadSource(shaderFile, assetManager, shaderSource))
+        return false;
+
+    return this->Compile(shaderSource);
+}
+
+/*static*/ bool Shader::LoadSource(const char* shaderFile, AAssetManager* assetManager, std::string& shaderSource)
+{
+    AAsset* shaderAsset = AAssetManager_open(assetManager, shaderFile, AASSET_MODE_STREAMING);
+    if(!shaderAsset)
+    {
+        aout << "Failed to load: " << shaderFile << std::endl;
+        return false;
+    }
+
+    const char* shaderBuf = (const char*)AAsset_getBuffer(shaderAsset);
+    size_t shaderBufSize = size_t(AAsset_getLength(shaderAsset));
+    shaderSource.assign(shaderBuf, shaderBufSize);
+
+    AAsset_close(shaderAsset);
+    return true;
+}
+
+bool Shader::Compile(const std::string& shaderSource)
 {
     bool succeeded = false;
 
-    AAsset* shaderAsset = nullptr;
     this->shader = 0;
 
     do
     {
-        shaderAsset = AAssetManager_open(assetManager, shaderFile, AASSET_MODE_STREAMING);
-        if(!shaderAsset)
-        {
-            aout << "Failed to load: " << shaderFile << std::endl;
-            break;
-        }
-
-        const GLchar* shaderBuf = (const GLchar*)AAsset_getBuffer(shaderAsset);
-        GLint shaderBufSize = AAsset_getLength(shaderAsset);
+        const GLchar* shaderBuf = (const GLchar*)shaderSource.data();
+        GLint shaderBufSize = GLint(shaderSource.length());
 
         this->shader = glCreateShader(this->type);
         if(!this->shader)
@@ -61,8 +79,5 @@ bool Shader::Load(const char* shaderFile, AAssetManager* assetManager)
     }
     while(false);
 
-    if(shaderAsset)
-        AAsset_close(shaderAsset);
-
     return succeeded;
 }
\ No newline at end of file
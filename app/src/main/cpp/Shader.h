@@ -2,6 +2,7 @@
 
 #include <android/asset_manager.h>
 #include <GLES3/gl3.h>
+#include <string>
 
 class Shader
 {
@@ -12,6 +13,9 @@ public:
     virtual ~Shader();
 
     bool Load(const char* shaderFile, AAssetManager* assetManager);
+    bool Compile(const std::string& shaderSource);
+
+    static bool LoadSource(const char* shaderFile, AAssetManager* assetManager, std::string& shaderSource);
 
 private:
     GLuint shader;
@@ -1,10 +1,18 @@
 #include "AndroidOut.h"
 #include "ShaderProgram.h"
 #include "Shader.h"
+#include "AsyncFileWriter.h"
+#include "Checksum.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
 
 ShaderProgram::ShaderProgram()
 {
     this->program = 0;
+    this->fromCache = false;
 }
 
 /*virtual*/ ShaderProgram::~ShaderProgram()
@@ -12,48 +20,51 @@ ShaderProgram::ShaderProgram()
     this->Clear();
 }
 
-bool ShaderProgram::Load(const char* fragShaderFile, const char* vertShaderFile, AAssetManager* assetManager)
+bool ShaderProgram::Load(const char* fragShaderFile, const char* vertShaderFile, AAssetManager* assetManager, const std::string& cacheFile /*= ""*/)
 {
     bool success = false;
 
     this->Clear();
 
+    std::string fragShaderSource;
+    std::string vertShaderSource;
+
     Shader fragShader(GL_FRAGMENT_SHADER);
     Shader vertShader(GL_VERTEX_SHADER);
 
     do
     {
-        if(!fragShader.Load(fragShaderFile, assetManager))
-            break;
-
-        if(!vertShader.Load(vertShaderFile, assetManager))
+        if(!Shader::LoadSource(fragShaderFile, assetManager, fragShaderSource))
             break;
 
-        this->program = glCreateProgram();
-        if(!this->program)
+        if(!Shader::LoadSource(vertShaderFile, assetManager, vertShaderSource))
             break;
 
-        glAttachShader(this->program, vertShader.shader);
-        glAttachShader(this->program, fragShader.shader);
-
-        glLinkProgram(this->program);
-
-        GLint linkStatus = GL_FALSE;
-        glGetProgramiv(this->program, GL_LINK_STATUS, &linkStatus);
-        if(linkStatus != GL_TRUE)
+        bool useCache = (cacheFile.length() > 0);
+        uint32_t driverChecksum = 0;
+        uint32_t sourceChecksum = 0;
+        if(useCache)
         {
-            GLint logLength = 0;
-            glGetProgramiv(this->program, GL_INFO_LOG_LENGTH, &logLength);
-            if(logLength > 0)
+            driverChecksum = CalcDriverChecksum();
+            sourceChecksum = CalcCrc32(vertShaderSource.data(), vertShaderSource.length());
+            sourceChecksum = CalcCrc32(fragShaderSource.data(), fragShaderSource.length(), sourceChecksum);
+
+            if(this->LoadCache(cacheFile, driverChecksum, sourceChecksum))
             {
-                GLchar* logBuf = new GLchar[logLength];
-                glGetProgramInfoLog(this->program, logLength, nullptr, logBuf);
-                aout << "Failed to link shader program: " << logBuf << std::endl;
-                delete[] logBuf;
+                this->fromCache = true;
+                success = true;
+                break;
             }
+        }
 
+        if(!fragShader.Compile(fragShaderSource))
+            break;
+
+        if(!vertShader.Compile(vertShaderSource))
+            break;
+
+        if(!this->Link(vertShader, fragShader, useCache))
             break;
-        }
 
         aout << "Dump of attributes..." << std::endl;
         GLint numAttribs = 0;
@@ -68,6 +79,10 @@ bool ShaderProgram::Load(const char* fragShaderFile, const char* vertShaderFile,
             aout << "Attribute " << i << " is \"" << attribNameBuf << " of type " << GLint(attribType) << " and size " << attribSize << "." << std::endl;
         }
 
+        // Not being able to cache the program doesn't stop us from using it.
+        if(useCache && !this->SaveCache(cacheFile, driverChecksum, sourceChecksum))
+            aout << "Failed to cache shader program in " << cacheFile << "." << std::endl;
+
         success = true;
     }
     while(false);
@@ -78,6 +93,167 @@ bool ShaderProgram::Load(const char* fragShaderFile, const char* vertShaderFile,
     return success;
 }
 
+bool ShaderProgram::Link(const Shader& vertShader, const Shader& fragShader, bool retrievable)
+{
+    this->program = glCreateProgram();
+    if(!this->program)
+        return false;
+
+    glAttachShader(this->program, vertShader.shader);
+    glAttachShader(this->program, fragShader.shader);
+
+    // This tells the driver we'll be asking for the binary, so that it's sure to keep it around for us.
+    if(retrievable)
+        glProgramParameteri(this->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    glLinkProgram(this->program);
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(this->program, GL_LINK_STATUS, &linkStatus);
+    if(linkStatus != GL_TRUE)
+    {
+        GLint logLength = 0;
+        glGetProgramiv(this->program, GL_INFO_LOG_LENGTH, &logLength);
+        if(logLength > 0)
+        {
+            GLchar* logBuf = new GLchar[logLength];
+            glGetProgramInfoLog(this->program, logLength, nullptr, logBuf);
+            aout << "Failed to link shader program: " << logBuf << std::endl;
+            delete[] logBuf;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+bool ShaderProgram::LoadCache(const std::string& cacheFile, uint32_t driverChecksum, uint32_t sourceChecksum)
+{
+    bool success = false;
+    int fd = -1;
+    GLuint cachedProgram = 0;
+
+    do
+    {
+        fd = ::open(cacheFile.c_str(), O_RDONLY);
+        if(fd < 0)
+            break;
+
+        struct stat fileStat;
+        if(0 != ::fstat(fd, &fileStat) || fileStat.st_size < (off_t)sizeof(CacheHeader))
+            break;
+
+        std::vector<uint8_t> fileBuf(size_t(fileStat.st_size));
+        if(ssize_t(fileBuf.size()) != ::pread(fd, fileBuf.data(), fileBuf.size(), 0))
+            break;
+
+        CacheHeader header;
+        ::memcpy(&header, fileBuf.data(), sizeof(CacheHeader));
+
+        if(header.magic != SHADER_PROGRAM_CACHE_MAGIC || header.version != SHADER_PROGRAM_CACHE_VERSION || header.headerSize != sizeof(CacheHeader))
+            break;
+
+        if(header.driverChecksum != driverChecksum || header.sourceChecksum != sourceChecksum)
+        {
+            aout << "Shader program cache " << cacheFile << " is for another driver or other source." << std::endl;
+            break;
+        }
+
+        const uint8_t* binaryBuf = fileBuf.data() + sizeof(CacheHeader);
+        if(header.binarySize != fileBuf.size() - sizeof(CacheHeader) || header.binaryChecksum != CalcCrc32(binaryBuf, header.binarySize))
+        {
+            aout << "Shader program cache " << cacheFile << " is corrupt." << std::endl;
+            break;
+        }
+
+        cachedProgram = glCreateProgram();
+        if(!cachedProgram)
+            break;
+
+        // The driver is free to turn the binary down even if it made it, so this is the check that really counts.
+        glProgramBinary(cachedProgram, GLenum(header.binaryFormat), binaryBuf, GLsizei(header.binarySize));
+
+        GLint linkStatus = GL_FALSE;
+        glGetProgramiv(cachedProgram, GL_LINK_STATUS, &linkStatus);
+        if(linkStatus != GL_TRUE)
+        {
+            aout << "Driver wouldn't take the shader program binary cached in " << cacheFile << "." << std::endl;
+            break;
+        }
+
+        this->program = cachedProgram;
+        cachedProgram = 0;
+        success = true;
+    }
+    while(false);
+
+    if(cachedProgram)
+        glDeleteProgram(cachedProgram);
+
+    if(fd >= 0)
+        ::close(fd);
+
+    return success;
+}
+
+bool ShaderProgram::SaveCache(const std::string& cacheFile, uint32_t driverChecksum, uint32_t sourceChecksum) const
+{
+    GLint numBinaryFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+    if(numBinaryFormats <= 0)
+    {
+        aout << "Driver doesn't support shader program binaries." << std::endl;
+        return false;
+    }
+
+    GLint binarySize = 0;
+    glGetProgramiv(this->program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+    if(binarySize <= 0)
+        return false;
+
+    std::string fileData;
+    fileData.resize(sizeof(CacheHeader) + size_t(binarySize));
+
+    GLsizei writtenSize = 0;
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(this->program, binarySize, &writtenSize, &binaryFormat, &fileData[sizeof(CacheHeader)]);
+    if(writtenSize <= 0)
+        return false;
+
+    fileData.resize(sizeof(CacheHeader) + size_t(writtenSize));
+
+    CacheHeader header;
+    ::memset(&header, 0, sizeof(CacheHeader));
+    header.magic = SHADER_PROGRAM_CACHE_MAGIC;
+    header.version = SHADER_PROGRAM_CACHE_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.driverChecksum = driverChecksum;
+    header.sourceChecksum = sourceChecksum;
+    header.binaryFormat = uint32_t(binaryFormat);
+    header.binarySize = uint32_t(writtenSize);
+    header.binaryChecksum = CalcCrc32(&fileData[sizeof(CacheHeader)], size_t(writtenSize));
+    ::memcpy(&fileData[0], &header, sizeof(CacheHeader));
+
+    // This only happens when the cache misses, which is rare enough that it's not worth handing off to a writer thread.
+    return AsyncFileWriter::WriteFileAtomically(cacheFile, fileData.data(), fileData.size());
+}
+
+/*static*/ uint32_t ShaderProgram::CalcDriverChecksum()
+{
+    uint32_t checksum = 0;
+
+    const GLenum nameArray[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for(GLenum name : nameArray)
+    {
+        const char* value = (const char*)glGetString(name);
+        if(value)
+            checksum = CalcCrc32(value, ::strlen(value) + 1, checksum);
+    }
+
+    return checksum;
+}
+
 void ShaderProgram::Clear()
 {
     if(this->program)
@@ -85,6 +261,11 @@ void ShaderProgram::Clear()
         glDeleteProgram(this->program);
         this->program = 0;
     }
+
+    // Locations belong to the program they were looked up in.
+    this->attributeMap.clear();
+    this->uniformMap.clear();
+    this->fromCache = false;
 }
 
 void ShaderProgram::Bind()
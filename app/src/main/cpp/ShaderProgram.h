@@ -2,23 +2,57 @@
 
 #include <android/asset_manager.h>
 #include <GLES3/gl3.h>
+#include <stdint.h>
+#include <string>
 #include <unordered_map>
 
+#define SHADER_PROGRAM_CACHE_MAGIC          0x50534D47      // "GMSP" when read as little-endian bytes.
+#define SHADER_PROGRAM_CACHE_VERSION        1
+
+class Shader;
+
+// Our window, and with it our GL context, goes away every time the app goes into the background,
+// so our shaders get built all over again every time it comes back.  To save on that, a program
+// can be given a cache file, where it keeps the binary the driver linked it into.  A binary is
+// only good for the driver that made it and the source it was made from, so the cache is stamped
+// with checksums of both, and if either doesn't match (or the driver won't take the binary back
+// for its own reasons), we just compile and link from source as usual and cache the new binary.
 class ShaderProgram
 {
 public:
     ShaderProgram();
     virtual ~ShaderProgram();
 
-    bool Load(const char* fragShaderFile, const char* vertShaderFile, AAssetManager* assetManager);
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t driverChecksum;        // This covers the GL vendor, renderer and version strings.
+        uint32_t sourceChecksum;        // This covers the vertex shader source and then the fragment shader source.
+        uint32_t binaryFormat;
+        uint32_t binarySize;
+        uint32_t binaryChecksum;
+    };
+
+    bool Load(const char* fragShaderFile, const char* vertShaderFile, AAssetManager* assetManager, const std::string& cacheFile = "");
     void Clear();
     void Bind();
 
     GLint GetAttributeLocation(const std::string& attribName);
     GLint GetUniformLocation(const std::string& uniformName);
 
+    bool IsFromCache() const { return this->fromCache; }
+
+    static uint32_t CalcDriverChecksum();
+
 private:
+    bool Link(const Shader& vertShader, const Shader& fragShader, bool retrievable);
+    bool LoadCache(const std::string& cacheFile, uint32_t driverChecksum, uint32_t sourceChecksum);
+    bool SaveCache(const std::string& cacheFile, uint32_t driverChecksum, uint32_t sourceChecksum) const;
+
     GLuint program;
+    bool fromCache;
 
     std::unordered_map<std::string, GLint> attributeMap;
     std::unordered_map<std::string, GLint> uniformMap;
@@ -0,0 +1,85 @@
+#include "SolverBot.h"
+#include "Maze.h"
+#include "PhysicsWorld.h"
+#include "MazeObjects/MazeBall.h"
+#include "MazeObjects/MazeBlock.h"
+
+using namespace PlanarPhysics;
+
+// How often we re-run the BFS, even if nothing seems to have changed.  The ball
+// can get knocked off the path by blocks or the worm, so we don't want to trust
+// a stale plan for too long.
+#define SOLVER_BOT_REPLAN_STEPS     30
+
+SolverBot::SolverBot(const Maze* maze, PhysicsWorld* physicsWorld)
+{
+    this->maze = maze;
+    this->physicsWorld = physicsWorld;
+    this->pathOffset = 0;
+    this->stepsSinceReplan = SOLVER_BOT_REPLAN_STEPS;
+}
+
+/*virtual*/ SolverBot::~SolverBot()
+{
+}
+
+MazeBall* SolverBot::FindTheBall()
+{
+    for(auto planarObject : this->physicsWorld->GetPlanarObjectArray())
+    {
+        auto mazeBall = dynamic_cast<MazeBall*>(planarObject);
+        if(mazeBall)
+            return mazeBall;
+    }
+
+    return nullptr;
+}
+
+bool SolverBot::Replan(const PlanarPhysics::Vector2D& ballPosition)
+{
+    std::vector<Vector2D> goalPointArray;
+    for(auto planarObject : this->physicsWorld->GetPlanarObjectArray())
+    {
+        auto goodMazeBlock = dynamic_cast<GoodMazeBlock*>(planarObject);
+        if(goodMazeBlock && !goodMazeBlock->IsTouched())
+            goalPointArray.push_back(goodMazeBlock->GetPosition());
+    }
+
+    this->pathOffset = 0;
+    this->stepsSinceReplan = 0;
+
+    return this->maze->FindPathToNearestGoal(ballPosition, goalPointArray, this->pathArray);
+}
+
+Vector2D SolverBot::ChooseGravity(double gravityMagnitude)
+{
+    MazeBall* mazeBall = this->FindTheBall();
+    if(!mazeBall)
+        return Vector2D(0.0, 0.0);
+
+    if(this->stepsSinceReplan++ >= SOLVER_BOT_REPLAN_STEPS || this->pathOffset >= (signed)this->pathArray.size())
+    {
+        if(!this->Replan(mazeBall->position))
+            return Vector2D(0.0, 0.0);
+    }
+
+    // Advance along the path as we arrive at each cell center.  Skipping the first
+    // point is fine, because that's just the cell the ball is already in.
+    while(this->pathOffset < (signed)this->pathArray.size() - 1)
+    {
+        Vector2D delta = this->pathArray[this->pathOffset] - mazeBall->position;
+        if(delta.Magnitude() > MAZE_CELL_SIZE / 4.0)
+            break;
+
+        this->pathOffset++;
+    }
+
+    const Vector2D& targetPoint = this->pathArray[this->pathOffset];
+
+    // Pull toward the target and push against the current velocity so that we don't just go flying past it.
+    Vector2D steering = (targetPoint - mazeBall->position) * 8.0 - mazeBall->velocity * 2.0;
+    if(!steering.Normalize())
+        return Vector2D(0.0, 0.0);
+
+    return steering * gravityMagnitude;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Math/GeometricAlgebra/Vector2D.h"
+#include <vector>
+
+class Maze;
+class PhysicsWorld;
+class MazeBall;
+
+// The bot plays a level the way a person tilting the phone would: by choosing
+// a gravity vector each step.  It does a BFS over the maze graph toward the
+// nearest untouched good block and then steers the ball along that path with
+// a simple spring/damper.  It's not clever, but it's deterministic, and that's
+// what makes it useful as a load generator for the physics and game logic.
+class SolverBot
+{
+public:
+    SolverBot(const Maze* maze, PhysicsWorld* physicsWorld);
+    virtual ~SolverBot();
+
+    PlanarPhysics::Vector2D ChooseGravity(double gravityMagnitude);
+
+private:
+    MazeBall* FindTheBall();
+    bool Replan(const PlanarPhysics::Vector2D& ballPosition);
+
+    const Maze* maze;
+    PhysicsWorld* physicsWorld;
+    std::vector<PlanarPhysics::Vector2D> pathArray;
+    int pathOffset;
+    int stepsSinceReplan;
+};
\ No newline at end of file
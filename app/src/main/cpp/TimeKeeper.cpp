@@ -1,8 +1,9 @@
 #include "TimeKeeper.h"
+#include <errno.h>
 
 TimeKeeper::TimeKeeper()
 {
-    this->lastTime = 0;
+    this->lastTimeNanoseconds = 0;
     this->elapsedTimeSeconds = 0.0;
     this->frameRateFPS = 0.0;
 }
@@ -13,17 +14,34 @@ TimeKeeper::TimeKeeper()
 
 void TimeKeeper::Tick()
 {
-    clock_t currentTime = ::clock();
+    int64_t currentTimeNanoseconds = GetTimeNanoseconds();
 
     this->elapsedTimeSeconds = 0.0;
     this->frameRateFPS = 0.0;
 
-    if(this->lastTime != 0)
+    // This used to go by clock(), but that's CPU time, which stops counting as soon as a thread sleeps.
+    if(this->lastTimeNanoseconds != 0 && currentTimeNanoseconds > this->lastTimeNanoseconds)
     {
-        // I'm not sure how accurate this is on Android.  It seems wrong.
-        this->elapsedTimeSeconds = double(currentTime - this->lastTime) / double(CLOCKS_PER_SEC);
+        this->elapsedTimeSeconds = double(currentTimeNanoseconds - this->lastTimeNanoseconds) / 1e9;
         this->frameRateFPS = 1.0 / elapsedTimeSeconds;
     }
 
-    this->lastTime = currentTime;
+    this->lastTimeNanoseconds = currentTimeNanoseconds;
+}
+
+/*static*/ int64_t TimeKeeper::GetTimeNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000000000 + int64_t(now.tv_nsec);
+}
+
+/*static*/ void TimeKeeper::SleepUntil(int64_t timeNanoseconds)
+{
+    struct timespec wakeTime;
+    wakeTime.tv_sec = time_t(timeNanoseconds / 1000000000);
+    wakeTime.tv_nsec = long(timeNanoseconds % 1000000000);
+    while(::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, nullptr) == EINTR)
+    {
+    }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdint.h>
 #include <time.h>
 
 class TimeKeeper
@@ -13,8 +14,14 @@ public:
     double GetElapsedTimeSeconds() { return this->elapsedTimeSeconds; }
     double GetFrameRate() { return this->frameRateFPS; }
 
+    // This is the monotonic clock, which (unlike the CPU clock) keeps counting while we sleep.
+    static int64_t GetTimeNanoseconds();
+
+    // Sleeping until an absolute time means time spent working before the sleep doesn't push the wake-up later.
+    static void SleepUntil(int64_t timeNanoseconds);
+
 private:
-    clock_t lastTime;
+    int64_t lastTimeNanoseconds;
     double elapsedTimeSeconds;
     double frameRateFPS;
 };
\ No newline at end of file
@@ -0,0 +1,211 @@
+// This is a host-side benchmark for the audio mixer.  It drives the mixer through the offline
+// output, a burst at a time, exactly as the audio callback on a device would, while keeping a
+// given number of voices playing the whole time.  The clips come from the game's own assets
+// and go through the same conversion they do on a device.
+//
+// Usage: AudioMixerBench [numVoices] [seconds] [framesPerBurst] [numChannels] [int16|int32|float] [maxLoad] [outputWavPath]
+//
+// This prints the cost per burst (average, 99th percentile and worst case) as CSV, along with
+// how much of each burst's real-time budget that is.  It exits with a non-zero status if the
+// 99th percentile burst takes more than maxLoad of its budget.  If an output path is given,
+// everything that was mixed is written there as a WAV file so that it can be listened to.
+
+#include "AudioMixer.h"
+#include "AudioConverter.h"
+#include "OfflineAudioOutput.h"
+#include "WaveFile.h"
+#include "RandomGenerator.h"
+#include <android/asset_manager.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#define AUDIO_MIXER_BENCH_FRAMES_PER_SECOND     48000
+
+// The build points this at the app's assets; otherwise, we look for them in the working directory.
+#ifndef AUDIO_MIXER_BENCH_ASSET_DIR
+#   define AUDIO_MIXER_BENCH_ASSET_DIR          "assets"
+#endif
+
+struct BenchClip
+{
+    std::vector<int16_t> sampleArray;
+    AudioMixer::Sound sound;
+};
+
+static bool LoadClips(uint32_t numChannels, std::vector<BenchClip>& clipArray)
+{
+    AAssetManager* assetManager = HostAssetManager_Create(AUDIO_MIXER_BENCH_ASSET_DIR);
+    if(!assetManager)
+        return false;
+
+    AudioConverter converter;
+
+    AAssetDir* audioDir = AAssetManager_openDir(assetManager, "audio");
+    if(audioDir)
+    {
+        const char* fileName = nullptr;
+        while((fileName = AAssetDir_getNextFileName(audioDir)) != nullptr)
+        {
+            std::string filePath = std::string("audio/") + fileName;
+            AAsset* asset = AAssetManager_open(assetManager, filePath.c_str(), AASSET_MODE_BUFFER);
+            if(!asset)
+                continue;
+
+            WaveFile waveFile;
+            BenchClip clip;
+            if(waveFile.Parse((const uint8_t*)AAsset_getBuffer(asset), size_t(AAsset_getLength(asset))) &&
+               converter.Convert(waveFile, AUDIO_MIXER_BENCH_FRAMES_PER_SECOND, numChannels, clip.sampleArray) &&
+               clip.sampleArray.size() >= numChannels)
+            {
+                clipArray.push_back(std::move(clip));
+            }
+
+            AAsset_close(asset);
+        }
+
+        AAssetDir_close(audioDir);
+    }
+
+    HostAssetManager_Destroy(assetManager);
+    return clipArray.size() > 0;
+}
+
+static void SynthesizeClip(uint32_t numChannels, std::vector<BenchClip>& clipArray)
+{
+    // With no assets around, a second of a decaying tone is as good as anything to mix.
+    BenchClip clip;
+    uint32_t numFrames = AUDIO_MIXER_BENCH_FRAMES_PER_SECOND;
+    clip.sampleArray.resize(numFrames * numChannels);
+    for(uint32_t i = 0; i < numFrames; i++)
+    {
+        double t = double(i) / double(AUDIO_MIXER_BENCH_FRAMES_PER_SECOND);
+        auto sample = int16_t(::lrint(16000.0 * ::exp(-3.0 * t) * ::sin(2.0 * M_PI * 440.0 * t)));
+        for(uint32_t j = 0; j < numChannels; j++)
+            clip.sampleArray[i * numChannels + j] = sample;
+    }
+
+    clipArray.push_back(std::move(clip));
+}
+
+static bool FindSampleFormat(const char* name, AudioMixer::SampleFormat& sampleFormat)
+{
+    if(::strcmp(name, "int16") == 0)
+        sampleFormat = AudioMixer::SampleFormat::INT16;
+    else if(::strcmp(name, "int32") == 0)
+        sampleFormat = AudioMixer::SampleFormat::INT32;
+    else if(::strcmp(name, "float") == 0)
+        sampleFormat = AudioMixer::SampleFormat::FLOAT;
+    else
+        return false;
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int numVoices = (argc > 1) ? ::atoi(argv[1]) : 16;
+    double seconds = (argc > 2) ? ::atof(argv[2]) : 10.0;
+    int framesPerBurst = (argc > 3) ? ::atoi(argv[3]) : 192;
+    int numChannels = (argc > 4) ? ::atoi(argv[4]) : 2;
+    const char* formatName = (argc > 5) ? argv[5] : "float";
+    double maxLoad = (argc > 6) ? ::atof(argv[6]) : 0.25;
+    const char* outputPath = (argc > 7) ? argv[7] : nullptr;
+
+    AudioMixer::SampleFormat sampleFormat;
+    if(numVoices < 1 || seconds <= 0.0 || framesPerBurst < 1 || numChannels < 1 || !FindSampleFormat(formatName, sampleFormat))
+    {
+        fprintf(stderr, "Usage: %s [numVoices] [seconds] [framesPerBurst] [numChannels] [int16|int32|float] [maxLoad] [outputWavPath]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<BenchClip> clipArray;
+    if(!LoadClips(uint32_t(numChannels), clipArray))
+    {
+        fprintf(stderr, "Couldn't load any clips from " AUDIO_MIXER_BENCH_ASSET_DIR "/audio, so a synthesized one will be used instead.\n");
+        SynthesizeClip(uint32_t(numChannels), clipArray);
+    }
+
+    for(BenchClip& clip : clipArray)
+    {
+        clip.sound.sampleBuf = clip.sampleArray.data();
+        clip.sound.numFrames = uint32_t(clip.sampleArray.size() / numChannels);
+        clip.sound.numChannels = uint32_t(numChannels);
+    }
+
+    AudioMixer mixer;
+    if(!mixer.Setup(AUDIO_MIXER_BENCH_FRAMES_PER_SECOND, uint32_t(numChannels), sampleFormat, uint32_t(numVoices), uint32_t(framesPerBurst)))
+    {
+        fprintf(stderr, "Failed to set up the mixer.\n");
+        return 1;
+    }
+
+    OfflineAudioOutput output;
+    if(!output.Setup(&mixer, uint32_t(framesPerBurst), outputPath != nullptr))
+    {
+        fprintf(stderr, "Failed to set up the offline output.\n");
+        return 1;
+    }
+
+    // We keep track of how much each voice has left so that we can start another sound the
+    // moment one finishes, and the mixer never has fewer than numVoices voices going.
+    RandomGenerator random(RandomGenerator::MixSeed(numVoices, framesPerBurst, numChannels));
+    std::vector<int64_t> framesLeftArray(numVoices, 0);
+    float gain = 1.0f / float(numVoices);
+
+    auto numBursts = uint32_t(::ceil(seconds * double(AUDIO_MIXER_BENCH_FRAMES_PER_SECOND) / double(framesPerBurst)));
+    for(uint32_t i = 0; i < numBursts; i++)
+    {
+        for(int64_t& framesLeft : framesLeftArray)
+        {
+            if(framesLeft <= 0)
+            {
+                const BenchClip& clip = clipArray[random.Integer(0, int(clipArray.size()) - 1)];
+                mixer.Play(&clip.sound, gain);
+                framesLeft = clip.sound.numFrames;
+            }
+
+            framesLeft -= framesPerBurst;
+        }
+
+        output.Render(1);
+    }
+
+    std::vector<double> burstTimeArray = output.GetBurstTimeArray();
+    std::sort(burstTimeArray.begin(), burstTimeArray.end());
+
+    double totalNanoseconds = 0.0;
+    for(double burstTime : burstTimeArray)
+        totalNanoseconds += burstTime;
+
+    double averageNanoseconds = totalNanoseconds / double(burstTimeArray.size());
+    double p99Nanoseconds = burstTimeArray[std::min(burstTimeArray.size() - 1, size_t(0.99 * double(burstTimeArray.size())))];
+    double maxNanoseconds = burstTimeArray.back();
+    double budgetNanoseconds = 1e9 * double(framesPerBurst) / double(AUDIO_MIXER_BENCH_FRAMES_PER_SECOND);
+
+    printf("voices,channels,format,frames_per_burst,bursts,avg_ns_per_burst,p99_ns_per_burst,max_ns_per_burst,ns_per_voice_frame,avg_load,p99_load,stolen,dropped\n");
+    printf("%d,%d,%s,%d,%u,%.0f,%.0f,%.0f,%.2f,%.4f,%.4f,%u,%u\n", numVoices, numChannels, formatName, framesPerBurst, numBursts,
+           averageNanoseconds, p99Nanoseconds, maxNanoseconds, averageNanoseconds / double(numVoices * framesPerBurst),
+           averageNanoseconds / budgetNanoseconds, p99Nanoseconds / budgetNanoseconds, mixer.GetStolenCount(), mixer.GetDroppedCount());
+
+    int result = 0;
+
+    if(outputPath && !output.WriteWaveFile(outputPath))
+    {
+        fprintf(stderr, "Failed to write %s.\n", outputPath);
+        result = 1;
+    }
+
+    if(p99Nanoseconds > maxLoad * budgetNanoseconds)
+    {
+        fprintf(stderr, "The 99th percentile burst took %.0f ns, which is more than %.2f of its %.0f ns budget.\n", p99Nanoseconds, maxLoad, budgetNanoseconds);
+        result = 1;
+    }
+
+    mixer.Shutdown();
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+// This is a host-side tool for playing gravity sample files through the same lookup the game
+// uses on a device, headless, so that tilting can be tested and replayed without a phone.
+//
+// Usage: GravityTrackRunner record <sampleFile> [level] [seed] [sensorHz] [jitterMs] [maxSteps]
+//        GravityTrackRunner replay <sampleFile> [level] [seed] [predictionSeconds] [maxSteps]
+//
+// Record has the solver bot play a level and writes out the gravity it chose as if a sensor had
+// sampled it, at the given rate with the given timing jitter.  Replay plays a level with gravity
+// taken from a sample file, one physics step every 1/GAME_LOGIC_TICKS_PER_SECOND seconds, where
+// each sample only becomes visible once its time has come, and each step looks gravity up a sensor
+// period behind its own time, just as on a device.  Files recorded on a device (see the
+// record_gravity_samples option) can be replayed the same way.
+//
+// Replay prints what happened as CSV, along with how each step's gravity was found and a checksum
+// of all of it, which is the same every time a given file, level and seed are replayed.
+
+#include "Maze.h"
+#include "PhysicsWorld.h"
+#include "SolverBot.h"
+#include "GravityTrack.h"
+#include "RandomGenerator.h"
+#include "Checksum.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+using namespace PlanarPhysics;
+
+// These match the game's default gravity option and the aspect ratio the headless runner sizes mazes with.
+#define GRAVITY_TRACK_RUNNER_GRAVITY            980.0
+#define GRAVITY_TRACK_RUNNER_ASPECT_RATIO       0.5
+
+static void SetupLevel(Maze& maze, PhysicsWorld& physicsWorld, int level, int seed)
+{
+    int rows = 0, cols = 0;
+    Maze::CalcLevelSize(level, GRAVITY_TRACK_RUNNER_ASPECT_RATIO, rows, cols);
+
+    RandomGenerator random(RandomGenerator::MixSeed(rows, cols, seed));
+    maze.Generate(rows, cols, random, Maze::Topology::RECTANGULAR);
+    maze.PopulatePhysicsWorld(&physicsWorld, 0, false, 0.5);
+    physicsWorld.ResetStats();
+}
+
+static int Record(const char* sampleFile, int level, int seed, double sensorHz, double jitterMilliseconds, int maxSteps)
+{
+    Maze maze;
+    PhysicsWorld physicsWorld;
+    SetupLevel(maze, physicsWorld, level, seed);
+    SolverBot solverBot(&maze, &physicsWorld);
+
+    const int64_t stepNanoseconds = 1000000000 / PHYSICS_WORLD_STEPS_PER_SECOND;
+    const auto samplePeriodNanoseconds = int64_t(1e9 / sensorHz);
+    const auto jitterNanoseconds = int64_t(jitterMilliseconds * 1e6);
+
+    RandomGenerator random(RandomGenerator::MixSeed(level, seed, int(sensorHz)));
+    std::vector<GravityTrack::Sample> sampleArray;
+    int64_t nextSampleNanoseconds = 0;
+    int step = 0;
+
+    for(step = 0; step < maxSteps; step++)
+    {
+        Vector2D gravity = solverBot.ChooseGravity(GRAVITY_TRACK_RUNNER_GRAVITY);
+        physicsWorld.accelerationDueToGravity = gravity;
+
+        // The sensor reads whatever gravity is in effect at the time, on its own (slightly irregular) schedule.
+        int64_t stepEndNanoseconds = int64_t(step + 1) * stepNanoseconds;
+        while(nextSampleNanoseconds < stepEndNanoseconds)
+        {
+            GravityTrack::Sample sample{};
+            sample.timeNanoseconds = nextSampleNanoseconds;
+            sample.x = gravity.x;
+            sample.y = gravity.y;
+            sampleArray.push_back(sample);
+
+            int64_t jitter = (jitterNanoseconds > 0) ? int64_t(random.Number(-1.0, 1.0) * double(jitterNanoseconds)) : 0;
+            nextSampleNanoseconds += std::max(samplePeriodNanoseconds + jitter, int64_t(1));
+        }
+
+        physicsWorld.Tick();
+
+        if(physicsWorld.IsMazeSolved())
+        {
+            step++;
+            break;
+        }
+    }
+
+    if(!GravityTrack::SaveSampleFile(sampleFile, sampleArray))
+    {
+        fprintf(stderr, "Failed to write %s.\n", sampleFile);
+        return 1;
+    }
+
+    fprintf(stderr, "The bot %s level %d (seed %d) in %d steps.  Wrote %zu samples.\n", physicsWorld.IsMazeSolved() ? "solved" : "did not solve", level, seed, step, sampleArray.size());
+    return 0;
+}
+
+static int Replay(const char* sampleFile, int level, int seed, double predictionSeconds, int maxSteps)
+{
+    std::vector<GravityTrack::Sample> sampleArray;
+    if(!GravityTrack::LoadSampleFile(sampleFile, sampleArray))
+    {
+        fprintf(stderr, "Failed to read %s.\n", sampleFile);
+        return 1;
+    }
+
+    Maze maze;
+    PhysicsWorld physicsWorld;
+    SetupLevel(maze, physicsWorld, level, seed);
+
+    const int64_t stepNanoseconds = 1000000000 / PHYSICS_WORLD_STEPS_PER_SECOND;
+    const int64_t startNanoseconds = sampleArray[0].timeNanoseconds;
+    const auto latencyNanoseconds = int64_t(GRAVITY_TRACK_SENSOR_PERIOD_SECONDS * 1e9);
+    const auto predictionNanoseconds = int64_t(predictionSeconds * 1e9);
+
+    GravityTrack gravityTrack;
+    size_t sampleCursor = 0;
+    int lookupCountArray[4] = {0, 0, 0, 0};
+    uint32_t checksum = 0;
+    int step = 0;
+
+    for(step = 0; step < maxSteps; step++)
+    {
+        int64_t stepTimeNanoseconds = startNanoseconds + int64_t(step) * stepNanoseconds;
+
+        // Stop once we've run past the end of the recording.
+        if(sampleCursor >= sampleArray.size() && stepTimeNanoseconds > sampleArray.back().timeNanoseconds + stepNanoseconds)
+            break;
+
+        while(sampleCursor < sampleArray.size() && sampleArray[sampleCursor].timeNanoseconds <= stepTimeNanoseconds)
+            gravityTrack.AddSample(sampleArray[sampleCursor++]);
+
+        Vector2D gravity(0.0, 0.0);
+        GravityTrack::Lookup lookup = gravityTrack.Evaluate(stepTimeNanoseconds - latencyNanoseconds + predictionNanoseconds, gravity);
+        lookupCountArray[int(lookup)]++;
+
+        double gravityArray[2] = {gravity.x, gravity.y};
+        checksum = CalcCrc32(gravityArray, sizeof(gravityArray), checksum);
+
+        physicsWorld.accelerationDueToGravity = gravity;
+        physicsWorld.Tick();
+
+        if(physicsWorld.IsMazeSolved())
+        {
+            step++;
+            break;
+        }
+    }
+
+    printf("level,seed,samples,steps,solved,collisions,touched,interpolated,extrapolated,held,gravity_checksum\n");
+    printf("%d,%d,%zu,%d,%d,%d,%d,%d,%d,%d,%08X\n", level, seed, sampleArray.size(), step, physicsWorld.IsMazeSolved() ? 1 : 0,
+           physicsWorld.GetBallCollisionCount(), physicsWorld.GetGoodMazeBlockTouchedCount(),
+           lookupCountArray[int(GravityTrack::Lookup::INTERPOLATED)], lookupCountArray[int(GravityTrack::Lookup::EXTRAPOLATED)],
+           lookupCountArray[int(GravityTrack::Lookup::HELD)], checksum);
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && ::strcmp(argv[1], "record") == 0)
+    {
+        int level = (argc > 3) ? ::atoi(argv[3]) : 0;
+        int seed = (argc > 4) ? ::atoi(argv[4]) : 0;
+        double sensorHz = (argc > 5) ? ::atof(argv[5]) : 1.0 / GRAVITY_TRACK_SENSOR_PERIOD_SECONDS;
+        double jitterMilliseconds = (argc > 6) ? ::atof(argv[6]) : 1.0;
+        int maxSteps = (argc > 7) ? ::atoi(argv[7]) : 50000;
+        if(sensorHz > 0.0)
+            return Record(argv[2], level, seed, sensorHz, jitterMilliseconds, maxSteps);
+    }
+
+    if(argc >= 3 && ::strcmp(argv[1], "replay") == 0)
+    {
+        int level = (argc > 3) ? ::atoi(argv[3]) : 0;
+        int seed = (argc > 4) ? ::atoi(argv[4]) : 0;
+        double predictionSeconds = (argc > 5) ? ::atof(argv[5]) : 0.0;
+        int maxSteps = (argc > 6) ? ::atoi(argv[6]) : 50000;
+        return Replay(argv[2], level, seed, predictionSeconds, maxSteps);
+    }
+
+    fprintf(stderr, "Usage: %s record <sampleFile> [level] [seed] [sensorHz] [jitterMs] [maxSteps]\n", argv[0]);
+    fprintf(stderr, "       %s replay <sampleFile> [level] [seed] [predictionSeconds] [maxSteps]\n", argv[0]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+// This is a host-side tool for replaying an input log, recorded on a device with the record_input
+// option, headless.  Each level is rebuilt exactly as the device built it, and then stepped with
+// exactly the gravity the device stepped it with, so the physics goes the same way every time.
+// That makes it something we can run under a profiler, or across a range of commits to find where
+// something got slower.
+//
+// Usage: InputReplayRunner <logFile> [runs]
+//
+// It prints a line of CSV per level per run: how many steps were replayed, when (if ever) the maze
+// was solved, how long the steps took, and a checksum of where everything ended up.  The checksums
+// should match from run to run, and from build to build unless the physics itself was changed.
+
+#include "Maze.h"
+#include "MazeObject.h"
+#include "PhysicsWorld.h"
+#include "InputLog.h"
+#include "RandomGenerator.h"
+#include "DurationHistogram.h"
+#include "Checksum.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+using namespace PlanarPhysics;
+
+static uint64_t NowNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000 + uint64_t(now.tv_nsec);
+}
+
+static uint32_t CalcWorldChecksum(const PhysicsWorld& physicsWorld)
+{
+    uint32_t checksum = 0;
+    for(const PlanarObject* planarObject : physicsWorld.GetPlanarObjectArray())
+    {
+        auto mazeObject = dynamic_cast<const MazeObject*>(planarObject);
+        if(mazeObject)
+        {
+            Vector2D position = mazeObject->GetPosition();
+            double positionArray[2] = {position.x, position.y};
+            checksum = CalcCrc32(positionArray, sizeof(positionArray), checksum);
+        }
+    }
+
+    return checksum;
+}
+
+static void ReplayLevel(const InputLog& inputLog, const InputLog::Segment& segment, int run, size_t segmentIndex)
+{
+    const InputLog::Level& level = segment.level;
+    if(level.topology > uint32_t(Maze::Topology::POLAR))
+    {
+        fprintf(stderr, "Level %d has an unknown topology (%u).\n", level.level, level.topology);
+        return;
+    }
+
+    Maze::Topology topology = Maze::Topology(level.topology);
+
+    Maze maze;
+    PhysicsWorld physicsWorld;
+
+    uint64_t setupStartNanoseconds = NowNanoseconds();
+    RandomGenerator random(RandomGenerator::MixSeed(level.rows, level.cols, level.seed));
+    maze.Generate(level.rows, level.cols, random, topology);
+    maze.PopulatePhysicsWorld(&physicsWorld, level.touches, level.queen != 0, level.bounce);
+    physicsWorld.ResetStats();
+    uint64_t setupNanoseconds = NowNanoseconds() - setupStartNanoseconds;
+
+    DurationHistogram stepDuration;
+    const std::vector<InputLog::Step>& stepArray = inputLog.GetStepArray();
+    int solvedStep = -1;
+
+    for(size_t i = 0; i < segment.stepCount; i++)
+    {
+        const InputLog::Step& step = stepArray[segment.firstStep + i];
+        physicsWorld.accelerationDueToGravity = Vector2D(double(step.x), double(step.y));
+
+        uint64_t stepStartNanoseconds = NowNanoseconds();
+        physicsWorld.Tick();
+        stepDuration.Record(NowNanoseconds() - stepStartNanoseconds);
+
+        // The game keeps stepping for a little while after a maze is solved, as it flies out, so we do too.
+        if(solvedStep < 0 && physicsWorld.IsMazeSolved())
+            solvedStep = int(i) + 1;
+    }
+
+    DurationHistogram::Snapshot snapshot;
+    stepDuration.TakeSnapshot(snapshot);
+
+    printf("%d,%zu,%d,%s,%d,%d,%d,%d,%zu,%d,%d,%d,%.3f,%.2f,%.0f,%.0f,%.3f,%08X\n", run, segmentIndex, level.level,
+           Maze::GetTopologyName(topology), level.rows, level.cols, level.seed, level.touches, segment.stepCount, solvedStep,
+           physicsWorld.GetBallCollisionCount(), physicsWorld.GetGoodMazeBlockTouchedCount(), double(setupNanoseconds) / 1e6,
+           snapshot.GetMeanMicroseconds(), snapshot.GetPercentileMicroseconds(0.99), double(snapshot.maxNanoseconds) / 1000.0,
+           double(snapshot.totalNanoseconds) / 1e6, CalcWorldChecksum(physicsWorld));
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <logFile> [runs]\n", argv[0]);
+        return 1;
+    }
+
+    int numRuns = (argc > 2) ? ::atoi(argv[2]) : 1;
+
+    InputLog inputLog;
+    if(!inputLog.Load(argv[1]))
+    {
+        fprintf(stderr, "Failed to read %s.\n", argv[1]);
+        return 1;
+    }
+
+    const std::vector<InputLog::Segment>& segmentArray = inputLog.GetSegmentArray();
+    fprintf(stderr, "%s has %zu levels and %zu steps, recorded at %u steps per second.\n", argv[1], segmentArray.size(),
+            inputLog.GetStepArray().size(), inputLog.GetStepsPerSecond());
+
+    printf("run,index,level,topology,rows,cols,seed,touches,steps,solved_step,collisions,touched,setup_ms,step_avg_us,step_p99_us,step_max_us,total_ms,world_checksum\n");
+    for(int run = 0; run < numRuns; run++)
+        for(size_t i = 0; i < segmentArray.size(); i++)
+            ReplayLevel(inputLog, segmentArray[i], run, i);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+// This is a host-side tool for reading the per-level stats log the game keeps in internal storage.
+// You can pull it off a device with something like:
+//     adb exec-out run-as com.spencer.gravitymaze cat files/level_stats.bin > level_stats.bin
+//
+// Usage: LevelStatsTool summary <logFile> [all]
+//        LevelStatsTool dump <logFile>
+//        LevelStatsTool compact <logFile> [keep]
+//
+// The summary is a line of CSV per level, over every time that level was solved: how long it took
+// (mean and median), how many physics steps, collisions and evil block resets it took on average,
+// the mean frame time, and the worst 99th percentile frame time of any of them.  Levels played back
+// from an input log are left out of it unless "all" is given.  Dumping prints every record as CSV.
+// Compacting drops bad records, and all but the newest so many good ones.
+
+#include "LevelStats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+struct LevelSummary
+{
+    std::vector<float> solveSecondsArray;
+    double totalPhysicsSteps = 0.0;
+    double totalCollisions = 0.0;
+    double totalEvilBlockResets = 0.0;
+    double totalFrameMilliseconds = 0.0;
+    double totalFrames = 0.0;
+    float worstFrameP99Milliseconds = 0.0f;
+};
+
+static bool LoadLog(const char* logFile, std::vector<LevelStats::Record>& recordArray)
+{
+    size_t numBadRecords = 0;
+    if(!LevelStats::LoadFile(logFile, recordArray, &numBadRecords))
+    {
+        fprintf(stderr, "%s: failed to load\n", logFile);
+        return false;
+    }
+
+    fprintf(stderr, "Loaded %zu records from %s (%zu bad).\n", recordArray.size(), logFile, numBadRecords);
+    return true;
+}
+
+static void AddToSummary(LevelSummary& summary, const LevelStats::Record& record)
+{
+    summary.solveSecondsArray.push_back(record.solveSeconds);
+    summary.totalPhysicsSteps += double(record.physicsSteps);
+    summary.totalCollisions += double(record.collisions);
+    summary.totalEvilBlockResets += double(record.evilBlockResets);
+    summary.totalFrameMilliseconds += double(record.frameMeanMilliseconds) * double(record.frameCount);
+    summary.totalFrames += double(record.frameCount);
+    summary.worstFrameP99Milliseconds = std::max(summary.worstFrameP99Milliseconds, record.frameP99Milliseconds);
+}
+
+static void PrintSummary(const char* label, LevelSummary& summary)
+{
+    size_t count = summary.solveSecondsArray.size();
+    if(count == 0)
+        return;
+
+    double totalSolveSeconds = 0.0;
+    for(float solveSeconds : summary.solveSecondsArray)
+        totalSolveSeconds += double(solveSeconds);
+
+    auto medianIter = summary.solveSecondsArray.begin() + ptrdiff_t(count / 2);
+    std::nth_element(summary.solveSecondsArray.begin(), medianIter, summary.solveSecondsArray.end());
+
+    printf("%s,%zu,%.2f,%.2f,%.1f,%.1f,%.2f,%.3f,%.3f\n",
+           label,
+           count,
+           totalSolveSeconds / double(count),
+           double(*medianIter),
+           summary.totalPhysicsSteps / double(count),
+           summary.totalCollisions / double(count),
+           summary.totalEvilBlockResets / double(count),
+           summary.totalFrames > 0.0 ? summary.totalFrameMilliseconds / summary.totalFrames : 0.0,
+           double(summary.worstFrameP99Milliseconds));
+}
+
+static bool Summarize(const char* logFile, bool includeReplays)
+{
+    std::vector<LevelStats::Record> recordArray;
+    if(!LoadLog(logFile, recordArray))
+        return false;
+
+    std::map<int, LevelSummary> levelSummaryMap;
+    LevelSummary totalSummary;
+    for(const LevelStats::Record& record : recordArray)
+    {
+        if(!includeReplays && (record.flags & LevelStats::REPLAYED) != 0)
+            continue;
+
+        AddToSummary(levelSummaryMap[record.level], record);
+        AddToSummary(totalSummary, record);
+    }
+
+    printf("level,count,mean_solve_s,median_solve_s,mean_steps,mean_collisions,mean_evil_resets,mean_frame_ms,worst_p99_frame_ms\n");
+    for(auto& pair : levelSummaryMap)
+    {
+        char label[32];
+        snprintf(label, sizeof(label), "%d", pair.first);
+        PrintSummary(label, pair.second);
+    }
+
+    PrintSummary("all", totalSummary);
+    return true;
+}
+
+static bool Dump(const char* logFile)
+{
+    std::vector<LevelStats::Record> recordArray;
+    if(!LoadLog(logFile, recordArray))
+        return false;
+
+    printf("finish_time,level,seed,rows,cols,topology,replayed,solve_s,steps,collisions,evil_resets,frames,mean_frame_ms,p99_frame_ms,max_frame_ms\n");
+    for(const LevelStats::Record& record : recordArray)
+    {
+        printf("%lld,%d,%d,%d,%d,%u,%d,%.3f,%u,%u,%u,%u,%.3f,%.3f,%.3f\n",
+               (long long)record.finishTime,
+               record.level,
+               record.seed,
+               record.rows,
+               record.cols,
+               record.topology,
+               (record.flags & LevelStats::REPLAYED) != 0 ? 1 : 0,
+               double(record.solveSeconds),
+               record.physicsSteps,
+               record.collisions,
+               record.evilBlockResets,
+               record.frameCount,
+               double(record.frameMeanMilliseconds),
+               double(record.frameP99Milliseconds),
+               double(record.frameMaxMilliseconds));
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if((argc == 3 || argc == 4) && ::strcmp(argv[1], "summary") == 0)
+        return Summarize(argv[2], argc == 4 && ::strcmp(argv[3], "all") == 0) ? 0 : 1;
+
+    if(argc == 3 && ::strcmp(argv[1], "dump") == 0)
+        return Dump(argv[2]) ? 0 : 1;
+
+    if((argc == 3 || argc == 4) && ::strcmp(argv[1], "compact") == 0)
+    {
+        size_t keepRecords = (argc == 4) ? size_t(::strtoul(argv[3], nullptr, 10)) : LEVEL_STATS_KEEP_RECORDS;
+        if(!LevelStats::Compact(argv[2], keepRecords))
+        {
+            fprintf(stderr, "%s: failed to compact\n", argv[2]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    fprintf(stderr, "Usage: %s summary <logFile> [all]\n", argv[0]);
+    fprintf(stderr, "       %s dump <logFile>\n", argv[0]);
+    fprintf(stderr, "       %s compact <logFile> [keep]\n", argv[0]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+// This is a host-side tool for looking inside the maze cache files the game writes to internal storage.
+// You can pull them off a device with something like: adb exec-out run-as com.spencer.gravitymaze cat files/maze_cache/<file>
+//
+// Usage: MazeCacheTool dump <file>
+//        MazeCacheTool verify <file> [<file> ...]
+//
+// Verifying a file checks its header and checksum, and then regenerates the maze from its
+// seed to make sure the cached copy is bit-for-bit what generation produces today.
+
+#include "Maze.h"
+#include "MazeCache.h"
+#include "RandomGenerator.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static bool DumpFile(const char* cacheFile)
+{
+    Maze maze;
+    MazeCache::Header header;
+    if(!MazeCache::LoadFile(cacheFile, maze, &header))
+    {
+        fprintf(stderr, "%s: failed to load\n", cacheFile);
+        return false;
+    }
+
+    printf("File:          %s\n", cacheFile);
+    printf("Version:       %u\n", header.version);
+    printf("Topology:      %s\n", Maze::GetTopologyName(maze.GetTopology()));
+    printf("Dimensions:    %d rows by %d cols (%d cells)\n", header.rows, header.cols, maze.GetCellCount());
+    printf("Seed:          %d\n", header.seed);
+    printf("Payload size:  %u bytes\n", header.payloadSize);
+    printf("Checksum:      %08X\n", header.payloadChecksum);
+
+    std::vector<uint8_t> payloadArray;
+    maze.Serialize(payloadArray);
+
+    // Two hex digits per cell.  Bit k is set when there's a wall toward the cell's k-th neighbor.
+    // Rectangular and hexagonal mazes print as their grid.  Polar ones just go in cell order.
+    if(maze.GetTopology() == Maze::Topology::POLAR)
+    {
+        printf("Wall masks (center first, then ring by ring):\n");
+        for(int i = 0; i < maze.GetCellCount(); i++)
+            printf("%s%02X%s", (i % 32 == 0) ? "    " : "", payloadArray[i], (i % 32 == 31 || i == maze.GetCellCount() - 1) ? "\n" : " ");
+    }
+    else
+    {
+        printf("Wall masks (top row first):\n");
+        for(int i = header.rows - 1; i >= 0; i--)
+        {
+            printf("    ");
+            for(int j = 0; j < header.cols; j++)
+                printf("%02X ", payloadArray[i * header.cols + j]);
+            printf("\n");
+        }
+    }
+
+    return true;
+}
+
+static bool VerifyFile(const char* cacheFile)
+{
+    Maze cachedMaze;
+    MazeCache::Header header;
+    if(!MazeCache::LoadFile(cacheFile, cachedMaze, &header))
+    {
+        printf("%s: FAILED (bad header, checksum or payload)\n", cacheFile);
+        return false;
+    }
+
+    Maze generatedMaze;
+    RandomGenerator random(RandomGenerator::MixSeed(header.rows, header.cols, header.seed));
+    generatedMaze.Generate(header.rows, header.cols, random, cachedMaze.GetTopology());
+
+    std::vector<uint8_t> cachedPayloadArray, generatedPayloadArray;
+    cachedMaze.Serialize(cachedPayloadArray);
+    generatedMaze.Serialize(generatedPayloadArray);
+
+    if(cachedPayloadArray != generatedPayloadArray)
+    {
+        printf("%s: FAILED (does not match a freshly generated maze)\n", cacheFile);
+        return false;
+    }
+
+    printf("%s: OK\n", cacheFile);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && ::strcmp(argv[1], "dump") == 0)
+        return DumpFile(argv[2]) ? 0 : 1;
+
+    if(argc >= 3 && ::strcmp(argv[1], "verify") == 0)
+    {
+        int numFailed = 0;
+        for(int i = 2; i < argc; i++)
+            if(!VerifyFile(argv[i]))
+                numFailed++;
+
+        return (numFailed == 0) ? 0 : 1;
+    }
+
+    fprintf(stderr, "Usage: %s dump <file>\n", argv[0]);
+    fprintf(stderr, "       %s verify <file> [<file> ...]\n", argv[0]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+// This is a host-side benchmark for maze generation and for populating the physics world,
+// compared across the different maze topologies.  Hexagonal and polar mazes have more walls
+// per cell than rectangular ones, and fewer of those walls can be merged, so we want to know
+// that neither step has gotten meaningfully more expensive per cell because of them.
+//
+// Usage: MazeTopologyBench [numRepeats] [maxRatio]
+//
+// A hexagonal maze ends up with a good two to three times the walls of a rectangular one (none of
+// its walls line up end-to-end), so comparing the topologies per cell would mostly just tell us
+// that.  Instead, generation is measured per cell, since it walks the cell graph, and populating
+// the physics world is measured per wall that goes into it, since that's what it spends its time
+// on.  Measured that way, every topology should cost the same as rectangular does.  We take the
+// best of the repeats, which keeps most of the noise out, and the default budget of 1.5 is that
+// ratio of 1.0 plus 0.5 for whatever noise is left.
+//
+// For each topology and maze size, this prints those costs as CSV.  It exits with a non-zero status
+// if either one is more than maxRatio times what it is for rectangular mazes of the same size.
+
+#include "Maze.h"
+#include "PhysicsWorld.h"
+#include "RandomGenerator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+static double NowNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return double(now.tv_sec) * 1e9 + double(now.tv_nsec);
+}
+
+struct BenchResult
+{
+    double generateNanosecondsPerCell;
+    double populateNanosecondsPerWall;
+    int numCells;
+    int numWalls;
+};
+
+static BenchResult RunBench(Maze::Topology topology, int size, int numRepeats)
+{
+    BenchResult result{};
+    result.generateNanosecondsPerCell = 1e30;
+    result.populateNanosecondsPerWall = 1e30;
+
+    for(int i = 0; i < numRepeats; i++)
+    {
+        Maze maze;
+        PhysicsWorld physicsWorld;
+        RandomGenerator random(RandomGenerator::MixSeed(size, size, i));
+
+        double startTime = NowNanoseconds();
+        maze.Generate(size, size, random, topology);
+        double generateTime = NowNanoseconds();
+        maze.PopulatePhysicsWorld(&physicsWorld, 0, false, 0.5);
+        double populateTime = NowNanoseconds();
+
+        result.numCells = maze.GetCellCount();
+        result.numWalls = 0;
+        for(const PlanarPhysics::PlanarObject* planarObject : physicsWorld.GetPlanarObjectArray())
+            if(dynamic_cast<const PlanarPhysics::Wall*>(planarObject))
+                result.numWalls++;
+
+        result.generateNanosecondsPerCell = std::min(result.generateNanosecondsPerCell, (generateTime - startTime) / double(std::max(result.numCells, 1)));
+        result.populateNanosecondsPerWall = std::min(result.populateNanosecondsPerWall, (populateTime - generateTime) / double(std::max(result.numWalls, 1)));
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int numRepeats = (argc > 1) ? ::atoi(argv[1]) : 20;
+    double maxRatio = (argc > 2) ? ::atof(argv[2]) : 1.5;
+
+    if(numRepeats < 1)
+        numRepeats = 1;
+
+    const int sizeArray[] = {10, 20, 40, 80};
+    const Maze::Topology topologyArray[] = {Maze::Topology::RECTANGULAR, Maze::Topology::HEXAGONAL, Maze::Topology::POLAR};
+
+    int numOverBudget = 0;
+
+    printf("topology,size,cells,walls,generate_ns_per_cell,populate_ns_per_wall\n");
+    for(int size : sizeArray)
+    {
+        BenchResult baseline{};
+
+        for(Maze::Topology topology : topologyArray)
+        {
+            BenchResult result = RunBench(topology, size, numRepeats);
+            printf("%s,%d,%d,%d,%.1f,%.1f\n", Maze::GetTopologyName(topology), size, result.numCells, result.numWalls,
+                   result.generateNanosecondsPerCell, result.populateNanosecondsPerWall);
+
+            if(topology == Maze::Topology::RECTANGULAR)
+            {
+                baseline = result;
+                continue;
+            }
+
+            if(result.generateNanosecondsPerCell > maxRatio * baseline.generateNanosecondsPerCell ||
+               result.populateNanosecondsPerWall > maxRatio * baseline.populateNanosecondsPerWall)
+            {
+                fprintf(stderr, "%s mazes of size %d cost more than %.2f times rectangular ones per cell or per wall.\n",
+                        Maze::GetTopologyName(topology), size, maxRatio);
+                numOverBudget++;
+            }
+        }
+    }
+
+    return (numOverBudget == 0) ? 0 : 1;
+}
\ No newline at end of file
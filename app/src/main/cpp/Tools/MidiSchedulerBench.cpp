@@ -0,0 +1,146 @@
+// This is a host-side benchmark for the MIDI scheduler.  It plays a made-up song, with every
+// event at an exact time, through the scheduler to a recording port instead of a device, and
+// then looks at when each batch was actually handed to the port.  A batch counts as late if it
+// went out after its own time, since then no port could have played it on time.
+//
+// Usage: MidiSchedulerBench [seconds] [eventsPerSecond] [lookaheadSeconds] [periodSeconds]
+//
+// This prints the number of events and batches, how far ahead of time the batches went out
+// (least and average), and how far behind schedule each send was relative to the last moment
+// the lookahead allows it to go out (median, 99th percentile and worst case), all as CSV.  It
+// exits with a non-zero status if anything was late.
+
+#include "MidiScheduler.h"
+#include "MidiPort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+// Every step, a note starts and the one before it stops, and every fourth step a drum hits along with it.
+class BenchSong : public MidiScheduler::Source
+{
+public:
+    BenchSong(double seconds, double eventsPerSecond)
+    {
+        this->numSteps = uint32_t(seconds * eventsPerSecond);
+        this->stepSeconds = 1.0 / eventsPerSecond;
+        this->nextStep = 0;
+        this->eventCount = 0;
+    }
+
+    virtual ~BenchSong()
+    {
+    }
+
+    virtual bool Pump(double untilSeconds, MidiScheduler& scheduler) override
+    {
+        while(this->nextStep < this->numSteps)
+        {
+            double timeSeconds = double(this->nextStep) * this->stepSeconds;
+            if(timeSeconds > untilSeconds)
+                break;
+
+            auto note = uint8_t(48 + this->nextStep % 24);
+            if(this->nextStep > 0)
+            {
+                uint8_t noteOff[] = {0x80, uint8_t(48 + (this->nextStep - 1) % 24), 0};
+                scheduler.AddEvent(timeSeconds, noteOff, sizeof(noteOff));
+                this->eventCount++;
+            }
+
+            uint8_t noteOn[] = {0x90, note, 100};
+            scheduler.AddEvent(timeSeconds, noteOn, sizeof(noteOn));
+            this->eventCount++;
+
+            if(this->nextStep % 4 == 0)
+            {
+                uint8_t drum[] = {0x99, 36, 110};
+                scheduler.AddEvent(timeSeconds, drum, sizeof(drum));
+                this->eventCount++;
+            }
+
+            this->nextStep++;
+        }
+
+        return this->nextStep < this->numSteps;
+    }
+
+    uint32_t numSteps;
+    double stepSeconds;
+    uint32_t nextStep;
+    uint32_t eventCount;
+};
+
+int main(int argc, char** argv)
+{
+    double seconds = (argc > 1) ? ::atof(argv[1]) : 10.0;
+    double eventsPerSecond = (argc > 2) ? ::atof(argv[2]) : 16.0;
+    double lookaheadSeconds = (argc > 3) ? ::atof(argv[3]) : 0.04;
+    double periodSeconds = (argc > 4) ? ::atof(argv[4]) : 0.005;
+
+    if(seconds <= 0.0 || eventsPerSecond <= 0.0 || lookaheadSeconds <= 0.0 || periodSeconds <= 0.0)
+    {
+        fprintf(stderr, "Usage: %s [seconds] [eventsPerSecond] [lookaheadSeconds] [periodSeconds]\n", argv[0]);
+        return 1;
+    }
+
+    BenchSong song(seconds, eventsPerSecond);
+    RecordingMidiPort port;
+    MidiScheduler scheduler;
+
+    if(!scheduler.Start(&song, &port, lookaheadSeconds, periodSeconds))
+    {
+        fprintf(stderr, "Failed to start the scheduler.\n");
+        return 1;
+    }
+
+    struct timespec sleepTime;
+    sleepTime.tv_sec = 0;
+    sleepTime.tv_nsec = 10000000;
+    while(!scheduler.IsFinished())
+        ::nanosleep(&sleepTime, nullptr);
+
+    scheduler.Stop();
+
+    if(port.recordArray.size() == 0)
+    {
+        fprintf(stderr, "Nothing was sent.\n");
+        return 1;
+    }
+
+    // The scheduler is allowed to send a batch as early as one lookahead before its time, so that's where we measure from.
+    auto lookaheadNanoseconds = int64_t(lookaheadSeconds * 1e9);
+    std::vector<double> lagArray;
+    double minLeadNanoseconds = 1e18;
+    double totalLeadNanoseconds = 0.0;
+    for(const RecordingMidiPort::Record& record : port.recordArray)
+    {
+        double leadNanoseconds = double(record.timeNanoseconds - record.sentNanoseconds);
+        minLeadNanoseconds = std::min(minLeadNanoseconds, leadNanoseconds);
+        totalLeadNanoseconds += leadNanoseconds;
+        lagArray.push_back(std::max(0.0, double(record.sentNanoseconds - (record.timeNanoseconds - lookaheadNanoseconds))));
+    }
+
+    std::sort(lagArray.begin(), lagArray.end());
+    double p50LagNanoseconds = lagArray[lagArray.size() / 2];
+    double p99LagNanoseconds = lagArray[std::min(lagArray.size() - 1, size_t(0.99 * double(lagArray.size())))];
+    double maxLagNanoseconds = lagArray.back();
+
+    printf("events,batches,lookahead_ms,period_ms,min_lead_ms,avg_lead_ms,p50_lag_ms,p99_lag_ms,max_lag_ms,late,failed\n");
+    printf("%u,%u,%.1f,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u\n", song.eventCount, scheduler.GetSentCount(), lookaheadSeconds * 1e3, periodSeconds * 1e3,
+           minLeadNanoseconds / 1e6, totalLeadNanoseconds / double(port.recordArray.size()) / 1e6,
+           p50LagNanoseconds / 1e6, p99LagNanoseconds / 1e6, maxLagNanoseconds / 1e6,
+           scheduler.GetLateCount(), scheduler.GetFailedCount());
+
+    int result = 0;
+
+    if(scheduler.GetLateCount() > 0 || scheduler.GetFailedCount() > 0)
+    {
+        fprintf(stderr, "%u of %u batches went out late and %u failed.\n", scheduler.GetLateCount(), scheduler.GetSentCount(), scheduler.GetFailedCount());
+        result = 1;
+    }
+
+    return result;
+}
\ No newline at end of file
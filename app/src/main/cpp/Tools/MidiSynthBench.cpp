@@ -0,0 +1,152 @@
+// This is a host-side benchmark for the built-in MIDI synthesizer.  It plays a made-up song
+// through the synthesizer and the mixer, driven by the offline output a burst at a time, just
+// as the audio callback on a device would drive them.  Every beat, each of the melodic channels
+// strikes a new chord and the drums hit, so the voice pool stays full and has to steal.
+//
+// Usage: MidiSynthBench [maxVoices] [notesPerBeat] [seconds] [framesPerBurst] [maxLoad] [outputWavPath]
+//
+// This prints the cost per burst (average, 99th percentile and worst case) as CSV, along with
+// how much of each burst's real-time budget that is.  It exits with a non-zero status if the
+// 99th percentile burst takes more than maxLoad of its budget.  If an output path is given,
+// the song is written there as a WAV file so that it can be listened to.
+
+#include "AudioMixer.h"
+#include "MidiSynth.h"
+#include "OfflineAudioOutput.h"
+#include "RandomGenerator.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#define MIDI_SYNTH_BENCH_FRAMES_PER_SECOND      48000
+#define MIDI_SYNTH_BENCH_NUM_CHANNELS           2
+#define MIDI_SYNTH_BENCH_BEAT_SECONDS           0.4
+#define MIDI_SYNTH_BENCH_NUM_MELODIC_CHANNELS   4
+
+int main(int argc, char** argv)
+{
+    int maxVoices = (argc > 1) ? ::atoi(argv[1]) : 24;
+    int notesPerBeat = (argc > 2) ? ::atoi(argv[2]) : 12;
+    double seconds = (argc > 3) ? ::atof(argv[3]) : 10.0;
+    int framesPerBurst = (argc > 4) ? ::atoi(argv[4]) : 192;
+    double maxLoad = (argc > 5) ? ::atof(argv[5]) : 0.25;
+    const char* outputPath = (argc > 6) ? argv[6] : nullptr;
+
+    if(maxVoices < 1 || notesPerBeat < 1 || seconds <= 0.0 || framesPerBurst < 1)
+    {
+        fprintf(stderr, "Usage: %s [maxVoices] [notesPerBeat] [seconds] [framesPerBurst] [maxLoad] [outputWavPath]\n", argv[0]);
+        return 1;
+    }
+
+    AudioMixer mixer;
+    if(!mixer.Setup(MIDI_SYNTH_BENCH_FRAMES_PER_SECOND, MIDI_SYNTH_BENCH_NUM_CHANNELS, AudioMixer::SampleFormat::FLOAT, 1, uint32_t(framesPerBurst)))
+    {
+        fprintf(stderr, "Failed to set up the mixer.\n");
+        return 1;
+    }
+
+    MidiSynth synth;
+    if(!synth.Setup(MIDI_SYNTH_BENCH_FRAMES_PER_SECOND, MIDI_SYNTH_BENCH_NUM_CHANNELS, uint32_t(maxVoices)))
+    {
+        fprintf(stderr, "Failed to set up the synthesizer.\n");
+        return 1;
+    }
+
+    mixer.SetSource(&synth);
+
+    OfflineAudioOutput output;
+    if(!output.Setup(&mixer, uint32_t(framesPerBurst), outputPath != nullptr))
+    {
+        fprintf(stderr, "Failed to set up the offline output.\n");
+        return 1;
+    }
+
+    // Each melodic channel gets an instrument from a different family, and a place in the stereo field.
+    RandomGenerator random(RandomGenerator::MixSeed(maxVoices, notesPerBeat, framesPerBurst));
+    for(int channel = 0; channel < MIDI_SYNTH_BENCH_NUM_MELODIC_CHANNELS; channel++)
+    {
+        uint8_t setupArray[] =
+        {
+            uint8_t(0xC0 | channel), uint8_t(random.Integer(0, 15) * 8),
+            uint8_t(0xB0 | channel), 10, uint8_t(channel * 127 / (MIDI_SYNTH_BENCH_NUM_MELODIC_CHANNELS - 1))
+        };
+        synth.SendMessage(setupArray, sizeof(setupArray));
+    }
+
+    std::vector<uint8_t> heldNoteArray;
+    auto framesPerBeat = uint32_t(MIDI_SYNTH_BENCH_BEAT_SECONDS * MIDI_SYNTH_BENCH_FRAMES_PER_SECOND);
+    auto numBursts = uint32_t(::ceil(seconds * double(MIDI_SYNTH_BENCH_FRAMES_PER_SECOND) / double(framesPerBurst)));
+    uint64_t nextBeatFrame = 0;
+    uint32_t peakVoiceCount = 0;
+
+    for(uint32_t i = 0; i < numBursts; i++)
+    {
+        uint64_t burstFrame = uint64_t(i) * framesPerBurst;
+        if(burstFrame >= nextBeatFrame)
+        {
+            nextBeatFrame += framesPerBeat;
+
+            // Let go of the last chord, then strike the next one, spread over the melodic channels.
+            for(size_t j = 0; j < heldNoteArray.size(); j += 2)
+            {
+                uint8_t noteOff[] = {uint8_t(0x80 | heldNoteArray[j]), heldNoteArray[j + 1], 0};
+                synth.SendMessage(noteOff, sizeof(noteOff));
+            }
+            heldNoteArray.clear();
+
+            int root = random.Integer(48, 72);
+            for(int j = 0; j < notesPerBeat; j++)
+            {
+                auto channel = uint8_t(j % MIDI_SYNTH_BENCH_NUM_MELODIC_CHANNELS);
+                auto note = uint8_t(root + (j / MIDI_SYNTH_BENCH_NUM_MELODIC_CHANNELS) * 12 + ((j % 3) * 4) - 12);
+                uint8_t noteOn[] = {uint8_t(0x90 | channel), note, uint8_t(random.Integer(60, 120))};
+                synth.SendMessage(noteOn, sizeof(noteOn));
+                heldNoteArray.push_back(channel);
+                heldNoteArray.push_back(note);
+            }
+
+            uint8_t drumArray[] = {0x99, uint8_t((burstFrame / framesPerBeat) % 2 ? 38 : 36), 110, 0x99, 42, 80};
+            synth.SendMessage(drumArray, sizeof(drumArray));
+        }
+
+        output.Render(1);
+        peakVoiceCount = std::max(peakVoiceCount, synth.GetActiveVoiceCount());
+    }
+
+    std::vector<double> burstTimeArray = output.GetBurstTimeArray();
+    std::sort(burstTimeArray.begin(), burstTimeArray.end());
+
+    double totalNanoseconds = 0.0;
+    for(double burstTime : burstTimeArray)
+        totalNanoseconds += burstTime;
+
+    double averageNanoseconds = totalNanoseconds / double(burstTimeArray.size());
+    double p99Nanoseconds = burstTimeArray[std::min(burstTimeArray.size() - 1, size_t(0.99 * double(burstTimeArray.size())))];
+    double maxNanoseconds = burstTimeArray.back();
+    double budgetNanoseconds = 1e9 * double(framesPerBurst) / double(MIDI_SYNTH_BENCH_FRAMES_PER_SECOND);
+
+    printf("max_voices,notes_per_beat,frames_per_burst,bursts,peak_voices,avg_ns_per_burst,p99_ns_per_burst,max_ns_per_burst,avg_load,p99_load,stolen,dropped\n");
+    printf("%d,%d,%d,%u,%u,%.0f,%.0f,%.0f,%.4f,%.4f,%u,%u\n", maxVoices, notesPerBeat, framesPerBurst, numBursts, peakVoiceCount,
+           averageNanoseconds, p99Nanoseconds, maxNanoseconds, averageNanoseconds / budgetNanoseconds, p99Nanoseconds / budgetNanoseconds,
+           synth.GetStolenCount(), synth.GetDroppedCount());
+
+    int result = 0;
+
+    if(outputPath && !output.WriteWaveFile(outputPath))
+    {
+        fprintf(stderr, "Failed to write %s.\n", outputPath);
+        result = 1;
+    }
+
+    if(p99Nanoseconds > maxLoad * budgetNanoseconds)
+    {
+        fprintf(stderr, "The 99th percentile burst took %.0f ns, which is more than %.2f of its %.0f ns budget.\n", p99Nanoseconds, maxLoad, budgetNanoseconds);
+        result = 1;
+    }
+
+    synth.Shutdown();
+    mixer.Shutdown();
+    return result;
+}
\ No newline at end of file
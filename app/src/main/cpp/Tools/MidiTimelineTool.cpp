@@ -0,0 +1,169 @@
+// This is a host-side tool for checking that songs compile into timelines the way the game
+// will play them, and for hearing how they come out of the built-in synthesizer.
+//
+// Usage: MidiTimelineTool info <file> [<file> ...]
+//        MidiTimelineTool dump <file>
+//        MidiTimelineTool render <file> <outputWavPath> [maxVoices]
+//
+// Info prints the tracks, tempo changes, events and length of each song as CSV, along with
+// how long it took to compile.  Dump prints every event with its time.  Render plays a song
+// through the synthesizer, a burst at a time, and writes what came out to a WAV file.
+
+#include "MidiTimeline.h"
+#include "MidiSynth.h"
+#include "AudioMixer.h"
+#include "OfflineAudioOutput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define MIDI_TIMELINE_TOOL_FRAMES_PER_SECOND    48000
+#define MIDI_TIMELINE_TOOL_NUM_CHANNELS         2
+#define MIDI_TIMELINE_TOOL_FRAMES_PER_BURST     192
+
+static bool ReadFile(const char* filePath, std::vector<uint8_t>& fileArray)
+{
+    FILE* file = ::fopen(filePath, "rb");
+    if(!file)
+        return false;
+
+    ::fseek(file, 0, SEEK_END);
+    long fileSize = ::ftell(file);
+    ::fseek(file, 0, SEEK_SET);
+
+    fileArray.resize(fileSize > 0 ? size_t(fileSize) : 0);
+    bool success = fileArray.size() > 0 && ::fread(fileArray.data(), 1, fileArray.size(), file) == fileArray.size();
+    ::fclose(file);
+    return success;
+}
+
+static bool LoadTimeline(const char* filePath, MidiTimeline& timeline, double* compileMicroseconds = nullptr)
+{
+    std::vector<uint8_t> fileArray;
+    if(!ReadFile(filePath, fileArray))
+    {
+        fprintf(stderr, "%s: failed to read\n", filePath);
+        return false;
+    }
+
+    struct timespec startTime, stopTime;
+    ::clock_gettime(CLOCK_MONOTONIC, &startTime);
+    bool compiled = timeline.Compile(fileArray.data(), fileArray.size());
+    ::clock_gettime(CLOCK_MONOTONIC, &stopTime);
+
+    if(!compiled)
+    {
+        fprintf(stderr, "%s: failed to compile\n", filePath);
+        return false;
+    }
+
+    if(compileMicroseconds)
+        *compileMicroseconds = double(stopTime.tv_sec - startTime.tv_sec) * 1e6 + double(stopTime.tv_nsec - startTime.tv_nsec) / 1e3;
+
+    return true;
+}
+
+static bool RenderTimeline(const MidiTimeline& timeline, const char* outputPath, uint32_t maxVoices)
+{
+    AudioMixer mixer;
+    if(!mixer.Setup(MIDI_TIMELINE_TOOL_FRAMES_PER_SECOND, MIDI_TIMELINE_TOOL_NUM_CHANNELS, AudioMixer::SampleFormat::FLOAT, 1, MIDI_TIMELINE_TOOL_FRAMES_PER_BURST))
+        return false;
+
+    MidiSynth synth;
+    if(!synth.Setup(MIDI_TIMELINE_TOOL_FRAMES_PER_SECOND, MIDI_TIMELINE_TOOL_NUM_CHANNELS, maxVoices))
+        return false;
+
+    mixer.SetSource(&synth);
+
+    OfflineAudioOutput output;
+    if(!output.Setup(&mixer, MIDI_TIMELINE_TOOL_FRAMES_PER_BURST, true))
+        return false;
+
+    // Events go to the synthesizer right before the burst they fall in, so they're only ever off by less than a burst.
+    // We leave a couple of seconds at the end for the last notes to ring out.
+    double burstSeconds = double(MIDI_TIMELINE_TOOL_FRAMES_PER_BURST) / double(MIDI_TIMELINE_TOOL_FRAMES_PER_SECOND);
+    auto numBursts = uint32_t((timeline.GetLengthSeconds() + 2.0) / burstSeconds);
+    size_t cursor = 0;
+    for(uint32_t i = 0; i < numBursts; i++)
+    {
+        double untilSeconds = double(i + 1) * burstSeconds;
+        while(cursor < timeline.GetEventCount() && timeline.GetEvent(cursor).timeSeconds < untilSeconds)
+        {
+            const MidiTimeline::Event& event = timeline.GetEvent(cursor++);
+            synth.SendMessage(event.byteArray, event.size);
+        }
+
+        output.Render(1);
+    }
+
+    bool success = output.WriteWaveFile(outputPath);
+    printf("Rendered %.1f seconds (%u messages dropped, %u voices stolen).\n", double(numBursts) * burstSeconds, synth.GetDroppedCount(), synth.GetStolenCount());
+
+    synth.Shutdown();
+    mixer.Shutdown();
+    return success;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && ::strcmp(argv[1], "info") == 0)
+    {
+        int result = 0;
+        printf("file,tracks,tempo_changes,events,length_seconds,compile_us\n");
+        for(int i = 2; i < argc; i++)
+        {
+            MidiTimeline timeline;
+            double compileMicroseconds = 0.0;
+            if(!LoadTimeline(argv[i], timeline, &compileMicroseconds))
+            {
+                result = 1;
+                continue;
+            }
+
+            printf("%s,%u,%u,%zu,%.3f,%.0f\n", argv[i], timeline.GetTrackCount(), timeline.GetTempoChangeCount(), timeline.GetEventCount(), timeline.GetLengthSeconds(), compileMicroseconds);
+        }
+
+        return result;
+    }
+
+    if(argc == 3 && ::strcmp(argv[1], "dump") == 0)
+    {
+        MidiTimeline timeline;
+        if(!LoadTimeline(argv[2], timeline))
+            return 1;
+
+        for(size_t i = 0; i < timeline.GetEventCount(); i++)
+        {
+            const MidiTimeline::Event& event = timeline.GetEvent(i);
+            printf("%10.4f ", event.timeSeconds);
+            for(uint8_t j = 0; j < event.size; j++)
+                printf(" %02X", event.byteArray[j]);
+            printf("\n");
+        }
+
+        return 0;
+    }
+
+    if((argc == 4 || argc == 5) && ::strcmp(argv[1], "render") == 0)
+    {
+        MidiTimeline timeline;
+        if(!LoadTimeline(argv[2], timeline))
+            return 1;
+
+        uint32_t maxVoices = (argc == 5) ? uint32_t(::atoi(argv[4])) : 24;
+        if(!RenderTimeline(timeline, argv[3], maxVoices))
+        {
+            fprintf(stderr, "Failed to render %s.\n", argv[3]);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    fprintf(stderr, "Usage: %s info <file> [<file> ...]\n", argv[0]);
+    fprintf(stderr, "       %s dump <file>\n", argv[0]);
+    fprintf(stderr, "       %s render <file> <outputWavPath> [maxVoices]\n", argv[0]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+// This is a host-side tool for converting the game's progress and options records to and from JSON,
+// which is still the format we read, hand-edit and diff them in.  You can pull the records off a
+// device with something like: adb exec-out run-as com.spencer.gravitymaze cat files/progress.bin
+//
+// Usage: SaveDataTool progress export <progress.bin>
+//        SaveDataTool progress import <progress.json> <progress.bin>
+//        SaveDataTool options export <options.bin>
+//        SaveDataTool options import <options.json> <options.bin>
+//
+// Exporting prints the record as JSON.  Importing writes a record made from the given JSON.  An
+// options record remembers the JSON it was made from, and the game only uses it if its own
+// options.json is the same, so push both files or neither.
+
+#include "Progress.h"
+#include "Options.h"
+#include "BinaryRecord.h"
+#include "AsyncFileWriter.h"
+#include "Checksum.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static bool ReadTextFile(const char* textFile, std::string& text)
+{
+    FILE* fp = fopen(textFile, "rb");
+    if(!fp)
+        return false;
+
+    char buffer[4096];
+    size_t bufferSize = 0;
+    text.clear();
+    while((bufferSize = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        text.append(buffer, bufferSize);
+
+    fclose(fp);
+    return true;
+}
+
+static bool WriteRecordFile(const char* recordFile, const std::string& fileData)
+{
+    if(!AsyncFileWriter::WriteFileAtomically(recordFile, fileData.data(), fileData.size()))
+    {
+        fprintf(stderr, "Failed to write %s.\n", recordFile);
+        return false;
+    }
+
+    fprintf(stderr, "Wrote %zu bytes to %s.\n", fileData.size(), recordFile);
+    return true;
+}
+
+static bool ExportProgress(const char* recordFile)
+{
+    Progress progress;
+    if(!progress.LoadFile(recordFile))
+    {
+        fprintf(stderr, "%s: failed to load\n", recordFile);
+        return false;
+    }
+
+    std::string jsonString;
+    if(!progress.ExportJson(jsonString))
+        return false;
+
+    printf("%s\n", jsonString.c_str());
+    return true;
+}
+
+static bool ImportProgress(const char* jsonFile, const char* recordFile)
+{
+    std::string jsonString;
+    Progress progress;
+    if(!ReadTextFile(jsonFile, jsonString) || !progress.ImportJson(jsonString))
+    {
+        fprintf(stderr, "%s: failed to load\n", jsonFile);
+        return false;
+    }
+
+    std::string fileData;
+    progress.PackRecord(fileData);
+    return WriteRecordFile(recordFile, fileData);
+}
+
+static bool ExportOptions(const char* recordFile)
+{
+    // We don't have the JSON the record was made from, so we read it without checking against it.
+    Options options;
+    Options::Record record{};
+    options.MakeRecord(record);
+    if(!BinaryRecord::ReadFile(recordFile, OPTIONS_MAGIC, OPTIONS_VERSION, &record, sizeof(Options::Record)))
+    {
+        fprintf(stderr, "%s: failed to load\n", recordFile);
+        return false;
+    }
+
+    options.ApplyRecord(record);
+
+    std::string jsonString;
+    if(!options.ExportJson(jsonString))
+        return false;
+
+    fprintf(stderr, "Made from %u bytes of JSON with checksum %08X.\n", record.sourceSize, record.sourceChecksum);
+    printf("%s", jsonString.c_str());
+    return true;
+}
+
+static bool ImportOptions(const char* jsonFile, const char* recordFile)
+{
+    std::string jsonString;
+    Options options;
+    if(!ReadTextFile(jsonFile, jsonString) || !options.ImportJson(jsonString.data(), jsonString.length()))
+    {
+        fprintf(stderr, "%s: failed to load\n", jsonFile);
+        return false;
+    }
+
+    std::string fileData;
+    if(!options.PackRecord(fileData, uint32_t(jsonString.length()), CalcCrc32(jsonString.data(), jsonString.length())))
+    {
+        fprintf(stderr, "%s: a string option is too long to fit in a record\n", jsonFile);
+        return false;
+    }
+
+    return WriteRecordFile(recordFile, fileData);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc == 4 && ::strcmp(argv[1], "progress") == 0 && ::strcmp(argv[2], "export") == 0)
+        return ExportProgress(argv[3]) ? 0 : 1;
+
+    if(argc == 5 && ::strcmp(argv[1], "progress") == 0 && ::strcmp(argv[2], "import") == 0)
+        return ImportProgress(argv[3], argv[4]) ? 0 : 1;
+
+    if(argc == 4 && ::strcmp(argv[1], "options") == 0 && ::strcmp(argv[2], "export") == 0)
+        return ExportOptions(argv[3]) ? 0 : 1;
+
+    if(argc == 5 && ::strcmp(argv[1], "options") == 0 && ::strcmp(argv[2], "import") == 0)
+        return ImportOptions(argv[3], argv[4]) ? 0 : 1;
+
+    fprintf(stderr, "Usage: %s progress export <progress.bin>\n", argv[0]);
+    fprintf(stderr, "       %s progress import <progress.json> <progress.bin>\n", argv[0]);
+    fprintf(stderr, "       %s options export <options.bin>\n", argv[0]);
+    fprintf(stderr, "       %s options import <options.json> <options.bin>\n", argv[0]);
+    return 1;
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+// This is a host-side benchmark for the shader program cache.  It makes a GL ES 3 context with
+// no window (Mesa's software renderer is fine for this), and then loads the game's line shader
+// the way DrawHelper does when the window comes back: first without the cache, then with a cold
+// cache, and then with a warm one, over and over.
+//
+// Usage: ShaderCacheBench [runs] [cacheFile]
+//
+// This prints how long each kind of load took (average and worst case) as CSV.  It exits with a
+// non-zero status if a warm load ever misses the cache, or if the driver can't do binaries at all.
+
+#include "ShaderProgram.h"
+#include <android/asset_manager.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// The build points this at the app's assets; otherwise, we look for them in the working directory.
+#ifndef SHADER_CACHE_BENCH_ASSET_DIR
+#   define SHADER_CACHE_BENCH_ASSET_DIR         "assets"
+#endif
+
+static uint64_t NowNanoseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000 + uint64_t(now.tv_nsec);
+}
+
+static bool MakeContext()
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    // A surfaceless display needs no window system at all, which is what we want on a build machine.
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+    if(display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        fprintf(stderr, "Failed to initialize an EGL display.\n");
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if(!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0)
+    {
+        fprintf(stderr, "No EGL config for GL ES 3.\n");
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+            EGL_NONE
+    };
+
+    eglBindAPI(EGL_OPENGL_ES_API);
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        fprintf(stderr, "Failed to make a GL ES 3 context current.\n");
+        return false;
+    }
+
+    fprintf(stderr, "Using %s (%s).\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+    return true;
+}
+
+static void PrintTimes(const char* label, const std::vector<uint64_t>& nanosecondsArray)
+{
+    if(nanosecondsArray.size() == 0)
+        return;
+
+    uint64_t totalNanoseconds = 0;
+    for(uint64_t nanoseconds : nanosecondsArray)
+        totalNanoseconds += nanoseconds;
+
+    uint64_t maxNanoseconds = *std::max_element(nanosecondsArray.begin(), nanosecondsArray.end());
+    printf("%s,%zu,%.3f,%.3f\n", label, nanosecondsArray.size(), double(totalNanoseconds) / double(nanosecondsArray.size()) / 1e6, double(maxNanoseconds) / 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    int runs = (argc > 1) ? ::atoi(argv[1]) : 20;
+    std::string cacheFile = (argc > 2) ? argv[2] : "line_shader.bin";
+
+    if(runs <= 0)
+    {
+        fprintf(stderr, "Usage: %s [runs] [cacheFile]\n", argv[0]);
+        return 1;
+    }
+
+    if(!MakeContext())
+        return 1;
+
+    AAssetManager* assetManager = HostAssetManager_Create(SHADER_CACHE_BENCH_ASSET_DIR);
+    if(!assetManager)
+        return 1;
+
+    std::vector<uint64_t> compileNanosecondsArray;
+    std::vector<uint64_t> coldNanosecondsArray;
+    std::vector<uint64_t> warmNanosecondsArray;
+    int warmMisses = 0;
+    bool failed = false;
+
+    for(int i = 0; i < runs && !failed; i++)
+    {
+        ShaderProgram shaderProgram;
+
+        uint64_t startNanoseconds = NowNanoseconds();
+        failed = !shaderProgram.Load("lineFragmentShader.txt", "lineVertexShader.txt", assetManager);
+        compileNanosecondsArray.push_back(NowNanoseconds() - startNanoseconds);
+
+        ::unlink(cacheFile.c_str());
+        startNanoseconds = NowNanoseconds();
+        failed = failed || !shaderProgram.Load("lineFragmentShader.txt", "lineVertexShader.txt", assetManager, cacheFile);
+        coldNanosecondsArray.push_back(NowNanoseconds() - startNanoseconds);
+
+        startNanoseconds = NowNanoseconds();
+        failed = failed || !shaderProgram.Load("lineFragmentShader.txt", "lineVertexShader.txt", assetManager, cacheFile);
+        warmNanosecondsArray.push_back(NowNanoseconds() - startNanoseconds);
+
+        if(!shaderProgram.IsFromCache())
+            warmMisses++;
+    }
+
+    HostAssetManager_Destroy(assetManager);
+    ::unlink(cacheFile.c_str());
+
+    if(failed)
+    {
+        fprintf(stderr, "Failed to load the line shader.\n");
+        return 1;
+    }
+
+    printf("load,runs,mean_ms,max_ms\n");
+    PrintTimes("no_cache", compileNanosecondsArray);
+    PrintTimes("cold_cache", coldNanosecondsArray);
+    PrintTimes("warm_cache", warmNanosecondsArray);
+
+    if(warmMisses > 0)
+    {
+        fprintf(stderr, "%d of %d warm loads missed the cache.\n", warmMisses, runs);
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+// This is a host-side tool that plays a batch of levels with the solver bot, spread across
+// all the cores, and reports how long each one took.  It gives us a realistic and repeatable
+// load for the physics and game logic without anyone having to tilt a phone around.
+//
+// Usage: SolverBotRunner [numSeeds] [firstLevel] [lastLevel] [maxSteps] [aspectRatio] [rectangular|hexagonal|polar]
+//
+// Levels are sized the same way the game sizes them.  How long a level took to solve is in game
+// time: the physics steps it took at the rate the game steps them.  That's what a player would see,
+// and it doesn't depend on how loaded the machine was.  The wall-clock time each level took to
+// simulate is reported separately, since that's what tells us how expensive a step is.
+
+#include "Maze.h"
+#include "PhysicsWorld.h"
+#include "SolverBot.h"
+#include "JobSystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+using namespace PlanarPhysics;
+
+struct LevelResult
+{
+    int level;
+    int seed;
+    int rows;
+    int cols;
+    bool solved;
+    int physicsSteps;
+    int collisions;
+    double solveSeconds;
+    double simulateMilliseconds;
+};
+
+static double NowMilliseconds()
+{
+    struct timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return double(now.tv_sec) * 1000.0 + double(now.tv_nsec) / 1000000.0;
+}
+
+static void PlayLevel(LevelResult& result, int maxSteps, double aspectRatio, Maze::Topology topology)
+{
+    const double gravity = 980.0;
+
+    Maze::CalcLevelSize(result.level, aspectRatio, result.rows, result.cols);
+
+    Maze maze;
+    PhysicsWorld physicsWorld;
+
+    RandomGenerator random(RandomGenerator::MixSeed(result.rows, result.cols, result.seed));
+    maze.Generate(result.rows, result.cols, random, topology);
+    maze.PopulatePhysicsWorld(&physicsWorld, 0, false, 0.5);
+
+    physicsWorld.ResetStats();
+
+    SolverBot solverBot(&maze, &physicsWorld);
+
+    double startTime = NowMilliseconds();
+
+    result.solved = false;
+    for(result.physicsSteps = 0; result.physicsSteps < maxSteps; result.physicsSteps++)
+    {
+        physicsWorld.accelerationDueToGravity = solverBot.ChooseGravity(gravity);
+        physicsWorld.Tick();
+
+        if(physicsWorld.IsMazeSolved())
+        {
+            result.solved = true;
+            result.physicsSteps++;
+            break;
+        }
+    }
+
+    result.simulateMilliseconds = NowMilliseconds() - startTime;
+    result.solveSeconds = double(result.physicsSteps) / double(PHYSICS_WORLD_STEPS_PER_SECOND);
+    result.collisions = physicsWorld.GetBallCollisionCount();
+}
+
+int main(int argc, char** argv)
+{
+    int numSeeds = (argc > 1) ? ::atoi(argv[1]) : 200;
+    int firstLevel = (argc > 2) ? ::atoi(argv[2]) : 0;
+    int lastLevel = (argc > 3) ? ::atoi(argv[3]) : 10;
+    int maxSteps = (argc > 4) ? ::atoi(argv[4]) : 50000;
+    double aspectRatio = (argc > 5) ? ::atof(argv[5]) : 0.5;
+
+    Maze::Topology topology = Maze::Topology::RECTANGULAR;
+    if(argc > 6 && !Maze::FindTopologyByName(argv[6], topology))
+    {
+        fprintf(stderr, "Unknown maze topology: %s\n", argv[6]);
+        return 1;
+    }
+
+    std::vector<LevelResult> resultArray;
+    for(int level = firstLevel; level <= lastLevel; level++)
+    {
+        for(int seed = 0; seed < numSeeds; seed++)
+        {
+            LevelResult result{};
+            result.level = level;
+            result.seed = seed;
+            resultArray.push_back(result);
+        }
+    }
+
+    JobSystem jobSystem;
+    if(!jobSystem.Setup())
+    {
+        fprintf(stderr, "Failed to setup job system.\n");
+        return 1;
+    }
+
+    double startTime = NowMilliseconds();
+
+    jobSystem.ParallelFor(0, (int)resultArray.size(), 1, [&resultArray, maxSteps, aspectRatio, topology](int begin, int end)
+    {
+        for(int i = begin; i < end; i++)
+            PlayLevel(resultArray[i], maxSteps, aspectRatio, topology);
+    });
+
+    double totalMilliseconds = NowMilliseconds() - startTime;
+
+    printf("level,seed,rows,cols,solved,physics_steps,collisions,solve_s,simulate_ms,ms_per_step\n");
+    for(const LevelResult& result : resultArray)
+    {
+        printf("%d,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.5f\n",
+               result.level, result.seed, result.rows, result.cols, result.solved ? 1 : 0,
+               result.physicsSteps, result.collisions, result.solveSeconds, result.simulateMilliseconds,
+               result.simulateMilliseconds / double(std::max(result.physicsSteps, 1)));
+    }
+
+    int numSolved = 0;
+    long long totalSteps = 0;
+    double totalStepMilliseconds = 0.0;
+    double totalSolveSeconds = 0.0;
+    for(const LevelResult& result : resultArray)
+    {
+        if(result.solved)
+        {
+            numSolved++;
+            totalSolveSeconds += result.solveSeconds;
+        }
+
+        totalSteps += result.physicsSteps;
+        totalStepMilliseconds += result.simulateMilliseconds;
+    }
+
+    fprintf(stderr, "Played %d levels on %d workers in %.1f ms.\n", (int)resultArray.size(), jobSystem.GetWorkerCount(), totalMilliseconds);
+    fprintf(stderr, "Solved %d of them, taking %.2f s of game time on average.\n", numSolved, totalSolveSeconds / double(std::max(numSolved, 1)));
+    fprintf(stderr, "Average of %.5f ms per physics step.\n", totalStepMilliseconds / double(std::max(totalSteps, 1LL)));
+
+    jobSystem.Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "WaveFile.h"
+#include <stdio.h>
+#include <string.h>
+
+#define WAVE_FORMAT_PCM             0x0001
+#define WAVE_FORMAT_IEEE_FLOAT      0x0003
+#define WAVE_FORMAT_EXTENSIBLE      0xFFFE
+
+// Everything in a RIFF file is little-endian, and so are the devices we run on, but reading
+// a byte at a time like this also keeps us clear of any alignment trouble in the header.
+static uint32_t ReadUInt32(const uint8_t* buf)
+{
+    return uint32_t(buf[0]) | (uint32_t(buf[1]) << 8) | (uint32_t(buf[2]) << 16) | (uint32_t(buf[3]) << 24);
+}
+
+static uint16_t ReadUInt16(const uint8_t* buf)
+{
+    return uint16_t(buf[0] | (buf[1] << 8));
+}
+
+static void WriteUInt32(uint8_t* buf, uint32_t value)
+{
+    buf[0] = uint8_t(value);
+    buf[1] = uint8_t(value >> 8);
+    buf[2] = uint8_t(value >> 16);
+    buf[3] = uint8_t(value >> 24);
+}
+
+static void WriteUInt16(uint8_t* buf, uint16_t value)
+{
+    buf[0] = uint8_t(value);
+    buf[1] = uint8_t(value >> 8);
+}
+
+WaveFile::WaveFile()
+{
+    this->sampleType = SampleType::SIGNED_INTEGER;
+    this->numChannels = 0;
+    this->framesPerSecond = 0;
+    this->bitsPerSample = 0;
+    this->sampleBuf = nullptr;
+    this->sampleBufSize = 0;
+    this->numFrames = 0;
+}
+
+/*virtual*/ WaveFile::~WaveFile()
+{
+}
+
+bool WaveFile::Parse(const uint8_t* fileBuf, size_t fileBufSize)
+{
+    if(fileBufSize < 12 || ::memcmp(fileBuf, "RIFF", 4) != 0 || ::memcmp(fileBuf + 8, "WAVE", 4) != 0)
+        return false;
+
+    bool foundFormat = false;
+    this->sampleBuf = nullptr;
+
+    size_t offset = 12;
+    while(offset + 8 <= fileBufSize)
+    {
+        const uint8_t* chunkBuf = fileBuf + offset;
+        uint32_t chunkSize = ReadUInt32(chunkBuf + 4);
+        const uint8_t* chunkDataBuf = chunkBuf + 8;
+        size_t chunkDataBufSize = fileBufSize - offset - 8;
+
+        if(::memcmp(chunkBuf, "fmt ", 4) == 0)
+        {
+            if(chunkSize < 16 || chunkDataBufSize < 16)
+                return false;
+
+            uint16_t formatTag = ReadUInt16(chunkDataBuf);
+            this->numChannels = ReadUInt16(chunkDataBuf + 2);
+            this->framesPerSecond = ReadUInt32(chunkDataBuf + 4);
+            this->bitsPerSample = ReadUInt16(chunkDataBuf + 14);
+
+            // The extensible format keeps the real format tag at the start of its sub-format GUID.
+            if(formatTag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40 && chunkDataBufSize >= 40)
+                formatTag = ReadUInt16(chunkDataBuf + 24);
+
+            if(formatTag == WAVE_FORMAT_PCM)
+                this->sampleType = SampleType::SIGNED_INTEGER;
+            else if(formatTag == WAVE_FORMAT_IEEE_FLOAT)
+                this->sampleType = SampleType::FLOAT;
+            else
+                return false;
+
+            foundFormat = true;
+        }
+        else if(::memcmp(chunkBuf, "data", 4) == 0)
+        {
+            // Some writers leave the size of the data chunk unfinished, so don't trust it past the end of the file.
+            this->sampleBuf = chunkDataBuf;
+            this->sampleBufSize = (chunkSize < chunkDataBufSize) ? chunkSize : chunkDataBufSize;
+        }
+
+        // Chunks are padded out to an even number of bytes.
+        offset += 8 + size_t(chunkSize) + (chunkSize & 1);
+    }
+
+    if(!foundFormat || !this->sampleBuf || this->numChannels == 0 || this->framesPerSecond == 0)
+        return false;
+
+    if(this->sampleType == SampleType::SIGNED_INTEGER && this->bitsPerSample != 8 && this->bitsPerSample != 16 && this->bitsPerSample != 24 && this->bitsPerSample != 32)
+        return false;
+
+    if(this->sampleType == SampleType::FLOAT && this->bitsPerSample != 32)
+        return false;
+
+    this->numFrames = uint32_t(this->sampleBufSize / this->GetBytesPerFrame());
+    return true;
+}
+
+/*static*/ bool WaveFile::Write(const char* filePath, SampleType sampleType, uint32_t numChannels, uint32_t framesPerSecond, uint32_t bitsPerSample, const void* sampleBuf, size_t sampleBufSize)
+{
+    if(sampleBufSize > 0xFFFFFFFF - 36)
+        return false;
+
+    uint32_t bytesPerFrame = numChannels * (bitsPerSample / 8);
+
+    uint8_t headerBuf[44];
+    ::memcpy(headerBuf, "RIFF", 4);
+    WriteUInt32(headerBuf + 4, uint32_t(36 + sampleBufSize));
+    ::memcpy(headerBuf + 8, "WAVE", 4);
+    ::memcpy(headerBuf + 12, "fmt ", 4);
+    WriteUInt32(headerBuf + 16, 16);
+    WriteUInt16(headerBuf + 20, (sampleType == SampleType::FLOAT) ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    WriteUInt16(headerBuf + 22, uint16_t(numChannels));
+    WriteUInt32(headerBuf + 24, framesPerSecond);
+    WriteUInt32(headerBuf + 28, framesPerSecond * bytesPerFrame);
+    WriteUInt16(headerBuf + 32, uint16_t(bytesPerFrame));
+    WriteUInt16(headerBuf + 34, uint16_t(bitsPerSample));
+    ::memcpy(headerBuf + 36, "data", 4);
+    WriteUInt32(headerBuf + 40, uint32_t(sampleBufSize));
+
+    FILE* fp = fopen(filePath, "wb");
+    if(!fp)
+        return false;
+
+    bool written = (1 == fwrite(headerBuf, sizeof(headerBuf), 1, fp));
+    if(written && sampleBufSize > 0)
+        written = (1 == fwrite(sampleBuf, sampleBufSize, 1, fp));
+
+    if(0 != fclose(fp))
+        written = false;
+
+    return written;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// This is just enough of a RIFF/WAVE reader to find the format and the sample data in a
+// buffer that's already in memory, such as a mapped asset.  Nothing is copied or decoded;
+// the sample pointer points right into the given buffer, so that buffer has to outlive
+// anything that uses it.  Unknown chunks (JUNK, LIST, fact, etc.) are skipped.
+class WaveFile
+{
+public:
+    WaveFile();
+    virtual ~WaveFile();
+
+    enum class SampleType
+    {
+        SIGNED_INTEGER,
+        FLOAT
+    };
+
+    bool Parse(const uint8_t* fileBuf, size_t fileBufSize);
+
+    // This goes the other way, writing out a plain WAV file with the given format and samples.
+    static bool Write(const char* filePath, SampleType sampleType, uint32_t numChannels, uint32_t framesPerSecond, uint32_t bitsPerSample, const void* sampleBuf, size_t sampleBufSize);
+
+    uint32_t GetBytesPerFrame() const { return this->numChannels * (this->bitsPerSample / 8); }
+
+    SampleType sampleType;
+    uint32_t numChannels;
+    uint32_t framesPerSecond;
+    uint32_t bitsPerSample;
+    const uint8_t* sampleBuf;
+    size_t sampleBufSize;
+    uint32_t numFrames;
+};
\ No newline at end of file